@@ -307,10 +307,24 @@ Error App::InitZephyr()
         return AOS_ERROR_WRAP(err);
     }
 
-    if (auto err = mLogProvider.Init(mLogReader, mStorage); !err.IsNone()) {
+    StaticArray<logprovider::LogReaderItf*, logprovider::cMaxNumLogWorkers> logReaders;
+
+    for (auto& logReader : mLogReaders) {
+        if (auto err = logReaders.PushBack(&logReader); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+    }
+
+    if (auto err = mLogProvider.Init(logReaders, mStorage, &mRunner); !err.IsNone()) {
         return AOS_ERROR_WRAP(err);
     }
 
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    if (auto err = logger::backend::FSBackend::Get().Subscribe(mLogProvider); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+#endif
+
     return ErrorEnum::eNone;
 }
 
@@ -32,6 +32,7 @@
 #include "iamclient/iamclient.hpp"
 #include "image/imagehandler.hpp"
 #include "launcher/runtime.hpp"
+#include "logger/fsbackend.hpp"
 #include "logprovider/fslogreader.hpp"
 #include "logprovider/logprovider.hpp"
 #include "monitoring/resourceusageprovider.hpp"
@@ -150,7 +151,7 @@ private:
     spaceallocator::SpaceAllocator<cMaxNumLayers>                       mLayerSpaceAllocator;
     spaceallocator::SpaceAllocator<Max(cMaxNumLayers, cMaxNumServices)> mDownloadSpaceAllocator;
     image::ImageHandler                                                 mImageHandler;
-    logprovider::FSLogReader                                            mLogReader;
+    logprovider::FSLogReader                                            mLogReaders[logprovider::cMaxNumLogWorkers];
     logprovider::LogProvider                                            mLogProvider;
 };
 
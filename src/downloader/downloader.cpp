@@ -6,16 +6,49 @@
  */
 
 #include <fcntl.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include <aos/common/tools/fs.hpp>
+#include <aos/common/tools/utils.hpp>
 
 #include "downloader.hpp"
 #include "log.hpp"
 
 namespace aos::zephyr::downloader {
 
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr uint32_t cProgressMagic  = 0x50525447;
+constexpr auto     cProgressSuffix = ".parts";
+
+// Download progress file: header followed by received parts bitmap of the file.
+struct ProgressHeader {
+    uint32_t mMagic;
+    char     mURL[cURLLen + 1];
+    uint64_t mSize;
+    uint64_t mPartsCount;
+    uint64_t mChunkSize;
+};
+
+uint32_t HashFilePath(const String& path)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < path.Size(); i++) {
+        hash = (hash ^ static_cast<uint8_t>(path.CStr()[i])) * 16777619U;
+    }
+
+    return hash;
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -44,8 +77,16 @@ Error Downloader::Download(const String& url, const String& path, cloudprotocol:
 
     LOG_DBG() << "Download: " << url;
 
+    // Chunks received after the previous download is finished may reopen its files.
+    for (auto& result : mDownloadResults) {
+        if (result.mFile != -1) {
+            CloseFile(result);
+        }
+    }
+
     mFinishDownload = false;
     mDownloadResults.Clear();
+    mPartsBitmap.Clear();
 
     auto err = mTimer.Start(
         Downloader::cDownloadTimeout, [this](void*) { SetErrorAndNotify(AOS_ERROR_WRAP(ErrorEnum::eTimeout)); });
@@ -55,6 +96,7 @@ Error Downloader::Download(const String& url, const String& path, cloudprotocol:
         return AOS_ERROR_WRAP(err);
     }
 
+    mURL                    = url;
     mRequestedPath          = path;
     mErrProcessImageRequest = mDownloadRequester->SendImageContentRequest({url, ++mRequestID, targetType});
 
@@ -69,19 +111,24 @@ Error Downloader::Download(const String& url, const String& path, cloudprotocol:
         return AOS_ERROR_WRAP(err);
     }
 
-    for (const auto& result : mDownloadResults) {
-        if (result.mFile == -1) {
-            continue;
-        }
+    for (auto& result : mDownloadResults) {
+        if (result.mFile != -1) {
+            if (err = CloseFile(result); !err.IsNone()) {
+                LOG_ERR() << "Can't close file: path=" << result.mRelativePath << ", err=" << err;
 
-        auto ret = close(result.mFile);
-        if (ret < 0) {
-            err = AOS_ERROR_WRAP(errno);
+                if (mErrProcessImageRequest.IsNone()) {
+                    mErrProcessImageRequest = err;
+                }
 
-            LOG_ERR() << "Can't close file. Path: " << result.mRelativePath << ", err: " << err;
+                continue;
+            }
+        }
 
-            if (mErrProcessImageRequest.IsNone()) {
-                mErrProcessImageRequest = err;
+        // Keep progress of the interrupted download, so the received parts are not written again on retry. If buffered
+        // parts are not written, the last saved progress is kept.
+        if (cSaveProgressParts > 0 && !result.mIsDone && result.mNumReceivedParts > 0) {
+            if (err = SaveProgress(result); !err.IsNone()) {
+                LOG_WRN() << "Can't save download progress: path=" << result.mRelativePath << ", err=" << err;
             }
         }
     }
@@ -96,10 +143,8 @@ Error Downloader::ReceiveFileChunk(const FileChunk& chunk)
 
     LockGuard lock(mMutex);
 
-    auto downloadResult = mDownloadResults.FindIf(
-        [&chunk](const DownloadResult& result) { return result.mRelativePath == chunk.mRelativePath; });
-
-    if (downloadResult == mDownloadResults.end()) {
+    auto downloadResult = FindDownloadResult(chunk.mRelativePath);
+    if (downloadResult == nullptr) {
         auto err = AOS_ERROR_WRAP(ErrorEnum::eNotFound);
 
         SetErrorAndNotify(err);
@@ -107,33 +152,12 @@ Error Downloader::ReceiveFileChunk(const FileChunk& chunk)
         return err;
     }
 
-    if (downloadResult->mFile == -1) {
-        auto path    = fs::JoinPath(mRequestedPath, chunk.mRelativePath);
-        auto dirPath = fs::Dir(path);
-
-        auto err = fs::MakeDirAll(dirPath);
-        if (!err.IsNone()) {
-            err = AOS_ERROR_WRAP(errno);
-
-            SetErrorAndNotify(err);
-
-            return err;
-        }
-
-        downloadResult->mFile = open(path.CStr(), O_CREAT | O_WRONLY, 0644);
-        if (downloadResult->mFile < 0) {
-            err = AOS_ERROR_WRAP(errno);
-
-            SetErrorAndNotify(err);
-
-            return err;
-        }
+    // Chunks may be resent, so chunks of the downloaded file are ignored.
+    if (downloadResult->mIsDone) {
+        return ErrorEnum::eNone;
     }
 
-    auto ret = write(downloadResult->mFile, chunk.mData.Get(), chunk.mData.Size());
-    if (ret < 0) {
-        auto err = AOS_ERROR_WRAP(errno);
-
+    if (auto err = WriteChunk(*downloadResult, chunk); !err.IsNone()) {
         SetErrorAndNotify(err);
 
         return err;
@@ -142,19 +166,29 @@ Error Downloader::ReceiveFileChunk(const FileChunk& chunk)
     mTimer.Start(
         Downloader::cDownloadTimeout, [this](void*) { SetErrorAndNotify(AOS_ERROR_WRAP(ErrorEnum::eTimeout)); });
 
-    if (chunk.mPart == chunk.mPartsCount) {
-        ret = close(downloadResult->mFile);
-        if (ret < 0) {
-            auto err = AOS_ERROR_WRAP(errno);
+    if (downloadResult->mNumReceivedParts == downloadResult->mPartsCount) {
+        // All parts are hashed at this point, the digest context is released with the file.
+        auto [digest, err] = downloadResult->mContext->mSHA256Calculator.Finish();
+
+        if (auto closeErr = CloseFile(*downloadResult); !closeErr.IsNone() && err.IsNone()) {
+            err = closeErr;
+        }
+
+        // Progress is removed even if the file fails, so the file is downloaded from scratch on retry.
+        downloadResult->mIsDone = true;
+
+        RemoveProgress(*downloadResult);
+
+        if (err.IsNone()) {
+            err = StoreDigest(*downloadResult, digest);
+        }
 
+        if (!err.IsNone()) {
             SetErrorAndNotify(err);
 
             return err;
         }
 
-        downloadResult->mFile   = -1;
-        downloadResult->mIsDone = true;
-
         if (IsAllDownloadDone()) {
             mFinishDownload = true;
             mWaitDownload.NotifyOne();
@@ -183,9 +217,24 @@ Error Downloader::ReceiveImageContentInfo(const ImageContentInfo& content)
     }
 
     for (auto& file : content.mFiles) {
-        mDownloadResults.PushBack(DownloadResult {file.mRelativePath, -1, false});
+        if (auto err = mDownloadResults.EmplaceBack(); !err.IsNone()) {
+            err = AOS_ERROR_WRAP(err);
+
+            SetErrorAndNotify(err);
+
+            return err;
+        }
+
+        auto& result = mDownloadResults.Back();
+
+        result.mRelativePath = file.mRelativePath;
+        result.mFile         = -1;
+        result.mSize         = file.mSize;
+        result.mSHA256       = file.mSHA256;
     }
 
+    CreateFileTable();
+
     mTimer.Start(
         Downloader::cDownloadTimeout, [this](void*) { SetErrorAndNotify(AOS_ERROR_WRAP(ErrorEnum::eTimeout)); });
 
@@ -216,4 +265,562 @@ void Downloader::SetErrorAndNotify(const Error& err)
     mWaitDownload.NotifyOne();
 }
 
+// File table: open addressing with linear probing, contains download result index + 1, 0 marks empty slot.
+void Downloader::CreateFileTable()
+{
+    memset(mFileTable, 0, sizeof(mFileTable));
+
+    for (size_t i = 0; i < mDownloadResults.Size(); i++) {
+        auto slot = HashFilePath(mDownloadResults[i].mRelativePath) & (cFileTableSize - 1);
+
+        while (mFileTable[slot] != 0) {
+            slot = (slot + 1) & (cFileTableSize - 1);
+        }
+
+        mFileTable[slot] = static_cast<uint8_t>(i + 1);
+    }
+}
+
+Downloader::DownloadResult* Downloader::FindDownloadResult(const String& relativePath)
+{
+    for (auto slot = HashFilePath(relativePath) & (cFileTableSize - 1); mFileTable[slot] != 0;
+         slot = (slot + 1) & (cFileTableSize - 1)) {
+        auto& result = mDownloadResults[mFileTable[slot] - 1];
+
+        if (result.mRelativePath == relativePath) {
+            return &result;
+        }
+    }
+
+    return nullptr;
+}
+
+// Parts bitmap of the file is allocated from the common parts bitmap when the first file chunk is received. The common
+// bitmap limits the total number of image parts, so it limits the image size. If the file was partially downloaded
+// from the same URL before, its received parts are restored.
+Error Downloader::OpenFile(DownloadResult& result, uint64_t partsCount)
+{
+    if (partsCount == 0) {
+        return AOS_ERROR_WRAP(ErrorEnum::eInvalidArgument);
+    }
+
+    auto bitmapOffset = mPartsBitmap.Size();
+
+    if (auto err = mPartsBitmap.Resize(bitmapOffset + (partsCount + 31) / 32, 0); !err.IsNone()) {
+        LOG_ERR() << "Image has too many parts: path=" << result.mRelativePath << ", partsCount=" << partsCount
+                  << ", maxParts=" << cMaxNumParts;
+
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eNoMemory, "too many file parts"));
+    }
+
+    result.mPartsCount        = partsCount;
+    result.mPartsBitmapOffset = bitmapOffset;
+
+    ClearParts(result);
+
+    auto path = GetFilePath(result);
+
+    if (auto err = fs::MakeDirAll(fs::Dir(path)); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    // Digest record is written when the file is complete, so a record of the previous file content is removed.
+    if (auto err = fs::Remove(utils::GetSha256DigestPath(path)); !err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    if (auto err = AcquireFileContext(result); !err.IsNone()) {
+        return err;
+    }
+
+    if (cSaveProgressParts > 0 && RestoreProgress(result)) {
+        result.mFile = open(path.CStr(), O_RDWR);
+        if (result.mFile >= 0) {
+            LOG_INF() << "Resume file download: path=" << result.mRelativePath
+                      << ", receivedParts=" << result.mNumReceivedParts << "/" << result.mPartsCount;
+
+            return ErrorEnum::eNone;
+        }
+
+        ClearParts(result);
+    }
+
+    result.mFile = open(path.CStr(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (result.mFile < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        ReleaseFileContext(result);
+
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Received parts of the reopened file are hashed again when the next chunk is received, as the digest context is
+// released when the file is closed.
+Error Downloader::ReopenFile(DownloadResult& result)
+{
+    if (auto err = AcquireFileContext(result); !err.IsNone()) {
+        return err;
+    }
+
+    result.mFile = open(GetFilePath(result).CStr(), O_RDWR);
+    if (result.mFile < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        ReleaseFileContext(result);
+
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error Downloader::CloseFile(DownloadResult& result)
+{
+    auto err = FlushFile(result);
+
+    if (auto ret = close(result.mFile); ret < 0 && err.IsNone()) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    result.mFile = -1;
+
+    ReleaseFileContext(result);
+
+    return err;
+}
+
+// Write buffer and digest context are needed only while the file is open, so they are taken from a small pool. If all
+// of them are in use, the least recently used file is closed to free its context.
+Error Downloader::AcquireFileContext(DownloadResult& result)
+{
+    FileContext* context = nullptr;
+
+    for (auto& item : mFileContexts) {
+        if (item.mResult == nullptr) {
+            context = &item;
+
+            break;
+        }
+
+        if (context == nullptr || item.mLastUsed < context->mLastUsed) {
+            context = &item;
+        }
+    }
+
+    if (auto closedResult = context->mResult; closedResult != nullptr) {
+        LOG_DBG() << "Close file to free its context: path=" << closedResult->mRelativePath;
+
+        // Buffered parts of the file may be not written, so its received parts are dropped and the last saved progress
+        // is kept.
+        if (auto err = CloseFile(*closedResult); !err.IsNone()) {
+            ClearParts(*closedResult);
+
+            return err;
+        }
+    }
+
+    if (auto err = context->mSHA256Calculator.Start(); !err.IsNone()) {
+        return err;
+    }
+
+    context->mResult    = &result;
+    context->mWriteSize = 0;
+
+    result.mContext        = context;
+    result.mNumHashedParts = 0;
+
+    return ErrorEnum::eNone;
+}
+
+// Digest context of the file which is not complete, e.g. on download error or timeout, is freed here.
+void Downloader::ReleaseFileContext(DownloadResult& result)
+{
+    result.mContext->mSHA256Calculator.Reset();
+    result.mContext->mResult = nullptr;
+    result.mContext          = nullptr;
+}
+
+// Currently, zephyr doesn't provide Posix API (fsync) to flush the file correctly. As workaround, we reopen the file
+// the same way the storage does.
+Error Downloader::SyncFile(DownloadResult& result)
+{
+    if (auto err = FlushFile(result); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto ret = close(result.mFile); ret < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        result.mFile = -1;
+
+        ReleaseFileContext(result);
+
+        return err;
+    }
+
+    result.mFile = open(GetFilePath(result).CStr(), O_RDWR);
+    if (result.mFile < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        ReleaseFileContext(result);
+
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Chunks may be received in any order and interleaved with chunks of other files, so each chunk is written at its
+// offset in the file.
+Error Downloader::WriteChunk(DownloadResult& result, const FileChunk& chunk)
+{
+    if (result.mFile == -1) {
+        auto err = result.mPartsCount == 0 ? OpenFile(result, chunk.mPartsCount) : ReopenFile(result);
+        if (!err.IsNone()) {
+            return err;
+        }
+    }
+
+    result.mContext->mLastUsed = ++mFileContextUseCount;
+
+    if (chunk.mPartsCount != result.mPartsCount || chunk.mPart == 0 || chunk.mPart > result.mPartsCount) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eInvalidArgument, "wrong file chunk part"));
+    }
+
+    if (IsPartReceived(result, chunk.mPart)) {
+        LOG_WRN() << "Duplicated file chunk: path=" << chunk.mRelativePath << ", part=" << chunk.mPart;
+
+        return ErrorEnum::eNone;
+    }
+
+    auto [offset, err] = GetChunkOffset(result, chunk);
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    if (err = WriteData(result, offset, chunk.mData.Get(), chunk.mData.Size()); !err.IsNone()) {
+        return err;
+    }
+
+    SetPartReceived(result, chunk.mPart);
+
+    if (err = UpdateDigest(result, chunk); !err.IsNone()) {
+        return err;
+    }
+
+    // Progress is saved after the file data is synced, so saved progress never refers to unwritten parts.
+    if (cSaveProgressParts > 0 && result.mNumReceivedParts % cSaveProgressParts == 0
+        && result.mNumReceivedParts != result.mPartsCount) {
+        if (err = SyncFile(result); !err.IsNone()) {
+            return err;
+        }
+
+        if (auto err = SaveProgress(result); !err.IsNone()) {
+            LOG_WRN() << "Can't save download progress: path=" << result.mRelativePath << ", err=" << err;
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Writes are coalesced to end at write block boundaries to avoid partial block programming of the flash. Data which
+// starts at block boundary and fills whole blocks is written without copying.
+Error Downloader::WriteData(DownloadResult& result, uint64_t offset, const uint8_t* data, size_t size)
+{
+    auto& context = *result.mContext;
+
+    if (context.mWriteSize != 0 && context.mWriteOffset + context.mWriteSize != offset) {
+        if (auto err = FlushFile(result); !err.IsNone()) {
+            return err;
+        }
+    }
+
+    while (size > 0) {
+        if (context.mWriteSize == 0) {
+            context.mWriteOffset = offset;
+
+            if (offset % cWriteBlockSize == 0 && size >= cWriteBlockSize) {
+                auto blocksSize = size - size % cWriteBlockSize;
+
+                if (auto err = WriteFile(result, offset, data, blocksSize); !err.IsNone()) {
+                    return err;
+                }
+
+                offset += blocksSize;
+                data += blocksSize;
+                size -= blocksSize;
+
+                continue;
+            }
+        }
+
+        // Buffered data ends at the next block boundary after the buffer offset.
+        auto bufferSize = cWriteBlockSize - context.mWriteOffset % cWriteBlockSize;
+        auto len        = Min(size, bufferSize - context.mWriteSize);
+
+        memcpy(context.mWriteBuffer + context.mWriteSize, data, len);
+
+        context.mWriteSize += len;
+        offset += len;
+        data += len;
+        size -= len;
+
+        if (context.mWriteSize == bufferSize) {
+            if (auto err = FlushFile(result); !err.IsNone()) {
+                return err;
+            }
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error Downloader::FlushFile(DownloadResult& result)
+{
+    auto& context = *result.mContext;
+
+    if (context.mWriteSize == 0) {
+        return ErrorEnum::eNone;
+    }
+
+    if (auto err = WriteFile(result, context.mWriteOffset, context.mWriteBuffer, context.mWriteSize); !err.IsNone()) {
+        return err;
+    }
+
+    context.mWriteSize = 0;
+
+    return ErrorEnum::eNone;
+}
+
+Error Downloader::WriteFile(DownloadResult& result, uint64_t offset, const uint8_t* data, size_t size)
+{
+    if (auto ret = lseek(result.mFile, offset, SEEK_SET); ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    auto ret = write(result.mFile, data, size);
+    if (ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    if (static_cast<size_t>(ret) != size) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "file data is partially written"));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// All file chunks except the last one have the same size. If the last chunk is received before any other chunk, its
+// offset is calculated from the file size.
+RetWithError<uint64_t> Downloader::GetChunkOffset(DownloadResult& result, const FileChunk& chunk)
+{
+    if (chunk.mPart < chunk.mPartsCount) {
+        if (result.mChunkSize == 0) {
+            result.mChunkSize = chunk.mData.Size();
+        } else if (result.mChunkSize != chunk.mData.Size()) {
+            return {0, AOS_ERROR_WRAP(Error(ErrorEnum::eInvalidArgument, "wrong file chunk size"))};
+        }
+    }
+
+    if (chunk.mPart == 1) {
+        return 0;
+    }
+
+    if (result.mChunkSize != 0) {
+        return (chunk.mPart - 1) * result.mChunkSize;
+    }
+
+    if (result.mSize < chunk.mData.Size()) {
+        return {0, AOS_ERROR_WRAP(Error(ErrorEnum::eInvalidArgument, "wrong file size"))};
+    }
+
+    return result.mSize - chunk.mData.Size();
+}
+
+// Parts are hashed in order while they are written. A part received before the previous parts is hashed when the gap
+// is filled: it is read back from the file, so in order download doesn't need any extra file IO.
+Error Downloader::UpdateDigest(DownloadResult& result, const FileChunk& chunk)
+{
+    auto& calculator = result.mContext->mSHA256Calculator;
+
+    while (result.mNumHashedParts < result.mPartsCount && IsPartReceived(result, result.mNumHashedParts + 1)) {
+        auto part = result.mNumHashedParts + 1;
+
+        auto err = part == chunk.mPart ? calculator.Update(chunk.mData.Get(), chunk.mData.Size())
+                                       : HashFilePart(result, part);
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        result.mNumHashedParts++;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error Downloader::HashFilePart(DownloadResult& result, uint64_t part)
+{
+    uint8_t  buffer[cReadBufferSize];
+    uint64_t offset = (part - 1) * result.mChunkSize;
+    uint64_t size   = part < result.mPartsCount ? result.mChunkSize : result.mSize - offset;
+
+    // The part may be still in the write buffer.
+    if (auto err = FlushFile(result); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto ret = lseek(result.mFile, offset, SEEK_SET); ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    while (size > 0) {
+        auto ret = read(result.mFile, buffer, Min<uint64_t>(size, sizeof(buffer)));
+        if (ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        if (ret == 0) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eFailed, "unexpected end of file"));
+        }
+
+        if (auto err = result.mContext->mSHA256Calculator.Update(buffer, ret); !err.IsNone()) {
+            return err;
+        }
+
+        size -= ret;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// The digest is checked against the expected one from the image content info and stored next to the file, so the
+// image handler doesn't need to read the file again to get it.
+Error Downloader::StoreDigest(DownloadResult& result, const Array<uint8_t>& digest)
+{
+    if (!result.mSHA256.IsEmpty() && result.mSHA256 != digest) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eInvalidChecksum, "file checksum mismatch"));
+    }
+
+    if (auto err = utils::WriteSha256Digest(GetFilePath(result), digest); !err.IsNone()) {
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+bool Downloader::IsPartReceived(const DownloadResult& result, uint64_t part) const
+{
+    auto index = part - 1;
+
+    return mPartsBitmap[result.mPartsBitmapOffset + index / 32] & (1U << (index % 32));
+}
+
+void Downloader::SetPartReceived(DownloadResult& result, uint64_t part)
+{
+    auto index = part - 1;
+
+    mPartsBitmap[result.mPartsBitmapOffset + index / 32] |= 1U << (index % 32);
+
+    result.mNumReceivedParts++;
+}
+
+void Downloader::ClearParts(DownloadResult& result)
+{
+    memset(&mPartsBitmap[result.mPartsBitmapOffset], 0, (result.mPartsCount + 31) / 32 * sizeof(uint32_t));
+
+    result.mNumReceivedParts = 0;
+    result.mChunkSize        = 0;
+}
+
+bool Downloader::RestoreProgress(DownloadResult& result)
+{
+    auto fd = open(GetProgressPath(result).CStr(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    ProgressHeader header {};
+    auto           bitmap     = &mPartsBitmap[result.mPartsBitmapOffset];
+    auto           bitmapSize = static_cast<ssize_t>((result.mPartsCount + 31) / 32 * sizeof(uint32_t));
+
+    auto restored = read(fd, &header, sizeof(header)) == sizeof(header) && header.mMagic == cProgressMagic
+        && header.mSize == result.mSize && header.mPartsCount == result.mPartsCount
+        && read(fd, bitmap, bitmapSize) == bitmapSize;
+
+    close(fd);
+
+    header.mURL[cURLLen] = '\0';
+
+    if (!restored || mURL != header.mURL) {
+        ClearParts(result);
+
+        return false;
+    }
+
+    for (uint64_t part = 1; part <= result.mPartsCount; part++) {
+        if (IsPartReceived(result, part)) {
+            result.mNumReceivedParts++;
+        }
+    }
+
+    result.mChunkSize = header.mChunkSize;
+
+    return true;
+}
+
+Error Downloader::SaveProgress(const DownloadResult& result)
+{
+    ProgressHeader header {cProgressMagic, {}, result.mSize, result.mPartsCount, result.mChunkSize};
+
+    strncpy(header.mURL, mURL.CStr(), cURLLen);
+
+    auto fd = open(GetProgressPath(result).CStr(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    auto bitmapSize = static_cast<ssize_t>((result.mPartsCount + 31) / 32 * sizeof(uint32_t));
+
+    Error err;
+
+    if (write(fd, &header, sizeof(header)) != sizeof(header)
+        || write(fd, &mPartsBitmap[result.mPartsBitmapOffset], bitmapSize) != bitmapSize) {
+        err = AOS_ERROR_WRAP(errno != 0 ? errno : static_cast<int>(ErrorEnum::eFailed));
+    }
+
+    if (auto ret = close(fd); ret < 0 && err.IsNone()) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    return err;
+}
+
+void Downloader::RemoveProgress(const DownloadResult& result)
+{
+    if (cSaveProgressParts == 0) {
+        return;
+    }
+
+    if (auto err = fs::Remove(GetProgressPath(result)); !err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
+        LOG_WRN() << "Can't remove download progress: path=" << result.mRelativePath << ", err=" << err;
+    }
+}
+
+StaticString<cFilePathLen> Downloader::GetFilePath(const DownloadResult& result) const
+{
+    return fs::JoinPath(mRequestedPath, result.mRelativePath);
+}
+
+StaticString<cFilePathLen> Downloader::GetProgressPath(const DownloadResult& result) const
+{
+    auto path = GetFilePath(result);
+
+    path.Append(cProgressSuffix);
+
+    return path;
+}
+
 } // namespace aos::zephyr::downloader
@@ -16,6 +16,8 @@
 #include <aos/common/tools/timer.hpp>
 #include <aos/common/types.hpp>
 
+#include "utils/checksum.hpp"
+
 namespace aos::zephyr::downloader {
 
 /**
@@ -234,26 +236,86 @@ public:
     Error ReceiveImageContentInfo(const ImageContentInfo& content) override;
 
 private:
-    static constexpr auto cDownloadTimeout = Time::cSeconds * 10;
+    static constexpr auto cDownloadTimeout   = Time::cSeconds * 10;
+    static constexpr auto cMaxNumFiles       = 32;
+    static constexpr auto cFileTableSize     = 64;
+    static constexpr auto cMaxNumParts       = CONFIG_AOS_DOWNLOADER_MAX_PARTS;
+    static constexpr auto cPartsBitmapLen    = (cMaxNumParts + 31) / 32;
+    static constexpr auto cSaveProgressParts = CONFIG_AOS_DOWNLOADER_SAVE_PROGRESS_PARTS;
+    static constexpr auto cReadBufferSize    = 256;
+    static constexpr auto cWriteBlockSize    = CONFIG_AOS_DOWNLOADER_WRITE_BLOCK_SIZE;
+    static constexpr auto cMaxNumOpenFiles   = CONFIG_AOS_DOWNLOADER_MAX_OPEN_FILES;
+
+    static_assert(cFileTableSize >= 2 * cMaxNumFiles, "file table is too small");
+    static_assert((cFileTableSize & (cFileTableSize - 1)) == 0, "file table size should be power of 2");
+    static_assert(cMaxNumOpenFiles > 0, "at least one file should be open");
+
+    struct DownloadResult;
+
+    struct FileContext {
+        DownloadResult*         mResult;
+        uint64_t                mLastUsed;
+        uint64_t                mWriteOffset;
+        size_t                  mWriteSize;
+        utils::Sha256Calculator mSHA256Calculator;
+        uint8_t                 mWriteBuffer[cWriteBlockSize];
+    };
 
     struct DownloadResult {
-        StaticString<cFilePathLen> mRelativePath;
-        int                        mFile;
-        bool                       mIsDone;
+        StaticString<cFilePathLen>        mRelativePath;
+        int                               mFile;
+        bool                              mIsDone;
+        uint64_t                          mSize;
+        StaticArray<uint8_t, cSHA256Size> mSHA256;
+        uint64_t                          mPartsCount;
+        uint64_t                          mNumReceivedParts;
+        size_t                            mChunkSize;
+        size_t                            mPartsBitmapOffset;
+        uint64_t                          mNumHashedParts;
+        FileContext*                      mContext;
     };
 
-    bool IsAllDownloadDone() const;
-    void SetErrorAndNotify(const Error& err);
-
-    DownloadRequesterItf*           mDownloadRequester {};
-    Mutex                           mMutex;
-    ConditionalVariable             mWaitDownload;
-    Error                           mErrProcessImageRequest {};
-    StaticString<cFilePathLen>      mRequestedPath {};
-    StaticArray<DownloadResult, 32> mDownloadResults {};
-    Timer                           mTimer {};
-    uint64_t                        mRequestID {};
-    bool                            mFinishDownload {false};
+    bool                       IsAllDownloadDone() const;
+    void                       SetErrorAndNotify(const Error& err);
+    void                       CreateFileTable();
+    DownloadResult*            FindDownloadResult(const String& relativePath);
+    Error                      OpenFile(DownloadResult& result, uint64_t partsCount);
+    Error                      ReopenFile(DownloadResult& result);
+    Error                      CloseFile(DownloadResult& result);
+    Error                      AcquireFileContext(DownloadResult& result);
+    void                       ReleaseFileContext(DownloadResult& result);
+    Error                      SyncFile(DownloadResult& result);
+    Error                      WriteChunk(DownloadResult& result, const FileChunk& chunk);
+    Error                      WriteData(DownloadResult& result, uint64_t offset, const uint8_t* data, size_t size);
+    Error                      FlushFile(DownloadResult& result);
+    Error                      WriteFile(DownloadResult& result, uint64_t offset, const uint8_t* data, size_t size);
+    RetWithError<uint64_t>     GetChunkOffset(DownloadResult& result, const FileChunk& chunk);
+    Error                      UpdateDigest(DownloadResult& result, const FileChunk& chunk);
+    Error                      HashFilePart(DownloadResult& result, uint64_t part);
+    Error                      StoreDigest(DownloadResult& result, const Array<uint8_t>& digest);
+    bool                       IsPartReceived(const DownloadResult& result, uint64_t part) const;
+    void                       SetPartReceived(DownloadResult& result, uint64_t part);
+    void                       ClearParts(DownloadResult& result);
+    bool                       RestoreProgress(DownloadResult& result);
+    Error                      SaveProgress(const DownloadResult& result);
+    void                       RemoveProgress(const DownloadResult& result);
+    StaticString<cFilePathLen> GetFilePath(const DownloadResult& result) const;
+    StaticString<cFilePathLen> GetProgressPath(const DownloadResult& result) const;
+
+    DownloadRequesterItf*                     mDownloadRequester {};
+    Mutex                                     mMutex;
+    ConditionalVariable                       mWaitDownload;
+    Error                                     mErrProcessImageRequest {};
+    StaticString<cURLLen>                     mURL {};
+    StaticString<cFilePathLen>                mRequestedPath {};
+    StaticArray<DownloadResult, cMaxNumFiles> mDownloadResults {};
+    FileContext                               mFileContexts[cMaxNumOpenFiles] {};
+    uint64_t                                  mFileContextUseCount {};
+    uint8_t                                   mFileTable[cFileTableSize] {};
+    StaticArray<uint32_t, cPartsBitmapLen>    mPartsBitmap {};
+    Timer                                     mTimer {};
+    uint64_t                                  mRequestID {};
+    bool                                      mFinishDownload {false};
 };
 
 } // namespace aos::zephyr::downloader
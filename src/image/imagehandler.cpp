@@ -4,10 +4,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <aos/common/tools/fs.hpp>
 
 #include "imagehandler.hpp"
 #include "log.hpp"
+#include "utils/checksum.hpp"
 
 namespace aos::zephyr::image {
 
@@ -51,6 +55,15 @@ RetWithError<StaticString<cFilePathLen>> ImageHandler::InstallService(const Stri
         return {{}, AOS_ERROR_WRAP(err)};
     }
 
+    // Digest record of archive file is moved with the file, digest records of archive folder files are already moved
+    // with the folder.
+    if (auto digestPath = utils::GetSha256DigestPath(archivePath); access(digestPath.CStr(), F_OK) == 0) {
+        err = fs::Rename(digestPath, utils::GetSha256DigestPath(installedPath));
+        if (!err.IsNone()) {
+            return {installedPath, AOS_ERROR_WRAP(err)};
+        }
+    }
+
     size_t serviceSize = 0;
 
     Tie(serviceSize, err) = fs::CalculateSize(installedPath);
@@ -66,18 +79,52 @@ RetWithError<StaticString<cFilePathLen>> ImageHandler::InstallService(const Stri
     return {installedPath, ErrorEnum::eNone};
 }
 
+// Files are verified against the expected digests while they are downloaded and the service archive is moved as a
+// whole on install, so the content is not read again here.
 Error ImageHandler::ValidateService(const String& path) const
 {
-    (void)path;
+    LOG_DBG() << "Validate service: path=" << path;
+
+    if (access(path.CStr(), F_OK) != 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
 
     return ErrorEnum::eNone;
 }
 
+// Digests are calculated by the downloader while the files are downloaded, so the recorded digest is returned. Files
+// without digest record, e.g. put by the previous version, are read to calculate the digest. Folders have no single
+// digest: an empty digest is returned for them.
 RetWithError<StaticString<oci::cMaxDigestLen>> ImageHandler::CalculateDigest(const String& path) const
 {
-    (void)path;
+    StaticString<oci::cMaxDigestLen> digest;
+    struct stat                      st {};
+
+    if (stat(path.CStr(), &st) != 0) {
+        return {digest, AOS_ERROR_WRAP(errno)};
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        LOG_DBG() << "Folder has no digest: path=" << path;
+
+        return digest;
+    }
+
+    if (access(utils::GetSha256DigestPath(path).CStr(), F_OK) != 0) {
+        LOG_DBG() << "No digest record, calculate digest: path=" << path;
+
+        if (auto err = utils::CalculateSha256Digest(path, digest); !err.IsNone()) {
+            return {digest, AOS_ERROR_WRAP(err)};
+        }
+
+        return digest;
+    }
+
+    if (auto err = utils::ReadSha256Digest(path, digest); !err.IsNone()) {
+        return {digest, AOS_ERROR_WRAP(err)};
+    }
 
-    return {StaticString<oci::cMaxDigestLen>(), ErrorEnum::eNone};
+    return digest;
 }
 
 } // namespace aos::zephyr::image
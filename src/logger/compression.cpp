@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compression.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr size_t cMinMatch     = 4;
+constexpr size_t cLastLiterals = 5;
+constexpr size_t cMatchLimit   = 12;
+constexpr size_t cMaxOffset    = 0xFFFF;
+constexpr auto   cHashLog      = 10;
+
+static_assert((1 << cHashLog) == cCompressionHashTableSize, "wrong compression hash table size");
+static_assert(cCompressionBlockSize <= 0xFFFF, "compression block size should fit block header");
+
+uint32_t Read32(const uint8_t* data)
+{
+    uint32_t value;
+
+    memcpy(&value, data, sizeof(value));
+
+    return value;
+}
+
+uint32_t Hash(uint32_t value)
+{
+    return (value * 2654435761U) >> (32 - cHashLog);
+}
+
+bool PutLength(size_t length, uint8_t*& dst, const uint8_t* dstEnd)
+{
+    for (; length >= 255; length -= 255) {
+        if (dst >= dstEnd) {
+            return false;
+        }
+
+        *dst++ = 255;
+    }
+
+    if (dst >= dstEnd) {
+        return false;
+    }
+
+    *dst++ = static_cast<uint8_t>(length);
+
+    return true;
+}
+
+bool GetLength(size_t& length, const uint8_t*& src, const uint8_t* srcEnd)
+{
+    uint8_t byte;
+
+    do {
+        if (src >= srcEnd) {
+            return false;
+        }
+
+        byte = *src++;
+
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+bool PutSequence(const uint8_t* literals, size_t literalsLen, size_t offset, size_t matchLen, uint8_t*& dst,
+    const uint8_t* dstEnd)
+{
+    if (dst >= dstEnd) {
+        return false;
+    }
+
+    auto token = dst++;
+
+    *token = static_cast<uint8_t>(Min<size_t>(literalsLen, 15) << 4);
+
+    if (literalsLen >= 15 && !PutLength(literalsLen - 15, dst, dstEnd)) {
+        return false;
+    }
+
+    if (literalsLen > static_cast<size_t>(dstEnd - dst)) {
+        return false;
+    }
+
+    memcpy(dst, literals, literalsLen);
+    dst += literalsLen;
+
+    // Last sequence contains literals only.
+    if (matchLen == 0) {
+        return true;
+    }
+
+    if (dstEnd - dst < 2) {
+        return false;
+    }
+
+    *dst++ = offset & 0xFF;
+    *dst++ = offset >> 8;
+
+    matchLen -= cMinMatch;
+
+    *token |= static_cast<uint8_t>(Min<size_t>(matchLen, 15));
+
+    if (matchLen >= 15 && !PutLength(matchLen - 15, dst, dstEnd)) {
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+RetWithError<size_t> CompressBlock(
+    const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, uint16_t* hashTable)
+{
+    auto   dstPos = dst;
+    auto   dstEnd = dst + dstSize;
+    size_t anchor = 0;
+
+    memset(hashTable, 0, sizeof(uint16_t) * cCompressionHashTableSize);
+
+    if (srcSize > cMatchLimit) {
+        for (size_t pos = 0; pos <= srcSize - cMatchLimit;) {
+            auto value     = Read32(src + pos);
+            auto hash      = Hash(value);
+            auto candidate = static_cast<size_t>(hashTable[hash]);
+
+            hashTable[hash] = static_cast<uint16_t>(pos);
+
+            if (candidate >= pos || pos - candidate > cMaxOffset || Read32(src + candidate) != value) {
+                pos++;
+
+                continue;
+            }
+
+            auto matchLen    = cMinMatch;
+            auto maxMatchLen = srcSize - cLastLiterals - pos;
+
+            while (matchLen < maxMatchLen && src[candidate + matchLen] == src[pos + matchLen]) {
+                matchLen++;
+            }
+
+            if (!PutSequence(src + anchor, pos - anchor, pos - candidate, matchLen, dstPos, dstEnd)) {
+                return {0, ErrorEnum::eNoMemory};
+            }
+
+            pos += matchLen;
+
+            anchor = pos;
+        }
+    }
+
+    if (!PutSequence(src + anchor, srcSize - anchor, 0, 0, dstPos, dstEnd)) {
+        return {0, ErrorEnum::eNoMemory};
+    }
+
+    return static_cast<size_t>(dstPos - dst);
+}
+
+RetWithError<size_t> DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    auto   srcEnd = src + srcSize;
+    size_t dstPos = 0;
+
+    while (src < srcEnd) {
+        auto   token       = *src++;
+        size_t literalsLen = token >> 4;
+
+        if (literalsLen == 15 && !GetLength(literalsLen, src, srcEnd)) {
+            return {0, ErrorEnum::eInvalidArgument};
+        }
+
+        if (literalsLen > static_cast<size_t>(srcEnd - src) || literalsLen > dstSize - dstPos) {
+            return {0, ErrorEnum::eInvalidArgument};
+        }
+
+        memcpy(dst + dstPos, src, literalsLen);
+
+        src    += literalsLen;
+        dstPos += literalsLen;
+
+        if (src == srcEnd) {
+            break;
+        }
+
+        if (srcEnd - src < 2) {
+            return {0, ErrorEnum::eInvalidArgument};
+        }
+
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+
+        size_t matchLen = token & 0x0F;
+
+        if (matchLen == 15 && !GetLength(matchLen, src, srcEnd)) {
+            return {0, ErrorEnum::eInvalidArgument};
+        }
+
+        matchLen += cMinMatch;
+
+        if (offset == 0 || offset > dstPos || matchLen > dstSize - dstPos) {
+            return {0, ErrorEnum::eInvalidArgument};
+        }
+
+        // Match may overlap the output, so copy byte by byte.
+        for (size_t i = 0; i < matchLen; i++, dstPos++) {
+            dst[dstPos] = dst[dstPos - offset];
+        }
+    }
+
+    return dstPos;
+}
+
+bool IsCompressedLogFile(const String& path)
+{
+    auto suffixLen = strlen(cCompressedLogSuffix);
+
+    return path.Size() > suffixLen && strcmp(path.CStr() + path.Size() - suffixLen, cCompressedLogSuffix) == 0;
+}
+
+LogCompressor::~LogCompressor()
+{
+    Stop();
+}
+
+Error LogCompressor::Start(const String& srcPath, const String& dstPath)
+{
+    Stop();
+
+    mSrcFD = open(srcPath.CStr(), O_RDONLY);
+    if (mSrcFD < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    mDstFD = open(dstPath.CStr(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (mDstFD < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        Stop();
+
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<bool> LogCompressor::CompressNextBlock()
+{
+    if (mSrcFD < 0 || mDstFD < 0) {
+        return {false, ErrorEnum::eWrongState};
+    }
+
+    auto nread = read(mSrcFD, mInput, sizeof(mInput));
+    if (nread < 0) {
+        return {false, AOS_ERROR_WRAP(errno)};
+    }
+
+    if (nread == 0) {
+        close(mSrcFD);
+
+        mSrcFD = -1;
+
+        auto ret = close(mDstFD);
+
+        mDstFD = -1;
+
+        if (ret < 0) {
+            return {false, AOS_ERROR_WRAP(errno)};
+        }
+
+        return true;
+    }
+
+    // Compressed size is limited to be less than raw size, otherwise the block is stored uncompressed.
+    CompressedBlockHeader header {static_cast<uint16_t>(nread), static_cast<uint16_t>(nread)};
+    const uint8_t*        data = mInput;
+
+    if (auto [size, err] = CompressBlock(mInput, nread, mOutput, nread - 1, mHashTable); err.IsNone()) {
+        header.mCompressedSize = static_cast<uint16_t>(size);
+        data                   = mOutput;
+    }
+
+    if (auto nwrite = write(mDstFD, &header, sizeof(header)); nwrite != sizeof(header)) {
+        return {false, nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime};
+    }
+
+    if (auto nwrite = write(mDstFD, data, header.mCompressedSize); nwrite != header.mCompressedSize) {
+        return {false, nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime};
+    }
+
+    return false;
+}
+
+void LogCompressor::Stop()
+{
+    if (mSrcFD >= 0) {
+        close(mSrcFD);
+
+        mSrcFD = -1;
+    }
+
+    if (mDstFD >= 0) {
+        close(mDstFD);
+
+        mDstFD = -1;
+    }
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef COMPRESSION_HPP_
+#define COMPRESSION_HPP_
+
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/noncopyable.hpp>
+#include <aos/common/tools/string.hpp>
+
+namespace aos::zephyr::logger {
+
+/**
+ * Compressed log file suffix.
+ */
+static constexpr auto cCompressedLogSuffix = ".lz";
+
+/**
+ * Max raw size of compressed log file block.
+ */
+static constexpr auto cCompressionBlockSize = CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION_BLOCK_SIZE;
+
+/**
+ * Compression hash table size.
+ */
+static constexpr auto cCompressionHashTableSize = 1024;
+
+/**
+ * Compressed log file block header.
+ *
+ * Compressed log file is a sequence of independently compressed blocks. Each block is LZ4 block format data preceded by
+ * this header. If compressed size is equal to raw size, the block is stored uncompressed.
+ */
+struct CompressedBlockHeader {
+    uint16_t mRawSize;
+    uint16_t mCompressedSize;
+};
+
+/**
+ * Compresses data block.
+ *
+ * @param src source data.
+ * @param srcSize source data size.
+ * @param dst destination buffer.
+ * @param dstSize destination buffer size.
+ * @param hashTable hash table of cCompressionHashTableSize entries.
+ * @return RetWithError<size_t> compressed size, eNoMemory if compressed data doesn't fit destination buffer.
+ */
+RetWithError<size_t> CompressBlock(
+    const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, uint16_t* hashTable);
+
+/**
+ * Decompresses data block.
+ *
+ * @param src compressed data.
+ * @param srcSize compressed data size.
+ * @param dst destination buffer.
+ * @param dstSize destination buffer size.
+ * @return RetWithError<size_t> decompressed size.
+ */
+RetWithError<size_t> DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+/**
+ * Checks if log file is compressed.
+ *
+ * @param path log file path.
+ * @return bool.
+ */
+bool IsCompressedLogFile(const String& path);
+
+/**
+ * Log file compressor.
+ *
+ * Log file is compressed block by block, so the caller may do other work between blocks.
+ */
+class LogCompressor : public NonCopyable {
+public:
+    /**
+     * Destructor.
+     */
+    ~LogCompressor();
+
+    /**
+     * Starts log file compression.
+     *
+     * @param srcPath source file path.
+     * @param dstPath compressed file path.
+     * @return Error.
+     */
+    Error Start(const String& srcPath, const String& dstPath);
+
+    /**
+     * Compresses next block of the log file.
+     *
+     * @return RetWithError<bool> true if the whole log file is compressed and the files are closed.
+     */
+    RetWithError<bool> CompressNextBlock();
+
+    /**
+     * Stops log file compression and closes the files.
+     */
+    void Stop();
+
+private:
+    int      mSrcFD = -1;
+    int      mDstFD = -1;
+    uint8_t  mInput[cCompressionBlockSize];
+    uint8_t  mOutput[cCompressionBlockSize];
+    uint16_t mHashTable[cCompressionHashTableSize];
+};
+
+} // namespace aos::zephyr::logger
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "flightrecorder.hpp"
+#include "fsbackend.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+K_MUTEX_DEFINE(sRecorderMutex);
+
+// Recorded entry: entry size followed by encoded log record.
+using EntrySize = uint16_t;
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Variables
+ **********************************************************************************************************************/
+
+FlightRecorder FlightRecorder::sFlightRecorder;
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+// Debug messages are recorded from different threads, so the record and the buffer are guarded by the mutex.
+void FlightRecorder::Put(const String& module, const String& message)
+{
+    k_mutex_lock(&sRecorderMutex, K_FOREVER);
+
+    mRecord.SetTime(Time::Now());
+
+    mRecord.mLevel = LOG_LEVEL_DBG;
+    mRecord.mModule.Assign(String(module.CStr(), Min(module.Size(), mRecord.mModule.MaxSize())));
+
+    mRecord.mInstanceID.Clear();
+    mRecord.mMessage.Assign(String(message.CStr(), Min(message.Size(), mRecord.mMessage.MaxSize())));
+
+    if (EncodeLogRecord(mRecord, mEntry).IsNone() && sizeof(EntrySize) + mEntry.Size() <= cBufferSize) {
+        EntrySize entrySize = mEntry.Size();
+
+        while (ring_buf_space_get(&mRingBuffer) < sizeof(entrySize) + entrySize) {
+            DropEntry();
+        }
+
+        ring_buf_put(&mRingBuffer, reinterpret_cast<const uint8_t*>(&entrySize), sizeof(entrySize));
+        ring_buf_put(&mRingBuffer, mEntry.Get(), entrySize);
+
+        mNumEntries++;
+    }
+
+    k_mutex_unlock(&sRecorderMutex);
+}
+
+Error FlightRecorder::Dump()
+{
+    Error err;
+
+    k_mutex_lock(&sRecorderMutex, K_FOREVER);
+
+    while (mNumEntries > cDumpEntries) {
+        DropEntry();
+    }
+
+    while (GetEntry()) {
+        if (auto decodeErr = DecodeLogRecord(mEntry.Get(), mEntry.Size(), mRecord).mError; !decodeErr.IsNone()) {
+            if (err.IsNone()) {
+                err = AOS_ERROR_WRAP(decodeErr);
+            }
+
+            continue;
+        }
+
+        if (auto putErr = backend::FSBackend::Get().PutLogRecord(mRecord); !putErr.IsNone() && err.IsNone()) {
+            err = AOS_ERROR_WRAP(putErr);
+        }
+    }
+
+    k_mutex_unlock(&sRecorderMutex);
+
+    return err;
+}
+
+FlightRecorder& FlightRecorder::Get()
+{
+    return sFlightRecorder;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+FlightRecorder::FlightRecorder()
+{
+    ring_buf_init(&mRingBuffer, sizeof(mRingBufferData), mRingBufferData);
+}
+
+void FlightRecorder::DropEntry()
+{
+    EntrySize entrySize = 0;
+
+    ring_buf_get(&mRingBuffer, reinterpret_cast<uint8_t*>(&entrySize), sizeof(entrySize));
+    ring_buf_get(&mRingBuffer, nullptr, entrySize);
+
+    mNumEntries--;
+}
+
+bool FlightRecorder::GetEntry()
+{
+    EntrySize entrySize = 0;
+
+    if (mNumEntries == 0) {
+        return false;
+    }
+
+    ring_buf_get(&mRingBuffer, reinterpret_cast<uint8_t*>(&entrySize), sizeof(entrySize));
+
+    mEntry.Resize(entrySize);
+
+    ring_buf_get(&mRingBuffer, mEntry.Get(), entrySize);
+
+    mNumEntries--;
+
+    return true;
+}
+
+} // namespace aos::zephyr::logger
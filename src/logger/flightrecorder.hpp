@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FLIGHTRECORDER_HPP_
+#define FLIGHTRECORDER_HPP_
+
+#include <zephyr/sys/ring_buffer.h>
+
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/noncopyable.hpp>
+#include <aos/common/tools/string.hpp>
+
+#include "logger/logrecord.hpp"
+
+namespace aos::zephyr::logger {
+
+/**
+ * Flight recorder.
+ *
+ * Keeps recent debug log records in RAM in binary log record format without formatting them. The oldest records are
+ * dropped when the buffer is full. The last records are dumped to the FS log backend on error or on demand.
+ */
+class FlightRecorder : public NonCopyable {
+public:
+    /**
+     * Records debug log message.
+     *
+     * @param module log module name.
+     * @param message log message.
+     */
+    void Put(const String& module, const String& message);
+
+    /**
+     * Dumps the last recorded messages to the FS log backend and clears the recorder.
+     *
+     * @return Error.
+     */
+    Error Dump();
+
+    /**
+     * Returns number of recorded messages.
+     *
+     * @return size_t.
+     */
+    size_t GetNumEntries() const { return mNumEntries; }
+
+    /**
+     * Returns flight recorder instance.
+     *
+     * @return FlightRecorder&.
+     */
+    static FlightRecorder& Get();
+
+private:
+    static constexpr auto cBufferSize  = CONFIG_AOS_LOG_FLIGHT_RECORDER_SIZE;
+    static constexpr auto cDumpEntries = CONFIG_AOS_LOG_FLIGHT_RECORDER_DUMP_ENTRIES;
+
+    static FlightRecorder sFlightRecorder;
+
+    FlightRecorder();
+
+    void DropEntry();
+    bool GetEntry();
+
+    LogRecord                              mRecord;
+    StaticArray<uint8_t, cMaxLogRecordLen> mEntry;
+    size_t                                 mNumEntries = 0;
+    struct ring_buf                        mRingBuffer {};
+    uint8_t                                mRingBufferData[cBufferSize] {};
+};
+
+} // namespace aos::zephyr::logger
+
+#endif
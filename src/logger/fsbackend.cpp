@@ -5,25 +5,32 @@
  */
 
 #include <assert.h>
+#include <ctype.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
 
 #include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log_backend.h>
 #include <zephyr/logging/log_backend_std.h>
 #include <zephyr/logging/log_ctrl.h>
 #include <zephyr/logging/log_output_custom.h>
 #include <zephyr/logging/log_output_dict.h>
+#include <zephyr/sys/cbprintf.h>
 #include <zephyr/sys/timeutil.h>
 
 #include <aos/common/tools/fs.hpp>
 #include <aos/common/tools/memory.hpp>
 
+#include "compression.hpp"
 #include "fsbackend.hpp"
+#include "logindex.hpp"
 #include "utils/utils.hpp"
 
 namespace aos::zephyr::logger::backend {
@@ -36,6 +43,13 @@ namespace {
 
 uint32_t sCurrentLogFormat = 0;
 
+// Timestamp printed into the currently formatted text log entry, zero if unknown.
+uint64_t sEntryTimestamp = 0;
+
+K_THREAD_STACK_DEFINE(sFlushThreadStack, CONFIG_AOS_LOG_BACKEND_FS_THREAD_STACK_SIZE);
+K_MUTEX_DEFINE(sListenerMutex);
+K_MUTEX_DEFINE(sLogRecordMutex);
+
 constexpr auto cLogFlags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP | LOG_OUTPUT_FLAG_FORMAT_TIMESTAMP;
 
 const struct log_backend* log_backend_aos_get(void);
@@ -57,6 +71,8 @@ int PrintUTCTime(
 
     auto now = Time::Now();
 
+    sEntryTimestamp = ToLogTimestamp(now);
+
     auto [utcTimeStr, err] = now.Time::ToUTCString();
     if (!err.IsNone()) {
         return printer(output, "%s", utils::ErrorToCStr(err));
@@ -70,6 +86,53 @@ int HandleLog(const uint8_t* data, size_t length, void* ctx)
     return FSBackend::Get().HandleLog(data, length);
 }
 
+// Formatted message is put directly into the message buffer, which is resized once when formatting is done.
+struct MessageBuffer {
+    char*  mData;
+    size_t mSize;
+    size_t mMaxSize;
+};
+
+int AppendMessage(int ch, void* ctx)
+{
+    auto buffer = static_cast<MessageBuffer*>(ctx);
+
+    if (buffer->mSize < buffer->mMaxSize) {
+        buffer->mData[buffer->mSize++] = static_cast<char>(ch);
+    }
+
+    return ch;
+}
+
+const char* GetModuleName(struct log_msg& msg)
+{
+    auto source = const_cast<void*>(static_cast<const void*>(log_msg_get_source(&msg)));
+    if (source == nullptr) {
+        return "";
+    }
+
+#if CONFIG_LOG_RUNTIME_FILTERING
+    auto sourceID = log_dynamic_source_id(static_cast<struct log_source_dynamic_data*>(source));
+#else
+    auto sourceID = log_const_source_id(static_cast<const struct log_source_const_data*>(source));
+#endif
+
+    auto name = log_source_name_get(log_msg_get_domain(&msg), sourceID);
+
+    return name != nullptr ? name : "";
+}
+
+size_t GetFileSize(const String& path)
+{
+    struct stat st {};
+
+    if (stat(path.CStr(), &st) != 0) {
+        return 0;
+    }
+
+    return st.st_size;
+}
+
 uint8_t __aligned(Z_LOG_MSG_ALIGNMENT) sLogBuffer[cLogEntryLen];
 LOG_OUTPUT_DEFINE(sLogOutput, reinterpret_cast<log_output_func_t>(HandleLog), sLogBuffer, cLogEntryLen);
 
@@ -91,7 +154,19 @@ void Dropped(const struct log_backend* const backend, uint32_t cnt)
 
 void Process(const struct log_backend* const backend, union log_msg_generic* msg)
 {
+    if (IS_ENABLED(CONFIG_AOS_LOG_BACKEND_FS_FLUSH_ON_ERROR)) {
+        auto level = log_msg_get_level(&msg->log);
+
+        if (level != LOG_LEVEL_NONE && level <= LOG_LEVEL_ERR) {
+            FSBackend::Get().RequestFlush();
+        }
+    }
+
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    FSBackend::Get().HandleLogMessage(msg->log);
+#else
     log_format_func_t_get(sCurrentLogFormat)(&sLogOutput, &msg->log, cLogFlags);
+#endif
 }
 
 int SetFormat(const struct log_backend* const backend, uint32_t log_type)
@@ -158,14 +233,39 @@ Error FSBackend::Init()
         fs::ClearDir(cLogDir);
     }
 
-    if (mLogFiles.IsEmpty()) {
-        return AllocateNewLogFile();
+    err = fs::MakeDirAll(cLogIndexDir);
+    if (!err.IsNone()) {
+        return err;
     }
 
-    ShrinkLogFiles();
-    UpdateLogFileNumerals();
+    // Rotated log files may be left uncompressed on reboot.
+    mCompressPending = IS_ENABLED(CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION);
 
-    return ReopenLogFile();
+    // Time of the last written log entry is unknown, so the first written log entry starts a new log index segment.
+    auto key = k_spin_lock(&mLock);
+
+    mLastTimestamp = UINT64_MAX;
+    mJumpTimestamp = 0;
+
+    k_spin_unlock(&mLock, key);
+
+    if (mLogFiles.IsEmpty() || IsCompressedLogFile(mLogFiles.Back())) {
+        err = AllocateNewLogFile();
+    } else {
+        ShrinkLogFiles(true, !mCompressPending);
+
+        err = ReopenLogFile();
+
+        RestoreLogIndex();
+    }
+
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    err = StartFlushThread();
+
+    return err;
 }
 
 size_t FSBackend::HandleLog(const uint8_t* data, size_t length)
@@ -175,14 +275,162 @@ size_t FSBackend::HandleLog(const uint8_t* data, size_t length)
     auto addedBytes = FillLogBuffer(log);
 
     if (mLogBuffer.IsFull() || (!mLogBuffer.IsEmpty() && (mLogBuffer.Back() == '\n' || mLogBuffer.Back() == '\0'))) {
-        if (auto err = WriteToFile(); !err.IsNone()) {
-            return 0;
-        }
+        PutEntry(reinterpret_cast<const uint8_t*>(mLogBuffer.Get()), mLogBuffer.Size(), sEntryTimestamp);
+
+        mLogBuffer.Clear();
+
+        sEntryTimestamp = 0;
     }
 
     return addedBytes;
 }
 
+void FSBackend::HandleLogMessage(struct log_msg& msg)
+{
+    size_t        packageLen = 0;
+    MessageBuffer message {mLogRecord.mMessage.Get(), 0, mLogRecord.mMessage.MaxSize()};
+
+    mLogRecord.SetTime(Time::Now());
+    mLogRecord.mLevel = log_msg_get_level(&msg);
+
+    String module = GetModuleName(msg);
+
+    mLogRecord.mModule.Assign(String(module.CStr(), Min(module.Size(), mLogRecord.mModule.MaxSize())));
+
+    // Instance ID is set only for instance logs put by PutInstanceLog.
+    mLogRecord.mInstanceID.Clear();
+
+    cbpprintf(reinterpret_cast<cbprintf_cb>(AppendMessage), &message, log_msg_get_package(&msg, &packageLen));
+
+    mLogRecord.mMessage.Resize(message.mSize);
+
+    if (auto err = EncodeLogRecord(mLogRecord, mLogRecordBuffer); !err.IsNone()) {
+        return;
+    }
+
+    PutEntry(mLogRecordBuffer.Get(), mLogRecordBuffer.Size(), mLogRecord.mTimestamp);
+}
+
+// Log records may be put from different threads, so the instance log record and the log file entry are guarded by the
+// mutex.
+Error FSBackend::PutInstanceLog(const String& instanceID, const String& message)
+{
+    if (!mThreadStarted) {
+        return ErrorEnum::eWrongState;
+    }
+
+    k_mutex_lock(&sLogRecordMutex, K_FOREVER);
+
+    MakeInstanceLogRecord(instanceID, message, mInstanceLogRecord);
+
+    auto err = PutRecord(mInstanceLogRecord);
+
+    k_mutex_unlock(&sLogRecordMutex);
+
+    return err;
+}
+
+Error FSBackend::PutLogRecord(const LogRecord& record)
+{
+    if (!mThreadStarted) {
+        return ErrorEnum::eWrongState;
+    }
+
+    k_mutex_lock(&sLogRecordMutex, K_FOREVER);
+
+    auto err = PutRecord(record);
+
+    k_mutex_unlock(&sLogRecordMutex);
+
+    return err;
+}
+
+// Without runtime filtering, messages which pass the compile time level are written by the active backend.
+bool FSBackend::IsLogged([[maybe_unused]] uint32_t sourceID, [[maybe_unused]] uint8_t level) const
+{
+    if (!log_backend_is_active(log_backend_aos_get())) {
+        return false;
+    }
+
+#if CONFIG_LOG_RUNTIME_FILTERING
+    return log_filter_get(log_backend_aos_get(), Z_LOG_LOCAL_DOMAIN_ID, sourceID, true) >= level;
+#else
+    return true;
+#endif
+}
+
+void FSBackend::RequestFlush()
+{
+    mFlushPending = true;
+}
+
+Error FSBackend::Sync()
+{
+    if (!mThreadStarted) {
+        return ErrorEnum::eWrongState;
+    }
+
+    auto key = k_spin_lock(&mLock);
+
+    mFlushRequested = true;
+
+    k_spin_unlock(&mLock, key);
+
+    k_sem_give(&mWakeSem);
+
+    for (auto start = k_uptime_get(); !IsSynced(); k_msleep(1)) {
+        if (k_uptime_get() - start >= cSyncTimeout) {
+            return AOS_ERROR_WRAP(ErrorEnum::eTimeout);
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error FSBackend::Subscribe(LogListenerItf& listener)
+{
+    Error err = ErrorEnum::eNone;
+
+    k_mutex_lock(&sListenerMutex, K_FOREVER);
+
+    if (mListener != nullptr) {
+        err = ErrorEnum::eAlreadyExist;
+    } else {
+        mListener = &listener;
+    }
+
+    k_mutex_unlock(&sListenerMutex);
+
+    return err;
+}
+
+Error FSBackend::Unsubscribe(LogListenerItf& listener)
+{
+    Error err = ErrorEnum::eNone;
+
+    k_mutex_lock(&sListenerMutex, K_FOREVER);
+
+    if (mListener != &listener) {
+        err = ErrorEnum::eNotFound;
+    } else {
+        mListener = nullptr;
+    }
+
+    k_mutex_unlock(&sListenerMutex);
+
+    return err;
+}
+
+FSBackendStats FSBackend::GetStats()
+{
+    auto key   = k_spin_lock(&mLock);
+    auto stats = mStats;
+
+    k_spin_unlock(&mLock, key);
+
+    return stats;
+}
+
 FSBackend& FSBackend::Get()
 {
     return sLogBackend;
@@ -199,24 +447,303 @@ void FSBackend::SetCustomTimestamp()
  * Private
  **********************************************************************************************************************/
 
-Error FSBackend::WriteToFile()
+void FSBackend::FlushThread(void* backend, void*, void*)
+{
+    auto instance = static_cast<FSBackend*>(backend);
+
+    while (true) {
+        k_sem_take(&instance->mWakeSem, cFlushPeriod > 0 ? K_MSEC(cFlushPeriod) : K_FOREVER);
+
+        instance->ProcessBuffer();
+    }
+}
+
+Error FSBackend::StartFlushThread()
+{
+    if (mThreadStarted) {
+        return ErrorEnum::eNone;
+    }
+
+    ring_buf_init(&mRingBuffer, sizeof(mRingBufferData), mRingBufferData);
+    k_sem_init(&mWakeSem, 0, 1);
+
+    k_thread_create(&mThread, sFlushThreadStack, K_THREAD_STACK_SIZEOF(sFlushThreadStack), FlushThread, this, nullptr,
+        nullptr, cThreadPriority, 0, K_NO_WAIT);
+    k_thread_name_set(&mThread, "aos_log_fs");
+
+    mThreadStarted = true;
+
+    return ErrorEnum::eNone;
+}
+
+Error FSBackend::PutRecord(const LogRecord& record)
+{
+    if (auto err = MakeLogFileEntry(record, mLogFileEntry); !err.IsNone()) {
+        return err;
+    }
+
+    PutEntry(reinterpret_cast<const uint8_t*>(mLogFileEntry.Get()), mLogFileEntry.Size(), record.mTimestamp);
+
+    return ErrorEnum::eNone;
+}
+
+// Called from the log processing context: it should never block, so the entry is either put into the ring buffer
+// as a whole or dropped. Clock jumps are detected here from the entry timestamp, which is known when the entry is
+// formatted, and passed to the flush thread as log index events, so the flush thread doesn't parse each entry. The
+// entry is dropped as well if there is no room for its log index event.
+void FSBackend::PutEntry(const uint8_t* data, size_t size, uint64_t timestamp)
+{
+    bool wakeUp = false;
+    auto key    = k_spin_lock(&mLock);
+
+    auto clockJump = timestamp != 0 && timestamp < mLastTimestamp;
+    auto jumpBack  = timestamp != 0 && !clockJump && mJumpTimestamp != 0 && timestamp >= mJumpTimestamp;
+    auto hasEvent  = clockJump || jumpBack;
+
+    if (ring_buf_space_get(&mRingBuffer) >= size && !(hasEvent && mIndexEvents.IsFull())) {
+        ring_buf_put(&mRingBuffer, data, size);
+
+        if (hasEvent) {
+            mIndexEvents.PushBack({mPutPos, timestamp, clockJump});
+        }
+
+        if (clockJump && mLastTimestamp != UINT64_MAX) {
+            mJumpTimestamp = Max(mJumpTimestamp, mLastTimestamp);
+        } else if (jumpBack) {
+            mJumpTimestamp = 0;
+        }
+
+        if (timestamp != 0) {
+            mLastTimestamp = timestamp;
+        }
+
+        mPutPos += size;
+
+        if (mFlushPending) {
+            mFlushRequested = true;
+            mFlushPending   = false;
+        }
+
+        wakeUp = mFlushRequested || ring_buf_size_get(&mRingBuffer) >= cBatchSize;
+    } else {
+        mStats.mDroppedBytes += size;
+
+        wakeUp = true;
+    }
+
+    k_spin_unlock(&mLock, key);
+
+    if (wakeUp) {
+        k_sem_give(&mWakeSem);
+    }
+}
+
+// Returns size of whole log entries at the beginning of the data which fit into the limit.
+size_t FSBackend::GetEntriesSize(const uint8_t* data, size_t size, size_t limit) const
+{
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    size_t entriesSize = 0;
+
+    while (entriesSize < size) {
+        auto [recordSize, err] = GetLogRecordSize(data + entriesSize, size - entriesSize);
+        if (!err.IsNone() || entriesSize + recordSize > limit) {
+            break;
+        }
+
+        entriesSize += recordSize;
+    }
+
+    return entriesSize;
+#else
+    for (auto i = Min(size, limit); i > 0; i--) {
+        if (data[i - 1] == '\n' || data[i - 1] == '\0') {
+            return i;
+        }
+    }
+
+    return 0;
+#endif
+}
+
+// Takes next batch from the ring buffer. If the ring buffer contains more data than the batch can hold, the batch is
+// cut at the last entry end to not split log entries between log files.
+size_t FSBackend::GetBatch()
+{
+    auto   key       = k_spin_lock(&mLock);
+    size_t batchSize = ring_buf_peek(&mRingBuffer, mBatchBuffer, sizeof(mBatchBuffer));
+
+    if (batchSize > 0 && ring_buf_size_get(&mRingBuffer) > batchSize) {
+        if (auto entriesSize = GetEntriesSize(mBatchBuffer, batchSize, batchSize); entriesSize > 0) {
+            batchSize = entriesSize;
+        }
+    }
+
+    ring_buf_get(&mRingBuffer, nullptr, batchSize);
+
+    mBatchPos = mTakePos;
+    mTakePos += batchSize;
+
+    k_spin_unlock(&mLock, key);
+
+    return batchSize;
+}
+
+// Rotated log files are compressed one block per iteration, so log entries put meanwhile are written after one block
+// compression at most.
+void FSBackend::ProcessBuffer()
+{
+    do {
+        WriteBuffer();
+    } while (CompressLogFiles());
+}
+
+void FSBackend::WriteBuffer()
+{
+    auto key = k_spin_lock(&mLock);
+
+    mWriting = true;
+
+    k_spin_unlock(&mLock, key);
+
+    while (auto batchSize = GetBatch()) {
+        auto start = k_uptime_ticks();
+        auto err   = WriteToFile(mBatchBuffer, batchSize);
+        auto time  = k_ticks_to_us_floor64(k_uptime_ticks() - start);
+
+        NotifyListener(mBatchBuffer, batchSize);
+
+        key = k_spin_lock(&mLock);
+
+        if (err.IsNone()) {
+            mStats.mNumBatches++;
+            mStats.mTotalBatchSize   += batchSize;
+            mStats.mTotalWriteTimeUs += time;
+
+            mStats.mMaxBatchSize   = Max(mStats.mMaxBatchSize, static_cast<size_t>(batchSize));
+            mStats.mMaxWriteTimeUs = Max(mStats.mMaxWriteTimeUs, time);
+        } else {
+            mStats.mDroppedBytes += batchSize;
+        }
+
+        k_spin_unlock(&mLock, key);
+    }
+
+    key = k_spin_lock(&mLock);
+
+    auto flushRequested = mFlushRequested;
+
+    mFlushRequested = false;
+
+    k_spin_unlock(&mLock, key);
+
+    if (flushRequested || (mUnflushedSize > 0 && IsFlushRequired())) {
+        Flush();
+    }
+
+    key = k_spin_lock(&mLock);
+
+    mWriting = false;
+
+    k_spin_unlock(&mLock, key);
+}
+
+bool FSBackend::IsSynced()
+{
+    auto key    = k_spin_lock(&mLock);
+    auto synced = ring_buf_is_empty(&mRingBuffer) && !mWriting && !mFlushRequested;
+
+    k_spin_unlock(&mLock, key);
+
+    return synced;
+}
+
+Error FSBackend::WriteToFile(const uint8_t* data, size_t size)
 {
     if (mFD == -1) {
         return ErrorEnum::eFailed;
     }
 
-    if (mFileSize + mLogBuffer.Size() > cFileSizeLimit) {
-        if (auto err = AllocateNewLogFile(); !err.IsNone()) {
+    while (size > 0) {
+        auto chunkSize = GetChunkSize(data, size);
+        if (chunkSize == 0) {
+            if (auto err = AllocateNewLogFile(); !err.IsNone()) {
+                return err;
+            }
+
+            continue;
+        }
+
+        auto offset = mFileSize;
+
+        if (auto err = WriteChunk(data, chunkSize); !err.IsNone()) {
             return err;
         }
+
+        // Index is updated only for written data, so it never refers to log entries missing in the log file.
+        UpdateLogIndex(data, chunkSize, offset, mBatchPos + (data - mBatchBuffer));
+
+        data += chunkSize;
+        size -= chunkSize;
     }
 
-    ssize_t rc = write(mFD, mLogBuffer.Get(), mLogBuffer.Size());
-    if (rc < 0) {
-        return ErrorEnum::eFailed;
+    return ErrorEnum::eNone;
+}
+
+Error FSBackend::WriteChunk(const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t rc = write(mFD, data, size);
+        if (rc < 0) {
+            return ErrorEnum::eFailed;
+        }
+
+        // Nothing is written (e.g. no space left): retrying would spin forever.
+        if (rc == 0) {
+            return AOS_ERROR_WRAP(Error(ErrorEnum::eRuntime, "can't write log file"));
+        }
+
+        data           += rc;
+        size           -= rc;
+        mFileSize      += rc;
+        mUnflushedSize += rc;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Returns size of the data part which fits into the current log file without splitting log entries. Zero means a new
+// log file should be allocated.
+size_t FSBackend::GetChunkSize(const uint8_t* data, size_t size) const
+{
+    auto availableSize = mFileSize < cFileSizeLimit ? cFileSizeLimit - mFileSize : 0;
+
+    if (size <= availableSize) {
+        return size;
     }
 
-    mLogBuffer.Clear();
+    if (auto entriesSize = GetEntriesSize(data, size, availableSize); entriesSize > 0) {
+        return entriesSize;
+    }
+
+    // Log entry doesn't fit even into the empty file: split it.
+    return mFileSize == 0 ? availableSize : 0;
+}
+
+bool FSBackend::IsFlushRequired()
+{
+    if (mUnflushedSize >= cFlushSize) {
+        return true;
+    }
+
+    return cFlushPeriod > 0 && k_uptime_get() - mLastFlushTime >= cFlushPeriod;
+}
+
+// Currently, zephyr doesn't provide Posix API (fsync) to flush the file correctly. As workaround, we reopen the file
+// the same way the storage does, but only according to the flush policy instead of after each log line.
+Error FSBackend::Flush()
+{
+    mUnflushedSize = 0;
+    mLastFlushTime = k_uptime_get();
 
     return ReopenLogFile();
 }
@@ -227,12 +754,10 @@ Error FSBackend::RestoreLogFiles()
 
     auto onError = DeferRelease(&err, [this](Error* err) {
         if (err->IsNone()) {
-            mLogFiles.Sort();
-
             return;
         }
 
-        mCurrentLogFileNumeral = 0;
+        mNextLogFileNumber = 0;
         mLogFiles.Clear();
     });
 
@@ -242,13 +767,17 @@ Error FSBackend::RestoreLogFiles()
             continue;
         }
 
-        auto fileNumResult = GetFileNumber(dirIterator->mPath);
-        if (!fileNumResult.mError.IsNone()) {
+        if (!IsLogFileName(dirIterator->mPath)) {
+            // Log files of the previous naming scheme can't be ordered with the current ones: drop all of them.
+            if (strncmp(dirIterator->mPath.CStr(), cLogPrefix, strlen(cLogPrefix)) == 0) {
+                err = Error(ErrorEnum::eInvalidArgument, "invalid log file name");
+
+                return err;
+            }
+
             continue;
         }
 
-        mCurrentLogFileNumeral = Max(mCurrentLogFileNumeral, fileNumResult.mValue);
-
         if (err = mLogFiles.EmplaceBack(); !err.IsNone()) {
             return err;
         }
@@ -256,45 +785,97 @@ Error FSBackend::RestoreLogFiles()
         fs::AppendPath(mLogFiles.Back(), dirIterator.GetRootPath(), dirIterator->mPath);
     }
 
+    if (mLogFiles.IsEmpty()) {
+        return ErrorEnum::eNone;
+    }
+
+    // Log file numbers are zero padded, so sorting by name sorts files by number and only the last file number has to
+    // be parsed.
+    mLogFiles.Sort();
+
+    if (err = RemoveDuplicatedLogFiles(); !err.IsNone()) {
+        return err;
+    }
+
+    uint64_t lastFileNum = 0;
+
+    if (Tie(lastFileNum, err) = GetFileNumber(mLogFiles.Back()); !err.IsNone()) {
+        return err;
+    }
+
+    mNextLogFileNumber = lastFileNum + 1;
+
     return ErrorEnum::eNone;
 }
 
-RetWithError<size_t> FSBackend::GetFileNumber(const String& path)
+// Removes uncompressed log file if its compressed copy exists, e.g. when reboot happened during compression.
+Error FSBackend::RemoveDuplicatedLogFiles()
 {
-    if (path.Size() < String(cLogPrefix).Size()) {
-        return {{}, ErrorEnum::eInvalidArgument};
-    }
+    for (auto it = mLogFiles.begin(); it != mLogFiles.end() && it + 1 != mLogFiles.end();) {
+        StaticString<cFilePathLen> compressedPath = *it;
 
-    String number(path.CStr() + String(cLogPrefix).Size());
+        compressedPath.Append(cCompressedLogSuffix);
 
-    auto fileNum = atoi(number.CStr());
-    if (fileNum < 0 || fileNum > cMaxLogFileNumeral) {
-        return {{}, ErrorEnum::eInvalidArgument};
+        if (compressedPath != *(it + 1)) {
+            it++;
+
+            continue;
+        }
+
+        if (auto err = fs::Remove(*it); !err.IsNone()) {
+            return err;
+        }
+
+        mLogFiles.Erase(it);
     }
 
-    return fileNum;
+    return ErrorEnum::eNone;
 }
 
-StaticString<cFilePathLen> FSBackend::GetFileName(size_t fileNum)
+bool FSBackend::IsLogFileName(const String& name) const
 {
-    StaticString<cFilePathLen> path;
+    const auto prefixLen = strlen(cLogPrefix);
+    const auto numberEnd = prefixLen + cLogFileNumberLen;
 
-    path.Format("%s/%s%ld", cLogDir, cLogPrefix, fileNum);
+    if (name.Size() < numberEnd || strncmp(name.CStr(), cLogPrefix, prefixLen) != 0) {
+        return false;
+    }
 
-    return path;
+    if (name.Size() != numberEnd && strcmp(name.CStr() + numberEnd, cCompressedLogSuffix) != 0) {
+        return false;
+    }
+
+    for (auto i = prefixLen; i < numberEnd; i++) {
+        if (!isdigit(static_cast<unsigned char>(name.CStr()[i]))) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
-size_t FSBackend::GetFileSize(const String& path)
+RetWithError<uint64_t> FSBackend::GetFileNumber(const String& path) const
 {
-    struct stat fileStat;
+    auto numberEnd = IsCompressedLogFile(path) ? path.Size() - strlen(cCompressedLogSuffix) : path.Size();
 
-    if (stat(path.CStr(), &fileStat) == -1) {
-        return 0;
+    if (numberEnd < cLogFileNumberLen) {
+        return {{}, ErrorEnum::eInvalidArgument};
     }
 
-    return fileStat.st_size;
+    return static_cast<uint64_t>(strtoull(path.CStr() + numberEnd - cLogFileNumberLen, nullptr, 10));
+}
+
+StaticString<cFilePathLen> FSBackend::GetFileName(uint64_t fileNum) const
+{
+    StaticString<cFilePathLen> path;
+
+    path.Format("%s/%s%0*" PRIu64, cLogDir, cLogPrefix, cLogFileNumberLen, fileNum);
+
+    return path;
 }
 
+// On rotation the closed log file is scheduled for compression, the oldest log files are removed to fit into the log
+// files limit and the new one with the next number is created.
 Error FSBackend::AllocateNewLogFile()
 {
     if (mFD != -1) {
@@ -303,54 +884,348 @@ Error FSBackend::AllocateNewLogFile()
         mFD = -1;
     }
 
-    if (auto err = ShrinkLogFiles(); !err.IsNone()) {
-        return err;
-    }
+    // Rotated log file is compressed later by the flush thread. Until then, log files are shrunk by number only, so the
+    // rotated file is not accounted by its uncompressed size. They are shrunk by size when it is compressed.
+    mCompressPending = IS_ENABLED(CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION);
 
-    if (mCurrentLogFileNumeral == cMaxLogFileNumeral) {
-        if (auto err = UpdateLogFileNumerals(); !err.IsNone()) {
-            return err;
-        }
+    if (auto err = ShrinkLogFiles(false, !mCompressPending); !err.IsNone()) {
+        return err;
     }
 
-    auto logFilePath = GetFileName(mCurrentLogFileNumeral++);
+    auto logFilePath = GetFileName(mNextLogFileNumber++);
 
     if (auto err = mLogFiles.EmplaceBack(logFilePath); !err.IsNone()) {
         return err;
     }
 
+    mNextIndexOffset = 0;
+    mNumIndexEntries = 0;
+
+    mSegmentInstances.Clear();
+
+    // Remove stale index which may be left if log files were removed without their indexes.
+    RemoveLogIndex(logFilePath);
+
     return ReopenLogFile();
 }
 
-Error FSBackend::ShrinkLogFiles()
+// Rotated log files are immutable, so all of them except the active one are compressed. Compression is done into
+// a temporary file which then replaces the original one. Each call compresses one block and returns true if there are
+// more blocks to compress. When a log file is compressed or compression fails, log files are shrunk by size.
+bool FSBackend::CompressLogFiles()
 {
-    if (mLogFiles.IsEmpty() || !mLogFiles.IsFull()) {
-        return ErrorEnum::eNone;
+#if CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION
+    if (!mCompressPending) {
+        return false;
     }
 
-    if (auto err = fs::Remove(mLogFiles.Front()); !err.IsNone()) {
+    auto tmpPath = fs::JoinPath(cLogDir, cCompressTmpFileName);
+
+    if (mCompressPath.IsEmpty()) {
+        auto it = mLogFiles.FindIf([](const String& path) { return !IsCompressedLogFile(path); });
+
+        if (it == mLogFiles.end() || it + 1 == mLogFiles.end()) {
+            mCompressPending = false;
+
+            ShrinkLogFiles(true, true);
+
+            return false;
+        }
+
+        if (auto err = mCompressor.Start(*it, tmpPath); !err.IsNone()) {
+            fs::Remove(tmpPath);
+
+            mCompressPending = false;
+
+            ShrinkLogFiles(true, true);
+
+            return false;
+        }
+
+        mCompressPath = *it;
+    }
+
+    auto [done, err] = mCompressor.CompressNextBlock();
+    if (err.IsNone() && !done) {
+        return true;
+    }
+
+    if (err.IsNone()) {
+        err = ReplaceCompressedLogFile(tmpPath);
+    }
+
+    if (!err.IsNone()) {
+        StopCompression();
+
+        mCompressPending = false;
+    }
+
+    mCompressPath.Clear();
+
+    ShrinkLogFiles(true, true);
+
+    return mCompressPending;
+#else
+    return false;
+#endif
+}
+
+Error FSBackend::ReplaceCompressedLogFile(const String& tmpPath)
+{
+#if CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION
+    auto it = mLogFiles.Find(mCompressPath);
+    if (it == mLogFiles.end()) {
+        return ErrorEnum::eNotFound;
+    }
+
+    StaticString<cFilePathLen> compressedPath = *it;
+
+    compressedPath.Append(cCompressedLogSuffix);
+
+    if (auto err = fs::Rename(tmpPath, compressedPath); !err.IsNone()) {
+        return err;
+    }
+
+    // Log readers skip the original file while its compressed copy exists.
+    if (auto err = fs::Remove(*it); !err.IsNone()) {
         return err;
     }
 
-    mLogFiles.Erase(mLogFiles.begin());
+    *it = compressedPath;
+#else
+    (void)tmpPath;
+#endif
 
     return ErrorEnum::eNone;
 }
 
-Error FSBackend::UpdateLogFileNumerals()
+void FSBackend::StopCompression()
+{
+#if CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION
+    mCompressor.Stop();
+    mCompressPath.Clear();
+
+    fs::Remove(fs::JoinPath(cLogDir, cCompressTmpFileName));
+#endif
+}
+
+// Log index entry is added for the first log entry written after the log file crosses the next index interval. Data is
+// always written starting from a log entry boundary. Log readers rely on log entries of a log index segment being not
+// earlier than its index entry, so if the wall clock goes backwards (e.g. on time sync), a new segment is started from
+// the earlier log entry and its index entry is marked as a clock jump. Earlier log entries are also written by the
+// flight recorder dump: they are followed by the current log entries again, so a regular segment is started as soon as
+// the log entry time gets back to the time before the jump, and the current log entries are indexed precisely. Clock
+// jumps are detected by PutEntry and taken from the log index events, so the entry timestamp is parsed only when the
+// index interval is crossed. Instance index entry is added for the first log entry of each instance in the current log
+// index segment. Log entries written before the first log index entry don't belong to any segment and are not indexed.
+void FSBackend::UpdateLogIndex(const uint8_t* data, size_t size, size_t offset, uint64_t streamPos)
 {
-    mCurrentLogFileNumeral = 0;
+    StaticArray<InstanceIndexEntry, cMaxNumInstances> entries;
+    StaticString<cInstanceIDLen>                      instanceID;
+    IndexEvent                                        event {};
+
+    // Events of log entries dropped on write failures are skipped.
+    auto hasEvent = TakeIndexEvent(streamPos, event);
+
+    for (size_t pos = 0; pos < size;) {
+        auto entrySize = GetEntryInstanceID(data + pos, size - pos, instanceID);
+        if (entrySize == 0) {
+            break;
+        }
+
+        Optional<LogIndexEntry> indexEntry;
+
+        if (hasEvent && event.mPos == streamPos + pos) {
+            indexEntry.SetValue({offset + pos, event.mTimestamp, event.mClockJump ? LogIndexEntry::cClockJumpFlag : 0});
+
+            hasEvent = TakeIndexEvent(streamPos + pos + 1, event);
+        } else if (offset + pos >= mNextIndexOffset) {
+            if (auto [timestamp, err] = GetEntryTimestamp(data + pos, entrySize); err.IsNone()) {
+                indexEntry.SetValue({offset + pos, timestamp, 0});
+            }
+        }
+
+        if (indexEntry.HasValue() && AppendLogIndexEntry(mLogFiles.Back(), indexEntry.GetValue()).IsNone()) {
+            mNextIndexOffset = offset + pos + cLogIndexInterval;
+            mNumIndexEntries++;
+
+            mSegmentInstances.Clear();
+        }
 
-    for (auto& logFile : mLogFiles) {
-        auto newPath = GetFileName(mCurrentLogFileNumeral);
+        pos += entrySize;
+
+        if (instanceID.IsEmpty() || mNumIndexEntries == 0) {
+            continue;
+        }
 
-        if (auto err = fs::Rename(logFile, newPath); !err.IsNone()) {
+        auto key = GetInstanceKey(instanceID);
+
+        if (mSegmentInstances.FindIf([key](uint32_t instanceKey) { return instanceKey == key; })
+            != mSegmentInstances.end()) {
+            continue;
+        }
+
+        // If there are too many instances in the segment, they are indexed without deduplication.
+        mSegmentInstances.PushBack(key);
+
+        if (entries.IsFull()) {
+            AppendInstanceIndexEntries(mLogFiles.Back(), entries);
+            entries.Clear();
+        }
+
+        entries.PushBack({key, static_cast<uint32_t>(mNumIndexEntries - 1)});
+    }
+
+    AppendInstanceIndexEntries(mLogFiles.Back(), entries);
+}
+
+// Removes log index events before the stream position and returns the next one.
+bool FSBackend::TakeIndexEvent(uint64_t pos, IndexEvent& event)
+{
+    auto key = k_spin_lock(&mLock);
+
+    while (!mIndexEvents.IsEmpty() && mIndexEvents.Front().mPos < pos) {
+        mIndexEvents.Erase(mIndexEvents.begin());
+    }
+
+    auto found = !mIndexEvents.IsEmpty();
+    if (found) {
+        event = mIndexEvents.Front();
+    }
+
+    k_spin_unlock(&mLock, key);
+
+    return found;
+}
+
+RetWithError<uint64_t> FSBackend::GetEntryTimestamp(const uint8_t* data, size_t size) const
+{
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    return GetLogRecordTimestamp(data, size);
+#else
+    size_t lineSize = 0;
+    auto   maxSize  = Min(size, cLogEntryLen);
+
+    while (lineSize < maxSize && data[lineSize] != '\n') {
+        lineSize++;
+    }
+
+    auto [time, err] = Time::UTC(String(reinterpret_cast<const char*>(data), lineSize));
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
+    return ToLogTimestamp(time);
+#endif
+}
+
+// Continues the index of the current log file. If the log file has no index, e.g. it is written by the previous
+// version, the index is started from the current file position.
+void FSBackend::RestoreLogIndex()
+{
+    mNextIndexOffset = mFileSize;
+    mNumIndexEntries = 0;
+
+    mSegmentInstances.Clear();
+
+    auto [entry, err] = GetLastLogIndexEntry(mLogFiles.Back());
+    if (!err.IsNone()) {
+        return;
+    }
+
+    if (Tie(mNumIndexEntries, err) = GetLogIndexSize(mLogFiles.Back()); !err.IsNone()) {
+        return;
+    }
+
+    mNextIndexOffset = entry.mOffset + cLogIndexInterval;
+}
+
+// Returns size of the first log entry of the data and its instance ID. Instance console logs are prefixed with
+// instance ID in square brackets, see runner::ConsoleReader.
+size_t FSBackend::GetEntryInstanceID(const uint8_t* data, size_t size, String& instanceID) const
+{
+    instanceID.Clear();
+
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    auto [recordSize, err] = GetLogRecordSize(data, size);
+    if (!err.IsNone()) {
+        return 0;
+    }
+
+    if (err = GetLogRecordInstanceID(data, recordSize, instanceID); !err.IsNone()) {
+        instanceID.Clear();
+    }
+
+    return recordSize;
+#else
+    auto   line     = reinterpret_cast<const char*>(data);
+    size_t lineSize = 0;
+
+    while (lineSize < size && line[lineSize] != '\n' && line[lineSize] != '\0') {
+        lineSize++;
+    }
+
+    // Instance ID follows the instance log module name: "<time> <level> <module>: [instanceID]message".
+    const auto moduleSize = strlen(cInstanceLogModule);
+
+    for (size_t i = 0; i + 2 < lineSize; i++) {
+        if (line[i] != ':' || line[i + 1] != ' ' || line[i + 2] != '[') {
+            continue;
+        }
+
+        if (i < moduleSize + 1 || line[i - moduleSize - 1] != ' '
+            || strncmp(line + i - moduleSize, cInstanceLogModule, moduleSize) != 0) {
+            break;
+        }
+
+        auto start = i + 3;
+        auto end   = start;
+
+        while (end < lineSize && end - start < cInstanceIDLen && line[end] != ']') {
+            end++;
+        }
+
+        if (end < lineSize && line[end] == ']') {
+            instanceID.Assign(String(line + start, end - start));
+        }
+
+        break;
+    }
+
+    return lineSize < size ? lineSize + 1 : size;
+#endif
+}
+
+// The oldest log files are removed until the rotated log files and the active one of the max size fit into the log
+// size limit. Rotated files are accounted by their size on disk, so more compressed log files are kept.
+Error FSBackend::ShrinkLogFiles(bool hasActiveFile, bool checkSize)
+{
+    auto   numRotatedFiles = hasActiveFile && !mLogFiles.IsEmpty() ? mLogFiles.Size() - 1 : mLogFiles.Size();
+    size_t rotatedSize     = 0;
+
+    for (size_t i = 0; i < numRotatedFiles; i++) {
+        rotatedSize += GetFileSize(mLogFiles[i]);
+    }
+
+    while (numRotatedFiles > 0
+        && ((!hasActiveFile && mLogFiles.IsFull()) || (checkSize && rotatedSize + cFileSizeLimit > cLogSizeLimit))) {
+        rotatedSize -= Min(rotatedSize, GetFileSize(mLogFiles.Front()));
+
+#if CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION
+        if (mLogFiles.Front() == mCompressPath) {
+            StopCompression();
+        }
+#endif
+
+        if (auto err = fs::Remove(mLogFiles.Front()); !err.IsNone()) {
             return err;
         }
 
-        logFile = newPath;
+        RemoveLogIndex(mLogFiles.Front());
+
+        mLogFiles.Erase(mLogFiles.begin());
 
-        ++mCurrentLogFileNumeral;
+        numRotatedFiles--;
     }
 
     return ErrorEnum::eNone;
@@ -375,7 +1250,12 @@ Error FSBackend::ReopenLogFile()
         return AOS_ERROR_WRAP(errno);
     }
 
-    mFileSize = GetFileSize(mLogFiles.Back());
+    auto fileSize = lseek(mFD, 0, SEEK_END);
+    if (fileSize < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    mFileSize = fileSize;
 
     return ErrorEnum::eNone;
 }
@@ -393,4 +1273,16 @@ size_t FSBackend::FillLogBuffer(const String& log)
     return mLogBuffer.Size() - originalSize;
 }
 
+// Listener is called under the mutex, so it can't be unsubscribed while it handles log entries.
+void FSBackend::NotifyListener(const uint8_t* data, size_t size)
+{
+    k_mutex_lock(&sListenerMutex, K_FOREVER);
+
+    if (mListener != nullptr) {
+        mListener->OnLogEntries(data, size);
+    }
+
+    k_mutex_unlock(&sListenerMutex);
+}
+
 } // namespace aos::zephyr::logger::backend
@@ -7,19 +7,56 @@
 #ifndef FSBACKEND_HPP_
 #define FSBACKEND_HPP_
 
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log_msg.h>
+#include <zephyr/sys/ring_buffer.h>
+
 #include <aos/common/cloudprotocol/log.hpp>
 #include <aos/common/tools/error.hpp>
 #include <aos/common/tools/memory.hpp>
 #include <aos/common/tools/noncopyable.hpp>
 
+#include "logger/compression.hpp"
+#include "logger/logindex.hpp"
+#include "logger/logrecord.hpp"
 #include "logger/types.hpp"
 
 namespace aos::zephyr::logger::backend {
 
+/**
+ * File system backend statistics.
+ */
+struct FSBackendStats {
+    size_t   mDroppedBytes;
+    size_t   mNumBatches;
+    size_t   mTotalBatchSize;
+    size_t   mMaxBatchSize;
+    uint64_t mTotalWriteTimeUs;
+    uint64_t mMaxWriteTimeUs;
+};
+
 /**
  * File system backend logger.
  *
- * This logger writes logs to the file system.
+ * This logger writes logs to the file system. Log messages are put into the RAM ring buffer and written to the file
+ * by the low priority flush thread in batches, so the log processing context is never blocked by file operations.
+ * If the ring buffer is full, the message is dropped and accounted in the statistics.
+ *
+ * If CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT is enabled, messages are stored as compact binary log records (see
+ * LogRecord) instead of formatted text lines.
+ *
+ * For each log file the backend maintains a sparse time index (see LogIndexEntry) and an instance index (see
+ * InstanceIndexEntry), which are used by log readers to skip log entries out of the requested time range or not
+ * related to the requested instance.
+ *
+ * Written log entries are also passed to the subscribed log listener, which allows following logs without rescanning
+ * log files.
+ *
+ * Instance console output is put directly into the log buffer by PutInstanceLog, so chatty instances don't load the
+ * logging subsystem.
+ *
+ * If CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION is enabled, rotated log files are compressed by the flush thread one block
+ * at a time between log batches.
  */
 class FSBackend : public NonCopyable {
 public:
@@ -44,6 +81,79 @@ public:
      */
     size_t HandleLog(const uint8_t* data, size_t length);
 
+    /**
+     * Handles log message in binary log format.
+     *
+     * @param msg log message.
+     */
+    void HandleLogMessage(struct log_msg& msg);
+
+    /**
+     * Puts instance log message directly into the log buffer.
+     *
+     * The message is put as info message of the instance log module bypassing the logging subsystem, so it is not
+     * formatted by the logging subsystem and not passed to other log backends.
+     *
+     * @param instanceID instance ID.
+     * @param message log message.
+     * @return Error.
+     */
+    Error PutInstanceLog(const String& instanceID, const String& message);
+
+    /**
+     * Puts log record directly into the log buffer.
+     *
+     * The record is put as is bypassing the logging subsystem, so its time and level are preserved.
+     *
+     * @param record log record.
+     * @return Error.
+     */
+    Error PutLogRecord(const LogRecord& record);
+
+    /**
+     * Checks if log messages of the log source and level are written by the backend.
+     *
+     * @param sourceID log source ID.
+     * @param level log level.
+     * @return bool.
+     */
+    bool IsLogged(uint32_t sourceID, uint8_t level) const;
+
+    /**
+     * Requests log file flush after the current log message is written.
+     */
+    void RequestFlush();
+
+    /**
+     * Writes all buffered log messages to the file and flushes it.
+     *
+     * @return Error
+     */
+    Error Sync();
+
+    /**
+     * Subscribes log listener.
+     *
+     * @param listener log listener.
+     * @return Error.
+     */
+    Error Subscribe(LogListenerItf& listener);
+
+    /**
+     * Unsubscribes log listener.
+     *
+     * @param listener log listener.
+     * @return Error.
+     */
+    Error Unsubscribe(LogListenerItf& listener);
+
+    /**
+     * Returns backend statistics.
+     *
+     * @return FSBackendStats.
+     */
+    FSBackendStats GetStats();
+
     /**
      * Returns fs backend logger instance.
      * @return FS&
@@ -56,28 +166,97 @@ public:
     static void SetCustomTimestamp();
 
 private:
-    static constexpr auto cMaxLogFileNumeral = 2 * cMaxLogFiles;
+    static constexpr auto cFlushSize      = CONFIG_AOS_LOG_BACKEND_FS_FLUSH_SIZE;
+    static constexpr auto cFlushPeriod    = CONFIG_AOS_LOG_BACKEND_FS_FLUSH_PERIOD;
+    static constexpr auto cBufferSize     = CONFIG_AOS_LOG_BACKEND_FS_BUFFER_SIZE;
+    static constexpr auto cBatchSize      = CONFIG_AOS_LOG_BACKEND_FS_BATCH_SIZE;
+    static constexpr auto cThreadPriority = CONFIG_AOS_LOG_BACKEND_FS_THREAD_PRIORITY;
+    static constexpr auto cSyncTimeout    = 1000;
+    static constexpr auto cMaxIndexEvents = 8;
+
+    static constexpr auto cCompressTmpFileName = "compress.tmp";
 
     static FSBackend sLogBackend;
 
+    struct IndexEvent {
+        uint64_t mPos;
+        uint64_t mTimestamp;
+        bool     mClockJump;
+    };
+
     FSBackend() = default;
 
+    static void FlushThread(void* backend, void*, void*);
+
+    Error                      StartFlushThread();
+    Error                      PutRecord(const LogRecord& record);
+    void                       PutEntry(const uint8_t* data, size_t size, uint64_t timestamp);
+    size_t                     GetEntriesSize(const uint8_t* data, size_t size, size_t limit) const;
+    size_t                     GetBatch();
+    void                       ProcessBuffer();
+    void                       WriteBuffer();
+    bool                       IsSynced();
     Error                      ReopenLogFile();
-    Error                      WriteToFile();
+    Error                      WriteToFile(const uint8_t* data, size_t size);
+    Error                      WriteChunk(const uint8_t* data, size_t size);
+    size_t                     GetChunkSize(const uint8_t* data, size_t size) const;
+    bool                       IsFlushRequired();
+    Error                      Flush();
     Error                      RestoreLogFiles();
-    RetWithError<size_t>       GetFileNumber(const String& path);
-    StaticString<cFilePathLen> GetFileName(size_t fileNum);
-    size_t                     GetFileSize(const String& path);
+    Error                      RemoveDuplicatedLogFiles();
+    bool                       IsLogFileName(const String& name) const;
+    RetWithError<uint64_t>     GetFileNumber(const String& path) const;
+    StaticString<cFilePathLen> GetFileName(uint64_t fileNum) const;
     Error                      AllocateNewLogFile();
-    Error                      ShrinkLogFiles();
-    Error                      UpdateLogFileNumerals();
+    Error                      ShrinkLogFiles(bool hasActiveFile, bool checkSize);
+    bool                       CompressLogFiles();
+    Error                      ReplaceCompressedLogFile(const String& tmpPath);
+    void                       StopCompression();
+    void                       UpdateLogIndex(const uint8_t* data, size_t size, size_t offset, uint64_t streamPos);
+    bool                       TakeIndexEvent(uint64_t pos, IndexEvent& event);
+    RetWithError<uint64_t>     GetEntryTimestamp(const uint8_t* data, size_t size) const;
+    void                       RestoreLogIndex();
+    size_t                     GetEntryInstanceID(const uint8_t* data, size_t size, String& instanceID) const;
     size_t                     FillLogBuffer(const String& log);
+    void                       NotifyListener(const uint8_t* data, size_t size);
 
-    StaticString<cLogEntryLen>                            mLogBuffer;
-    int                                                   mFD                    = -1;
-    size_t                                                mFileSize              = 0;
-    size_t                                                mCurrentLogFileNumeral = 0;
-    StaticArray<StaticString<cFilePathLen>, cMaxLogFiles> mLogFiles;
+    StaticString<cLogEntryLen>                               mLogBuffer;
+    LogRecord                                                mLogRecord;
+    StaticArray<uint8_t, cMaxLogRecordLen>                   mLogRecordBuffer;
+    LogRecord                                                mInstanceLogRecord;
+    LogFileEntry                                             mLogFileEntry;
+    int                                                      mFD                = -1;
+    size_t                                                   mFileSize          = 0;
+    uint64_t                                                 mNextLogFileNumber = 0;
+    size_t                                                   mNextIndexOffset   = 0;
+    size_t                                                   mNumIndexEntries   = 0;
+    uint64_t                                                 mLastTimestamp     = 0;
+    uint64_t                                                 mJumpTimestamp     = 0;
+    StaticArray<uint32_t, cMaxNumInstances>                  mSegmentInstances;
+    StaticArray<IndexEvent, cMaxIndexEvents>                 mIndexEvents;
+    uint64_t                                                 mPutPos            = 0;
+    uint64_t                                                 mTakePos           = 0;
+    uint64_t                                                 mBatchPos          = 0;
+    size_t                                                   mUnflushedSize     = 0;
+    int64_t                                                  mLastFlushTime     = 0;
+    bool                                                     mFlushPending      = false;
+    bool                                                     mFlushRequested    = false;
+    bool                                                     mWriting           = false;
+    bool                                                     mThreadStarted     = false;
+    bool                                                     mCompressPending   = false;
+    StaticArray<StaticString<cFilePathLen>, cMaxNumLogFiles> mLogFiles;
+    LogListenerItf*                                          mListener = nullptr;
+    FSBackendStats                                           mStats {};
+    struct k_spinlock                                        mLock {};
+    struct k_sem                                             mWakeSem {};
+    struct k_thread                                          mThread {};
+    struct ring_buf                                          mRingBuffer {};
+    uint8_t                                                  mRingBufferData[cBufferSize] {};
+    uint8_t                                                  mBatchBuffer[cBatchSize] {};
+#if CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION
+    LogCompressor              mCompressor;
+    StaticString<cFilePathLen> mCompressPath;
+#endif
 };
 
 } // namespace aos::zephyr::logger::backend
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zephyr/kernel.h>
+
+#include <aos/common/tools/fs.hpp>
+
+#include "instancelog.hpp"
+#include "logrecord.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+// Instance logs are written from different threads, so the log entry buffers are shared and guarded by the mutex. The
+// mutex also serializes writes and periodic flushes of the instance log.
+K_MUTEX_DEFINE(sEntryMutex);
+
+LogRecord    sLogRecord;
+LogFileEntry sLogEntry;
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+StaticString<cFilePathLen> GetInstanceLogDir(const String& instanceID)
+{
+    return fs::JoinPath(cInstanceLogDir, instanceID);
+}
+
+Error RemoveInstanceLog(const String& instanceID)
+{
+    if (auto err = fs::RemoveAll(GetInstanceLogDir(instanceID)); !err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error InstanceLog::Open(const String& instanceID)
+{
+    Close();
+
+    if (auto err = mInstanceID.Assign(instanceID); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    if (auto err = fs::MakeDirAll(GetInstanceLogDir(mInstanceID)); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    RestoreLogFiles();
+
+    if (mNextLogFileNumber == mFirstFileNumber) {
+        return AllocateNewLogFile();
+    }
+
+    return ReopenLogFile();
+}
+
+Error InstanceLog::Write(const String& message)
+{
+    k_mutex_lock(&sEntryMutex, K_FOREVER);
+
+    auto err = WriteEntry(message);
+
+    k_mutex_unlock(&sEntryMutex);
+
+    return err;
+}
+
+// Written entries are made visible to log readers by reopening the log file.
+Error InstanceLog::Flush()
+{
+    k_mutex_lock(&sEntryMutex, K_FOREVER);
+
+    Error err;
+
+    if (mFD != -1 && mUnflushed) {
+        err = ReopenLogFile();
+    }
+
+    k_mutex_unlock(&sEntryMutex);
+
+    return err;
+}
+
+void InstanceLog::Close()
+{
+    if (mFD != -1) {
+        close(mFD);
+
+        mFD = -1;
+    }
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+// Log file numbers of the instance are contiguous, so only the first and the last numbers are kept.
+void InstanceLog::RestoreLogFiles()
+{
+    const auto prefixLen = strlen(cLogPrefix);
+    bool       found     = false;
+
+    mFirstFileNumber   = 0;
+    mNextLogFileNumber = 0;
+
+    fs::DirIterator dirIterator(GetInstanceLogDir(mInstanceID));
+
+    while (dirIterator.Next()) {
+        if (dirIterator->mIsDir || strncmp(dirIterator->mPath.CStr(), cLogPrefix, prefixLen) != 0) {
+            continue;
+        }
+
+        auto fileNum = static_cast<uint64_t>(strtoull(dirIterator->mPath.CStr() + prefixLen, nullptr, 10));
+
+        mFirstFileNumber   = found ? Min(mFirstFileNumber, fileNum) : fileNum;
+        mNextLogFileNumber = found ? Max(mNextLogFileNumber, fileNum + 1) : fileNum + 1;
+        found              = true;
+    }
+}
+
+// Rotation removes the oldest log files of the instance only, log files of other instances are not affected.
+Error InstanceLog::AllocateNewLogFile()
+{
+    Close();
+
+    for (; mNextLogFileNumber - mFirstFileNumber >= cInstanceLogFilesLimit; mFirstFileNumber++) {
+        if (auto err = fs::Remove(GetFileName(mFirstFileNumber)); !err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
+            return AOS_ERROR_WRAP(err);
+        }
+    }
+
+    mNextLogFileNumber++;
+
+    return ReopenLogFile();
+}
+
+Error InstanceLog::WriteEntry(const String& message)
+{
+    if (mFD == -1) {
+        return ErrorEnum::eWrongState;
+    }
+
+    if (mFileSize >= cInstanceLogFileSize) {
+        if (auto err = AllocateNewLogFile(); !err.IsNone()) {
+            return err;
+        }
+    }
+
+    MakeInstanceLogRecord(mInstanceID, message, sLogRecord);
+
+    if (auto err = MakeLogFileEntry(sLogRecord, sLogEntry); !err.IsNone()) {
+        return err;
+    }
+
+    auto nwrite = write(mFD, sLogEntry.Get(), sLogEntry.Size());
+    if (nwrite < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    mFileSize += nwrite;
+    mUnflushed = true;
+
+    return ErrorEnum::eNone;
+}
+
+Error InstanceLog::ReopenLogFile()
+{
+    Close();
+
+    mUnflushed = false;
+
+    mFD = open(GetFileName(mNextLogFileNumber - 1).CStr(), O_CREAT | O_RDWR | O_APPEND, S_IRUSR | S_IWUSR);
+    if (mFD < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    auto fileSize = lseek(mFD, 0, SEEK_END);
+    if (fileSize < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    mFileSize = fileSize;
+
+    return ErrorEnum::eNone;
+}
+
+StaticString<cFilePathLen> InstanceLog::GetFileName(uint64_t fileNum) const
+{
+    StaticString<cFilePathLen> path;
+
+    path.Format("%s/%s%0*" PRIu64, GetInstanceLogDir(mInstanceID).CStr(), cLogPrefix, cLogFileNumberLen, fileNum);
+
+    return path;
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef INSTANCELOG_HPP_
+#define INSTANCELOG_HPP_
+
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/string.hpp>
+#include <aos/common/types.hpp>
+
+#include "logger/types.hpp"
+
+namespace aos::zephyr::logger {
+
+/**
+ * Per-instance log directory.
+ */
+static constexpr auto cInstanceLogDir = CONFIG_AOS_LOG_INSTANCE_DIR;
+
+/**
+ * Per-instance log file size limit.
+ */
+static constexpr size_t cInstanceLogFileSize = CONFIG_AOS_LOG_INSTANCE_FILE_SIZE;
+
+/**
+ * Max per-instance log files.
+ */
+static constexpr uint64_t cInstanceLogFilesLimit = CONFIG_AOS_LOG_INSTANCE_FILES_LIMIT;
+
+/**
+ * Returns log directory of the instance.
+ *
+ * @param instanceID instance ID.
+ * @return StaticString<cFilePathLen>.
+ */
+StaticString<cFilePathLen> GetInstanceLogDir(const String& instanceID);
+
+/**
+ * Removes log files of the instance.
+ *
+ * @param instanceID instance ID.
+ * @return Error.
+ */
+Error RemoveInstanceLog(const String& instanceID);
+
+/**
+ * Per-instance log.
+ *
+ * Instance log files are stored in the instance log directory and have the same naming and entry format as the system
+ * log files, so they are read by the same log reader. Instance log files have their own size and number limits, so a
+ * noisy instance doesn't evict logs of other instances. Instance log files are neither compressed nor indexed.
+ *
+ * The object contains the file state only, so it may be copied. It is not closed on destruction and should be closed
+ * explicitly.
+ */
+class InstanceLog {
+public:
+    /**
+     * Opens instance log: continues the last log file of the instance or creates the new one.
+     *
+     * @param instanceID instance ID.
+     * @return Error.
+     */
+    Error Open(const String& instanceID);
+
+    /**
+     * Writes log message.
+     *
+     * @param message log message.
+     * @return Error.
+     */
+    Error Write(const String& message);
+
+    /**
+     * Makes written log messages visible to log readers. Should be called periodically while the log is open.
+     *
+     * @return Error.
+     */
+    Error Flush();
+
+    /**
+     * Closes instance log.
+     */
+    void Close();
+
+private:
+    void                       RestoreLogFiles();
+    Error                      WriteEntry(const String& message);
+    Error                      AllocateNewLogFile();
+    Error                      ReopenLogFile();
+    StaticString<cFilePathLen> GetFileName(uint64_t fileNum) const;
+
+    StaticString<cInstanceIDLen> mInstanceID;
+    int                          mFD                = -1;
+    size_t                       mFileSize          = 0;
+    uint64_t                     mFirstFileNumber   = 0;
+    uint64_t                     mNextLogFileNumber = 0;
+    bool                         mUnflushed         = false;
+};
+
+} // namespace aos::zephyr::logger
+
+#endif
@@ -5,23 +5,26 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
+
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/spinlock.h>
 #include <zephyr/sys/printk.h>
 
 #if CONFIG_NATIVE_APPLICATION
 #include <aos/common/tools/thread.hpp>
 #endif
 
+#include "flightrecorder.hpp"
+#include "fsbackend.hpp"
 #include "logger.hpp"
+#include "logrecord.hpp"
+#include "ratelimiter.hpp"
 
 namespace aos::zephyr::logger {
 
-/***********************************************************************************************************************
- * Static
- **********************************************************************************************************************/
-
-StaticMap<String, void (*)(LogLevel, const String&), Logger::cMaxLogModules> Logger::sLogCallbacks;
-
 /***********************************************************************************************************************
  * Log module callbacks
  **********************************************************************************************************************/
@@ -60,32 +63,227 @@ StaticMap<String, void (*)(LogLevel, const String&), Logger::cMaxLogModules> Log
                 break;                                                                                                 \
             }                                                                                                          \
         }                                                                                                              \
+                                                                                                                       \
+        static bool IsDebugLogged()                                                                                    \
+        {                                                                                                              \
+            return CONFIG_AOS_CORE_LOG_LEVEL >= LOG_LEVEL_DBG                                                          \
+                && backend::FSBackend::Get().IsLogged(LOG_CURRENT_MODULE_ID(), LOG_LEVEL_DBG);                         \
+        }                                                                                                              \
+    }
+
+#define LOG_MODULES(X)                                                                                                 \
+    /* internal logs */                                                                                                \
+    X(app)                                                                                                             \
+    X(clocksync)                                                                                                       \
+    X(communication)                                                                                                   \
+    X(downloader)                                                                                                      \
+    X(iamclient)                                                                                                       \
+    X(nodeinfoprovider)                                                                                                \
+    X(ocispec)                                                                                                         \
+    X(provisionmanager)                                                                                                \
+    X(resourcemanager)                                                                                                 \
+    X(runner)                                                                                                          \
+    X(smclient)                                                                                                        \
+    X(storage)                                                                                                         \
+    X(image)                                                                                                           \
+    X(logprovider)                                                                                                     \
+    /* Aos lib logs */                                                                                                 \
+    X(certhandler)                                                                                                     \
+    X(crypto)                                                                                                          \
+    X(launcher)                                                                                                        \
+    X(monitoring)                                                                                                      \
+    X(pkcs11)                                                                                                          \
+    X(servicemanager)                                                                                                  \
+    X(layermanager)
+
+LOG_MODULES(LOG_CALLBACK)
+
+/***********************************************************************************************************************
+ * Module table
+ **********************************************************************************************************************/
+
+namespace {
+
+using DebugLoggedCallback = bool (*)();
+
+struct LogModule {
+    const char*               mName;
+    Logger::ModuleLogCallback mCallback;
+    DebugLoggedCallback       mIsDebugLogged;
+};
+
+constexpr LogModule cLogModules[] = {
+#define LOG_MODULE_ENTRY(name) {#name, &log_##name::LogCallback, &log_##name::IsDebugLogged},
+    LOG_MODULES(LOG_MODULE_ENTRY)
+#undef LOG_MODULE_ENTRY
+};
+
+constexpr size_t cNumLogModules       = ARRAY_SIZE(cLogModules);
+constexpr size_t cModuleHashTableSize = 64;
+
+static_assert(cModuleHashTableSize >= 2 * cNumLogModules, "module hash table is too small");
+static_assert((cModuleHashTableSize & (cModuleHashTableSize - 1)) == 0, "module hash table size should be power of 2");
+
+// Module hash table: open addressing with linear probing, contains module table index + 1, 0 marks empty slot.
+struct ModuleHashTable {
+    uint8_t mSlots[cModuleHashTableSize];
+};
+
+constexpr uint32_t HashModuleName(const char* name, size_t size)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619U;
+    }
+
+    return hash;
+}
+
+constexpr size_t GetModuleNameSize(const char* name)
+{
+    size_t size = 0;
+
+    while (name[size] != '\0') {
+        size++;
+    }
+
+    return size;
+}
+
+constexpr ModuleHashTable CreateModuleHashTable()
+{
+    ModuleHashTable table {};
+
+    for (size_t i = 0; i < cNumLogModules; i++) {
+        auto slot = HashModuleName(cLogModules[i].mName, GetModuleNameSize(cLogModules[i].mName))
+            & (cModuleHashTableSize - 1);
+
+        while (table.mSlots[slot] != 0) {
+            slot = (slot + 1) & (cModuleHashTableSize - 1);
+        }
+
+        table.mSlots[slot] = static_cast<uint8_t>(i + 1);
+    }
+
+    return table;
+}
+
+constexpr ModuleHashTable cModuleHashTable = CreateModuleHashTable();
+
+// Module name is hashed and looked up in the hash table generated at compile time, so only one name is compared.
+const LogModule* FindLogModule(const String& module)
+{
+    constexpr auto cMask = cModuleHashTableSize - 1;
+
+    for (auto slot = HashModuleName(module.CStr(), module.Size()) & cMask; cModuleHashTable.mSlots[slot] != 0;
+         slot = (slot + 1) & cMask) {
+        const auto& logModule = cLogModules[cModuleHashTable.mSlots[slot] - 1];
+
+        if (strncmp(logModule.mName, module.CStr(), module.Size()) == 0 && logModule.mName[module.Size()] == '\0') {
+            return &logModule;
+        }
+    }
+
+    return nullptr;
+}
+
+/***********************************************************************************************************************
+ * Rate limiting
+ **********************************************************************************************************************/
+
+constexpr size_t    cNumLogLevels        = 4;
+constexpr RateLimit cDefaultRateLimit    = {CONFIG_AOS_LOG_RATE_LIMIT, CONFIG_AOS_LOG_RATE_LIMIT_BURST};
+constexpr auto      cSuppressedMsgSize   = 64;
+constexpr auto      cSuppressedMsgPeriod = 1000;
+
+void ReportSuppressedMessages(struct k_work* work);
+
+k_spinlock  sRateLimitLock;
+RateLimit   sRateLimits[cNumLogModules];
+RateLimiter sRateLimiters[cNumLogModules][cNumLogLevels];
+
+K_WORK_DELAYABLE_DEFINE(sSuppressedMsgWork, ReportSuppressedMessages);
+
+void LogSuppressedMessages(size_t moduleIndex, LogLevel level, uint32_t suppressed)
+{
+    StaticString<cSuppressedMsgSize> suppressedMsg;
+
+    suppressedMsg.Format("Suppressed %u messages", static_cast<unsigned>(suppressed));
+
+    cLogModules[moduleIndex].mCallback(level, suppressedMsg);
+}
+
+// Suppressed messages are reported before the next allowed message of the module level. If there is no allowed message
+// for the report period, they are reported by this work item, so a storm followed by silence isn't lost without trace.
+void ReportSuppressedMessages(struct k_work* work)
+{
+    (void)work;
+
+    for (size_t moduleIndex = 0; moduleIndex < cNumLogModules; moduleIndex++) {
+        for (size_t levelIndex = 0; levelIndex < cNumLogLevels; levelIndex++) {
+            auto key = k_spin_lock(&sRateLimitLock);
+
+            auto suppressed = sRateLimiters[moduleIndex][levelIndex].TakeSuppressed();
+
+            k_spin_unlock(&sRateLimitLock, key);
+
+            if (suppressed != 0) {
+                LogSuppressedMessages(moduleIndex, static_cast<LogLevelEnum>(levelIndex), suppressed);
+            }
+        }
+    }
+}
+
+// Rate limiters are kept per module and level, so a storm of debug messages doesn't suppress errors of the module.
+// Errors are never limited: they are rare in normal operation and the most needed ones when something goes wrong.
+bool AllowLogMessage(size_t moduleIndex, LogLevel level, uint32_t& suppressed)
+{
+    auto levelIndex = static_cast<size_t>(level.GetValue());
+
+    suppressed = 0;
+
+    if (level.GetValue() == LogLevelEnum::eError || levelIndex >= cNumLogLevels) {
+        return true;
+    }
+
+    auto key = k_spin_lock(&sRateLimitLock);
+
+    auto allow = sRateLimiters[moduleIndex][levelIndex].Allow(sRateLimits[moduleIndex], k_uptime_get(), suppressed);
+
+    k_spin_unlock(&sRateLimitLock, key);
+
+    if (!allow) {
+        k_work_schedule(&sSuppressedMsgWork, K_MSEC(cSuppressedMsgPeriod));
+    }
+
+    return allow;
+}
+
+/***********************************************************************************************************************
+ * Flight recorder
+ **********************************************************************************************************************/
+
+// Debug messages are recorded in RAM only and dumped to the log when error is logged. Debug messages which are already
+// written to the log at the runtime log level are not recorded, so they are not written twice.
+void RecordLogMessage(size_t moduleIndex, LogLevel level, const String& message)
+{
+    if (!IS_ENABLED(CONFIG_AOS_LOG_FLIGHT_RECORDER)) {
+        return;
     }
 
-// internal logs
-LOG_CALLBACK(app);
-LOG_CALLBACK(clocksync);
-LOG_CALLBACK(communication);
-LOG_CALLBACK(downloader);
-LOG_CALLBACK(iamclient);
-LOG_CALLBACK(nodeinfoprovider);
-LOG_CALLBACK(ocispec);
-LOG_CALLBACK(provisionmanager);
-LOG_CALLBACK(resourcemanager);
-LOG_CALLBACK(runner);
-LOG_CALLBACK(smclient);
-LOG_CALLBACK(storage);
-LOG_CALLBACK(image);
-LOG_CALLBACK(logprovider);
-
-// Aos lib logs
-LOG_CALLBACK(certhandler);
-LOG_CALLBACK(crypto);
-LOG_CALLBACK(launcher);
-LOG_CALLBACK(monitoring);
-LOG_CALLBACK(pkcs11);
-LOG_CALLBACK(servicemanager);
-LOG_CALLBACK(layermanager);
+    if (level.GetValue() == LogLevelEnum::eDebug) {
+        if (cLogModules[moduleIndex].mIsDebugLogged()) {
+            return;
+        }
+
+        FlightRecorder::Get().Put(cLogModules[moduleIndex].mName, message);
+    } else if (level.GetValue() == LogLevelEnum::eError) {
+        FlightRecorder::Get().Dump();
+    }
+}
+
+} // namespace
 
 /***********************************************************************************************************************
  * Public
@@ -93,33 +291,15 @@ LOG_CALLBACK(layermanager);
 
 Error Logger::Init()
 {
-    Log::SetCallback(LogCallback);
+    for (size_t i = 0; i < cNumLogModules; i++) {
+        sRateLimits[i] = cDefaultRateLimit;
+    }
 
-    sLogCallbacks.Set("app", &log_app::LogCallback);
-    sLogCallbacks.Set("certhandler", &log_certhandler::LogCallback);
-    sLogCallbacks.Set("clocksync", &log_clocksync::LogCallback);
-    sLogCallbacks.Set("communication", &log_communication::LogCallback);
-    sLogCallbacks.Set("crypto", &log_crypto::LogCallback);
-    sLogCallbacks.Set("downloader", &log_downloader::LogCallback);
-    sLogCallbacks.Set("iamclient", &log_iamclient::LogCallback);
-    sLogCallbacks.Set("launcher", &log_launcher::LogCallback);
-    sLogCallbacks.Set("monitoring", &log_monitoring::LogCallback);
-    sLogCallbacks.Set("nodeinfoprovider", &log_nodeinfoprovider::LogCallback);
-    sLogCallbacks.Set("ocispec", &log_ocispec::LogCallback);
-    sLogCallbacks.Set("pkcs11", &log_pkcs11::LogCallback);
-    sLogCallbacks.Set("provisionmanager", &log_provisionmanager::LogCallback);
-    sLogCallbacks.Set("resourcemanager", &log_resourcemanager::LogCallback);
-    sLogCallbacks.Set("runner", &log_runner::LogCallback);
-    sLogCallbacks.Set("servicemanager", &log_servicemanager::LogCallback);
-    sLogCallbacks.Set("layermanager", &log_layermanager::LogCallback);
-    sLogCallbacks.Set("smclient", &log_smclient::LogCallback);
-    sLogCallbacks.Set("storage", &log_storage::LogCallback);
-    sLogCallbacks.Set("image", &log_image::LogCallback);
-    sLogCallbacks.Set("logprovider", &log_logprovider::LogCallback);
+    Log::SetCallback(LogCallback);
 
 #if CONFIG_LOG_RUNTIME_FILTERING
-    for (auto& [module, _] : sLogCallbacks) {
-        if (auto err = SetLogLevel(module, cRuntimeLogLevel); !err.IsNone()) {
+    for (const auto& module : cLogModules) {
+        if (auto err = SetLogLevel(module.mName, cRuntimeLogLevel); !err.IsNone()) {
             return err;
         }
     }
@@ -128,6 +308,32 @@ Error Logger::Init()
     return ErrorEnum::eNone;
 }
 
+Logger::ModuleLogCallback Logger::FindLogCallback(const String& module)
+{
+    auto logModule = FindLogModule(module);
+    if (logModule == nullptr) {
+        return nullptr;
+    }
+
+    return logModule->mCallback;
+}
+
+Error Logger::SetRateLimit(const String& module, uint32_t rate, uint32_t burst)
+{
+    auto logModule = FindLogModule(module);
+    if (logModule == nullptr) {
+        return AOS_ERROR_WRAP(ErrorEnum::eNotFound);
+    }
+
+    auto key = k_spin_lock(&sRateLimitLock);
+
+    sRateLimits[logModule - cLogModules] = {rate, burst};
+
+    k_spin_unlock(&sRateLimitLock, key);
+
+    return ErrorEnum::eNone;
+}
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
@@ -140,14 +346,26 @@ void Logger::LogCallback(const String& module, LogLevel level, const String& mes
     LockGuard lock(sMutex);
 #endif
 
-    auto callbackIt = sLogCallbacks.Find(module);
-    if (callbackIt == sLogCallbacks.end()) {
+    auto logModule = FindLogModule(module);
+    if (logModule == nullptr) {
         printk("[app] Log from unknown module received: module=%s, level=%s, message=%s", module.CStr(),
             level.ToString().CStr(), message.CStr());
         return;
     }
 
-    callbackIt->mSecond(level, message);
+    uint32_t suppressed = 0;
+
+    if (!AllowLogMessage(logModule - cLogModules, level, suppressed)) {
+        return;
+    }
+
+    RecordLogMessage(logModule - cLogModules, level, message);
+
+    if (suppressed != 0) {
+        LogSuppressedMessages(logModule - cLogModules, level, suppressed);
+    }
+
+    logModule->mCallback(level, message);
 }
 
 #if CONFIG_LOG_RUNTIME_FILTERING
@@ -13,7 +13,6 @@
 #endif
 
 #include <aos/common/tools/log.hpp>
-#include <aos/common/tools/map.hpp>
 
 namespace aos::zephyr::logger {
 
@@ -22,6 +21,11 @@ namespace aos::zephyr::logger {
  */
 class Logger {
 public:
+    /**
+     * Log module callback.
+     */
+    using ModuleLogCallback = void (*)(LogLevel level, const String& message);
+
     /**
      * Inits logging system.
      *
@@ -29,8 +33,28 @@ public:
      */
     static Error Init();
 
+    /**
+     * Returns log callback of the module.
+     *
+     * @param module module name.
+     * @return ModuleLogCallback callback or nullptr if module is unknown.
+     */
+    static ModuleLogCallback FindLogCallback(const String& module);
+
+    /**
+     * Sets log rate limit of the module.
+     *
+     * Messages of each module level exceeding the limit are dropped and reported by "Suppressed N messages" summary
+     * before the next passed message of this level or, if there is none, within a second. Errors are not limited.
+     *
+     * @param module module name.
+     * @param rate max number of messages per second, 0 disables limiting.
+     * @param burst max number of messages passed at once.
+     * @return Error.
+     */
+    static Error SetRateLimit(const String& module, uint32_t rate, uint32_t burst);
+
 private:
-    static constexpr auto cMaxLogModules = 32;
 #if CONFIG_LOG_RUNTIME_FILTERING
     static constexpr auto cRuntimeLogLevel = CONFIG_AOS_CORE_RUNTIME_LOG_LEVEL;
 #endif
@@ -39,8 +63,6 @@ private:
 #if CONFIG_LOG_RUNTIME_FILTERING
     static Error SetLogLevel(const String& module, int level);
 #endif
-
-    static StaticMap<String, void (*)(LogLevel, const String&), cMaxLogModules> sLogCallbacks;
 };
 
 } // namespace aos::zephyr::logger
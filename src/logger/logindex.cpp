@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <aos/common/tools/fs.hpp>
+
+#include "compression.hpp"
+#include "logindex.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr auto cInstanceIndexSuffix = ".inst";
+constexpr auto cReadChunkSize       = 16;
+
+StaticString<cFilePathLen> GetInstanceIndexPath(const String& logPath)
+{
+    auto path = GetLogIndexPath(logPath);
+
+    path.Append(cInstanceIndexSuffix);
+
+    return path;
+}
+
+RetWithError<LogIndexEntry> ReadLogIndexEntry(const String& logPath, off_t offset, int whence)
+{
+    LogIndexEntry entry {};
+
+    int fd = open(GetLogIndexPath(logPath).CStr(), O_RDONLY);
+    if (fd < 0) {
+        return {entry, ErrorEnum::eNotFound};
+    }
+
+    Error err = ErrorEnum::eNone;
+
+    if (lseek(fd, offset, whence) < 0) {
+        err = ErrorEnum::eNotFound;
+    } else if (auto nread = read(fd, &entry, sizeof(entry)); nread != sizeof(entry)) {
+        err = nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eNotFound;
+    }
+
+    close(fd);
+
+    return {entry, err};
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+// FNV-1a hash.
+uint32_t GetInstanceKey(const String& instanceID)
+{
+    uint32_t key = 2166136261U;
+
+    for (auto ch : instanceID) {
+        key = (key ^ static_cast<uint8_t>(ch)) * 16777619U;
+    }
+
+    return key;
+}
+
+StaticString<cFilePathLen> GetLogIndexPath(const String& logPath)
+{
+    StaticString<cFilePathLen> fileName;
+
+    auto nameStart = strrchr(logPath.CStr(), '/');
+
+    nameStart = nameStart != nullptr ? nameStart + 1 : logPath.CStr();
+
+    auto nameSize = static_cast<size_t>(logPath.CStr() + logPath.Size() - nameStart);
+
+    // Compression doesn't change log entry offsets, so compressed log file uses the index of the original one.
+    if (IsCompressedLogFile(logPath)) {
+        nameSize -= strlen(cCompressedLogSuffix);
+    }
+
+    fileName.Assign(String(nameStart, nameSize));
+
+    return fs::JoinPath(cLogIndexDir, fileName);
+}
+
+Error AppendLogIndexEntry(const String& logPath, const LogIndexEntry& entry)
+{
+    int fd = open(GetLogIndexPath(logPath).CStr(), O_CREAT | O_WRONLY | O_APPEND, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    Error err = ErrorEnum::eNone;
+
+    if (auto nwrite = write(fd, &entry, sizeof(entry)); nwrite != sizeof(entry)) {
+        err = nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+    }
+
+    if (auto ret = close(fd); ret < 0 && err.IsNone()) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    return err;
+}
+
+Error ReadLogIndex(const String& logPath, LogIndex& index)
+{
+    index.Clear();
+
+    int fd = open(GetLogIndexPath(logPath).CStr(), O_RDONLY);
+    if (fd < 0) {
+        return ErrorEnum::eNotFound;
+    }
+
+    Error err = ErrorEnum::eNone;
+
+    while (!index.IsFull()) {
+        LogIndexEntry entry;
+
+        auto nread = read(fd, &entry, sizeof(entry));
+        if (nread != sizeof(entry)) {
+            if (nread < 0) {
+                err = AOS_ERROR_WRAP(errno);
+            }
+
+            break;
+        }
+
+        index.PushBack(entry);
+    }
+
+    close(fd);
+
+    return err;
+}
+
+RetWithError<LogIndexEntry> GetFirstLogIndexEntry(const String& logPath)
+{
+    return ReadLogIndexEntry(logPath, 0, SEEK_SET);
+}
+
+RetWithError<LogIndexEntry> GetLastLogIndexEntry(const String& logPath)
+{
+    return ReadLogIndexEntry(logPath, -static_cast<off_t>(sizeof(LogIndexEntry)), SEEK_END);
+}
+
+RetWithError<size_t> GetLogIndexSize(const String& logPath)
+{
+    struct stat st;
+
+    if (auto ret = stat(GetLogIndexPath(logPath).CStr(), &st); ret < 0) {
+        return {0, AOS_ERROR_WRAP(errno)};
+    }
+
+    return static_cast<size_t>(st.st_size) / sizeof(LogIndexEntry);
+}
+
+Error AppendInstanceIndexEntries(const String& logPath, const Array<InstanceIndexEntry>& entries)
+{
+    if (entries.IsEmpty()) {
+        return ErrorEnum::eNone;
+    }
+
+    int fd = open(GetInstanceIndexPath(logPath).CStr(), O_CREAT | O_WRONLY | O_APPEND, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    Error err  = ErrorEnum::eNone;
+    auto  size = entries.Size() * sizeof(InstanceIndexEntry);
+
+    if (auto nwrite = write(fd, entries.Get(), size); nwrite != static_cast<ssize_t>(size)) {
+        err = nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+    }
+
+    if (auto ret = close(fd); ret < 0 && err.IsNone()) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    return err;
+}
+
+Error ReadInstanceIndex(const String& logPath, uint32_t instanceKey, LogIndexSegments& segments)
+{
+    segments.Clear();
+
+    int fd = open(GetInstanceIndexPath(logPath).CStr(), O_RDONLY);
+    if (fd < 0) {
+        return ErrorEnum::eNotFound;
+    }
+
+    Error              err = ErrorEnum::eNone;
+    InstanceIndexEntry entries[cReadChunkSize];
+
+    while (true) {
+        auto nread = read(fd, entries, sizeof(entries));
+        if (nread <= 0) {
+            if (nread < 0) {
+                err = AOS_ERROR_WRAP(errno);
+            }
+
+            break;
+        }
+
+        for (size_t i = 0; i < static_cast<size_t>(nread) / sizeof(InstanceIndexEntry); i++) {
+            if (entries[i].mInstanceKey == instanceKey) {
+                segments.Set(entries[i].mSegment);
+            }
+        }
+    }
+
+    close(fd);
+
+    return err;
+}
+
+Error RemoveLogIndex(const String& logPath)
+{
+    auto err = fs::Remove(GetLogIndexPath(logPath));
+
+    if (auto removeErr = fs::Remove(GetInstanceIndexPath(logPath)); err.IsNone()) {
+        err = removeErr;
+    }
+
+    return err;
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOGINDEX_HPP_
+#define LOGINDEX_HPP_
+
+#include <string.h>
+
+#include <aos/common/tools/array.hpp>
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/string.hpp>
+#include <aos/common/types.hpp>
+
+#include "logger/types.hpp"
+
+namespace aos::zephyr::logger {
+
+/**
+ * Log index directory.
+ */
+static constexpr auto cLogIndexDir = CONFIG_AOS_LOG_BACKEND_FS_DIR "/index";
+
+/**
+ * Min distance between log file offsets of log index entries.
+ */
+static constexpr auto cLogIndexInterval = CONFIG_AOS_LOG_BACKEND_FS_INDEX_INTERVAL;
+
+/**
+ * Max number of log index entries per log file.
+ */
+static constexpr size_t cMaxLogIndexEntries = cFileSizeLimit / cLogIndexInterval + 1;
+
+/**
+ * Log index entry.
+ *
+ * Log index is a sparse time index of a log file: every cLogIndexInterval bytes it contains offset of the log entry in
+ * the uncompressed log file and timestamp of this entry. Log index of each log file is stored in a separate file in
+ * cLogIndexDir. Log entries of a log index segment are ordered by time. If the wall clock goes backwards, a new segment
+ * is started and its index entry is marked with cClockJumpFlag.
+ */
+struct LogIndexEntry {
+    /**
+     * Log index entry starts a segment earlier than the previous log entry.
+     */
+    static constexpr uint64_t cClockJumpFlag = 1;
+
+    uint64_t mOffset;
+    uint64_t mTimestamp;
+    uint64_t mFlags;
+
+    /**
+     * Returns entry time.
+     *
+     * @return Time.
+     */
+    Time GetTime() const { return FromLogTimestamp(mTimestamp); }
+
+    /**
+     * Checks if log entries before the index entry may be later than it.
+     *
+     * @return bool.
+     */
+    bool IsClockJump() const { return (mFlags & cClockJumpFlag) != 0; }
+};
+
+/**
+ * Log index.
+ */
+using LogIndex = StaticArray<LogIndexEntry, cMaxLogIndexEntries>;
+
+/**
+ * Instance index entry.
+ *
+ * Instance index is a posting list of a log file: it contains an entry for each log index segment (log file part
+ * between two subsequent log index entries) where log entries of the instance appear. Instances are identified by
+ * compact instance keys, see GetInstanceKey. Key collisions make the reader read more segments, but don't lose logs.
+ */
+struct InstanceIndexEntry {
+    uint32_t mInstanceKey;
+    uint32_t mSegment;
+};
+
+/**
+ * Log index segments bitmap.
+ */
+class LogIndexSegments {
+public:
+    /**
+     * Clears all segments.
+     */
+    void Clear() { memset(mBitmap, 0, sizeof(mBitmap)); }
+
+    /**
+     * Sets segment. Segments beyond the max log index size belong to the last log index segment.
+     *
+     * @param segment segment number.
+     */
+    void Set(size_t segment)
+    {
+        segment = Min(segment, cMaxLogIndexEntries - 1);
+
+        mBitmap[segment / 8] |= 1 << (segment % 8);
+    }
+
+    /**
+     * Checks if segment is set.
+     *
+     * @param segment segment number.
+     * @return bool.
+     */
+    bool IsSet(size_t segment) const
+    {
+        segment = Min(segment, cMaxLogIndexEntries - 1);
+
+        return (mBitmap[segment / 8] & (1 << (segment % 8))) != 0;
+    }
+
+private:
+    uint8_t mBitmap[(cMaxLogIndexEntries + 7) / 8] {};
+};
+
+/**
+ * Returns compact instance key.
+ *
+ * @param instanceID instance ID.
+ * @return uint32_t.
+ */
+uint32_t GetInstanceKey(const String& instanceID);
+
+/**
+ * Returns log index path of log file.
+ *
+ * @param logPath log file path.
+ * @return StaticString<cFilePathLen>.
+ */
+StaticString<cFilePathLen> GetLogIndexPath(const String& logPath);
+
+/**
+ * Appends entry to log index of log file.
+ *
+ * @param logPath log file path.
+ * @param entry log index entry.
+ * @return Error.
+ */
+Error AppendLogIndexEntry(const String& logPath, const LogIndexEntry& entry);
+
+/**
+ * Reads log index of log file.
+ *
+ * @param logPath log file path.
+ * @param[out] index log index.
+ * @return Error.
+ */
+Error ReadLogIndex(const String& logPath, LogIndex& index);
+
+/**
+ * Returns first entry of log index of log file.
+ *
+ * @param logPath log file path.
+ * @return RetWithError<LogIndexEntry> eNotFound if log index is empty.
+ */
+RetWithError<LogIndexEntry> GetFirstLogIndexEntry(const String& logPath);
+
+/**
+ * Returns last entry of log index of log file.
+ *
+ * @param logPath log file path.
+ * @return RetWithError<LogIndexEntry> eNotFound if log index is empty.
+ */
+RetWithError<LogIndexEntry> GetLastLogIndexEntry(const String& logPath);
+
+/**
+ * Returns number of log index entries of log file.
+ *
+ * @param logPath log file path.
+ * @return RetWithError<size_t>.
+ */
+RetWithError<size_t> GetLogIndexSize(const String& logPath);
+
+/**
+ * Appends entries to instance index of log file.
+ *
+ * @param logPath log file path.
+ * @param entries instance index entries.
+ * @return Error.
+ */
+Error AppendInstanceIndexEntries(const String& logPath, const Array<InstanceIndexEntry>& entries);
+
+/**
+ * Reads log index segments of log file where log entries of the instance appear.
+ *
+ * @param logPath log file path.
+ * @param instanceKey instance key.
+ * @param[out] segments log index segments.
+ * @return Error.
+ */
+Error ReadInstanceIndex(const String& logPath, uint32_t instanceKey, LogIndexSegments& segments);
+
+/**
+ * Removes log index and instance index of log file.
+ *
+ * @param logPath log file path.
+ * @return Error.
+ */
+Error RemoveLogIndex(const String& logPath);
+
+} // namespace aos::zephyr::logger
+
+#endif
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log_ctrl.h>
+
+#include "logrecord.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr auto cMaxVarintLen = 10;
+
+const char* const cLevelNames[] = {"", "err", "wrn", "inf", "dbg"};
+
+Error PutVarint(uint64_t value, Array<uint8_t>& data)
+{
+    do {
+        uint8_t byte = value & 0x7F;
+
+        value >>= 7;
+
+        if (value != 0) {
+            byte |= 0x80;
+        }
+
+        if (auto err = data.PushBack(byte); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+    } while (value != 0);
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<uint64_t> GetVarint(const uint8_t* data, size_t size, size_t& pos)
+{
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < cMaxVarintLen; i++) {
+        if (pos >= size) {
+            return {0, ErrorEnum::eNotFound};
+        }
+
+        auto byte = data[pos++];
+
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    return {0, ErrorEnum::eInvalidArgument};
+}
+
+Error PutString(const String& str, Array<uint8_t>& data)
+{
+    if (auto err = PutVarint(str.Size(), data); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = data.Insert(data.end(), reinterpret_cast<const uint8_t*>(str.CStr()),
+            reinterpret_cast<const uint8_t*>(str.CStr()) + str.Size());
+        !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<size_t> GetStringSize(const uint8_t* data, size_t size, size_t& pos, size_t maxSize)
+{
+    auto [value, err] = GetVarint(data, size, pos);
+    if (!err.IsNone() || value > maxSize || value > size - pos) {
+        return {0, ErrorEnum::eInvalidArgument};
+    }
+
+    return static_cast<size_t>(value);
+}
+
+Error GetString(const uint8_t* data, size_t size, size_t& pos, String& str)
+{
+    auto [strSize, err] = GetStringSize(data, size, pos, str.MaxSize());
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    str.Assign(String(reinterpret_cast<const char*>(data + pos), strSize));
+    pos += strSize;
+
+    return ErrorEnum::eNone;
+}
+
+Error SkipString(const uint8_t* data, size_t size, size_t& pos)
+{
+    auto [strSize, err] = GetStringSize(data, size, pos, size);
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    pos += strSize;
+
+    return ErrorEnum::eNone;
+}
+
+size_t GetVarintLen(uint64_t value)
+{
+    size_t len = 1;
+
+    while (value >>= 7) {
+        len++;
+    }
+
+    return len;
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+Error EncodeLogRecord(const LogRecord& record, Array<uint8_t>& data)
+{
+    size_t payloadSize = GetVarintLen(record.mTimestamp) + 1 + GetVarintLen(record.mModule.Size())
+        + record.mModule.Size() + GetVarintLen(record.mInstanceID.Size()) + record.mInstanceID.Size()
+        + record.mMessage.Size();
+
+    data.Clear();
+
+    if (auto err = PutVarint(payloadSize, data); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = PutVarint(record.mTimestamp, data); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = data.PushBack(record.mLevel); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    if (auto err = PutString(record.mModule, data); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = PutString(record.mInstanceID, data); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = data.Insert(data.end(), reinterpret_cast<const uint8_t*>(record.mMessage.CStr()),
+            reinterpret_cast<const uint8_t*>(record.mMessage.CStr()) + record.mMessage.Size());
+        !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<size_t> DecodeLogRecord(const uint8_t* data, size_t size, LogRecord& record)
+{
+    auto [recordSize, err] = GetLogRecordSize(data, size);
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
+    size_t pos = 0;
+
+    // Skip payload size, it is already checked by GetLogRecordSize.
+    GetVarint(data, recordSize, pos);
+
+    if (Tie(record.mTimestamp, err) = GetVarint(data, recordSize, pos); !err.IsNone()) {
+        return {0, ErrorEnum::eInvalidArgument};
+    }
+
+    if (pos >= recordSize) {
+        return {0, ErrorEnum::eInvalidArgument};
+    }
+
+    record.mLevel = data[pos++];
+
+    if (err = GetString(data, recordSize, pos, record.mModule); !err.IsNone()) {
+        return {0, err};
+    }
+
+    if (err = GetString(data, recordSize, pos, record.mInstanceID); !err.IsNone()) {
+        return {0, err};
+    }
+
+    auto messageSize = Min(recordSize - pos, record.mMessage.MaxSize());
+
+    record.mMessage.Assign(String(reinterpret_cast<const char*>(data + pos), messageSize));
+
+    return recordSize;
+}
+
+RetWithError<size_t> GetLogRecordSize(const uint8_t* data, size_t size)
+{
+    size_t pos = 0;
+
+    auto [payloadSize, err] = GetVarint(data, size, pos);
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
+    if (payloadSize > cMaxLogRecordLen) {
+        return {0, ErrorEnum::eInvalidArgument};
+    }
+
+    if (pos + payloadSize > size) {
+        return {0, ErrorEnum::eNotFound};
+    }
+
+    return pos + payloadSize;
+}
+
+RetWithError<uint64_t> GetLogRecordTimestamp(const uint8_t* data, size_t size)
+{
+    auto [recordSize, err] = GetLogRecordSize(data, size);
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
+    size_t pos = 0;
+
+    // Skip payload size, it is already checked by GetLogRecordSize.
+    GetVarint(data, recordSize, pos);
+
+    return GetVarint(data, recordSize, pos);
+}
+
+Error GetLogRecordInstanceID(const uint8_t* data, size_t size, String& instanceID)
+{
+    auto [recordSize, err] = GetLogRecordSize(data, size);
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    size_t pos = 0;
+
+    // Skip payload size, timestamp, level and module name.
+    GetVarint(data, recordSize, pos);
+
+    if (err = GetVarint(data, recordSize, pos).mError; !err.IsNone() || ++pos > recordSize) {
+        return ErrorEnum::eInvalidArgument;
+    }
+
+    if (err = SkipString(data, recordSize, pos); !err.IsNone()) {
+        return err;
+    }
+
+    return GetString(data, recordSize, pos, instanceID);
+}
+
+Error FormatLogRecord(const LogRecord& record, String& text)
+{
+    auto [timeStr, err] = record.GetTime().ToUTCString();
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    auto level  = record.mLevel < ARRAY_SIZE(cLevelNames) ? cLevelNames[record.mLevel] : "";
+    auto module = record.mModule.IsEmpty() ? "unknown" : record.mModule.CStr();
+
+    if (record.mInstanceID.IsEmpty()) {
+        text.Format("%s <%s> %s: %s", timeStr.CStr(), level, module, record.mMessage.CStr());
+    } else {
+        text.Format(
+            "%s <%s> %s: [%s]%s", timeStr.CStr(), level, module, record.mInstanceID.CStr(), record.mMessage.CStr());
+    }
+
+    return ErrorEnum::eNone;
+}
+
+void MakeInstanceLogRecord(const String& instanceID, const String& message, LogRecord& record)
+{
+    record.SetTime(Time::Now());
+
+    record.mLevel  = LOG_LEVEL_INF;
+    record.mModule = cInstanceLogModule;
+
+    record.mInstanceID.Assign(instanceID);
+    record.mMessage.Assign(String(message.CStr(), Min(message.Size(), record.mMessage.MaxSize())));
+}
+
+Error MakeLogFileEntry(const LogRecord& record, LogFileEntry& entry)
+{
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    return EncodeLogRecord(record, entry);
+#else
+    if (auto err = FormatLogRecord(record, entry); !err.IsNone()) {
+        return err;
+    }
+
+    entry.Resize(Min(entry.Size(), entry.MaxSize() - 1));
+
+    entry.Append("\n");
+
+    return ErrorEnum::eNone;
+#endif
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOGRECORD_HPP_
+#define LOGRECORD_HPP_
+
+#include <aos/common/tools/array.hpp>
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/log.hpp>
+#include <aos/common/tools/string.hpp>
+#include <aos/common/types.hpp>
+
+#include "logger/types.hpp"
+
+namespace aos::zephyr::logger {
+
+/**
+ * Max log module name length.
+ */
+static constexpr auto cLogModuleLen = 32;
+
+/**
+ * Max size of encoded log record.
+ */
+static constexpr auto cMaxLogRecordLen = 24 + cLogModuleLen + cInstanceIDLen + Log::cMaxLineLen;
+
+/**
+ * Log module of instance console output.
+ */
+static constexpr auto cInstanceLogModule = "runner";
+
+/**
+ * Binary log record.
+ *
+ * Encoded record: varint payload size, varint timestamp in ms, level byte, varint module name size, module name,
+ * varint instance ID size, instance ID and message bytes till the end of the payload. The module is stored by name as
+ * log source IDs are not stable across builds. Empty module name means the message has no log source.
+ */
+struct LogRecord {
+    uint64_t                       mTimestamp {};
+    uint8_t                        mLevel {};
+    StaticString<cLogModuleLen>    mModule;
+    StaticString<cInstanceIDLen>   mInstanceID;
+    StaticString<Log::cMaxLineLen> mMessage;
+
+    /**
+     * Returns record time.
+     *
+     * @return Time.
+     */
+    Time GetTime() const { return FromLogTimestamp(mTimestamp); }
+
+    /**
+     * Sets record time.
+     *
+     * @param time time.
+     */
+    void SetTime(const Time& time) { mTimestamp = ToLogTimestamp(time); }
+};
+
+/**
+ * Log file entry: encoded log record in binary log format or formatted text line otherwise.
+ */
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+using LogFileEntry = StaticArray<uint8_t, cMaxLogRecordLen>;
+#else
+using LogFileEntry = StaticString<cLogEntryLen>;
+#endif
+
+/**
+ * Encodes log record.
+ *
+ * @param record log record.
+ * @param[out] data encoded record.
+ * @return Error.
+ */
+Error EncodeLogRecord(const LogRecord& record, Array<uint8_t>& data);
+
+/**
+ * Decodes log record.
+ *
+ * @param data encoded data.
+ * @param size encoded data size.
+ * @param[out] record log record.
+ * @return RetWithError<size_t> size of decoded record, eNotFound if data doesn't contain the whole record.
+ */
+RetWithError<size_t> DecodeLogRecord(const uint8_t* data, size_t size, LogRecord& record);
+
+/**
+ * Returns size of encoded log record.
+ *
+ * @param data encoded data.
+ * @param size encoded data size.
+ * @return RetWithError<size_t> size of the record, eNotFound if data doesn't contain the whole record.
+ */
+RetWithError<size_t> GetLogRecordSize(const uint8_t* data, size_t size);
+
+/**
+ * Returns timestamp of encoded log record without decoding the whole record.
+ *
+ * @param data encoded data.
+ * @param size encoded data size.
+ * @return RetWithError<uint64_t> timestamp in ms.
+ */
+RetWithError<uint64_t> GetLogRecordTimestamp(const uint8_t* data, size_t size);
+
+/**
+ * Returns instance ID of encoded log record without decoding the whole record.
+ *
+ * @param data encoded data.
+ * @param size encoded data size.
+ * @param[out] instanceID instance ID.
+ * @return Error.
+ */
+Error GetLogRecordInstanceID(const uint8_t* data, size_t size, String& instanceID);
+
+/**
+ * Formats log record into the same text form as the text log format.
+ *
+ * @param record log record.
+ * @param[out] text formatted record.
+ * @return Error.
+ */
+Error FormatLogRecord(const LogRecord& record, String& text);
+
+/**
+ * Makes instance log record: info message of the instance log module with the current time.
+ *
+ * @param instanceID instance ID.
+ * @param message log message.
+ * @param[out] record log record.
+ */
+void MakeInstanceLogRecord(const String& instanceID, const String& message, LogRecord& record);
+
+/**
+ * Makes log file entry of the log record.
+ *
+ * @param record log record.
+ * @param[out] entry log file entry.
+ * @return Error.
+ */
+Error MakeLogFileEntry(const LogRecord& record, LogFileEntry& entry);
+
+} // namespace aos::zephyr::logger
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <aos/common/tools/utils.hpp>
+
+#include "ratelimiter.hpp"
+
+namespace aos::zephyr::logger {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+bool RateLimiter::Allow(const RateLimit& limit, uint64_t now, uint32_t& suppressed)
+{
+    suppressed = 0;
+
+    if (limit.mRate != 0) {
+        // Tokens are scaled by cTokenScale, so refill for elapsed ms is elapsed * rate.
+        uint64_t maxTokens = static_cast<uint64_t>(limit.mBurst) * cTokenScale;
+        uint64_t elapsed   = now > mLastTime ? Min(now - mLastTime, maxTokens) : 0;
+
+        mTokens = Min(Min(mTokens, maxTokens) + elapsed * limit.mRate, maxTokens);
+
+        mLastTime = now;
+
+        if (mTokens < cTokenScale) {
+            mSuppressed++;
+
+            return false;
+        }
+
+        mTokens -= cTokenScale;
+    }
+
+    suppressed = TakeSuppressed();
+
+    return true;
+}
+
+uint32_t RateLimiter::TakeSuppressed()
+{
+    auto suppressed = mSuppressed;
+
+    mSuppressed = 0;
+
+    return suppressed;
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef RATELIMITER_HPP_
+#define RATELIMITER_HPP_
+
+#include <stdint.h>
+
+namespace aos::zephyr::logger {
+
+/**
+ * Log rate limit.
+ */
+struct RateLimit {
+    uint32_t mRate;
+    uint32_t mBurst;
+};
+
+/**
+ * Token bucket log rate limiter.
+ *
+ * Bucket is refilled with mRate tokens per second up to mBurst tokens, each passed message takes one token. Messages
+ * which don't get a token are counted as suppressed. Zero rate disables limiting.
+ */
+class RateLimiter {
+public:
+    /**
+     * Checks if message is allowed.
+     *
+     * @param limit rate limit.
+     * @param now current time in ms.
+     * @param[out] suppressed number of messages suppressed since the last allowed message.
+     * @return bool.
+     */
+    bool Allow(const RateLimit& limit, uint64_t now, uint32_t& suppressed);
+
+    /**
+     * Returns number of messages suppressed since the last allowed message and resets it, so the suppressed messages
+     * are reported even if no message is allowed afterwards.
+     *
+     * @return uint32_t.
+     */
+    uint32_t TakeSuppressed();
+
+private:
+    static constexpr uint64_t cTokenScale = 1000;
+
+    uint64_t mLastTime {};
+    uint64_t mTokens {UINT64_MAX};
+    uint32_t mSuppressed {};
+};
+
+} // namespace aos::zephyr::logger
+
+#endif
@@ -26,16 +26,77 @@ static constexpr auto cLogDir = CONFIG_AOS_LOG_BACKEND_FS_DIR;
  */
 static constexpr auto cLogPrefix = CONFIG_AOS_LOG_BACKEND_FS_FILE_PREFIX;
 
+/**
+ * Length of log file number in log file name. Numbers are zero padded, so log files are sorted by name.
+ */
+static constexpr auto cLogFileNumberLen = 20;
+
 /**
  * Log file size limit.
  */
 static constexpr auto cFileSizeLimit = CONFIG_AOS_LOG_BACKEND_FS_FILE_SIZE;
 
 /**
- *  Max log files.
+ *  Log size limit in log files: total size of log files on disk doesn't exceed cMaxLogFiles * cFileSizeLimit.
  */
 static constexpr auto cMaxLogFiles = CONFIG_AOS_LOG_BACKEND_FS_FILES_LIMIT;
 
+/**
+ * Log size limit.
+ */
+static constexpr size_t cLogSizeLimit = cMaxLogFiles * cFileSizeLimit;
+
+/**
+ * Max number of log files. Compressed log files are smaller than the file size limit, so more of them fit into the log
+ * size limit.
+ */
+static constexpr auto cMaxNumLogFiles = CONFIG_AOS_LOG_BACKEND_FS_MAX_FILES;
+
+/**
+ * Converts time to log timestamp in milliseconds.
+ *
+ * @param time time.
+ * @return uint64_t.
+ */
+inline uint64_t ToLogTimestamp(const Time& time)
+{
+    auto unixTime = time.UnixTime();
+
+    return static_cast<uint64_t>(unixTime.tv_sec) * 1000 + unixTime.tv_nsec / Time::cMilliseconds;
+}
+
+/**
+ * Converts log timestamp in milliseconds to time.
+ *
+ * @param timestamp log timestamp.
+ * @return Time.
+ */
+inline Time FromLogTimestamp(uint64_t timestamp)
+{
+    return Time::Unix(timestamp / 1000, (timestamp % 1000) * Time::cMilliseconds);
+}
+
+/**
+ * Log listener interface.
+ */
+class LogListenerItf {
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~LogListenerItf() = default;
+
+    /**
+     * Notifies about log entries written by the log backend.
+     *
+     * It is called from the log flush thread, so it should not block.
+     *
+     * @param data whole log entries: text lines or binary log records depending on the log format.
+     * @param size data size.
+     */
+    virtual void OnLogEntries(const uint8_t* data, size_t size) = 0;
+};
+
 } // namespace aos::zephyr::logger
 
 #endif
@@ -4,7 +4,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "logprovider/fslogreader.hpp"
@@ -33,7 +35,7 @@ bool FSLogReader::Next()
     LockGuard lock {mMutex};
 
     while (HasFilesToRead()) {
-        if (auto err = ReadLine(); err.IsNone() && mCurrentEntry.HasValue()) {
+        if (auto err = ReadEntry(); err.IsNone() && mCurrentEntry.HasValue()) {
             return true;
         }
     }
@@ -43,7 +45,7 @@ bool FSLogReader::Next()
     return false;
 }
 
-Error FSLogReader::Reset()
+Error FSLogReader::Reset(const LogReaderFilter& filter)
 {
     LockGuard lock {mMutex};
 
@@ -53,6 +55,8 @@ Error FSLogReader::Reset()
 
     mCurrentEntry.Reset();
 
+    mFilter = filter;
+
     return ReadLogFiles();
 }
 
@@ -62,14 +66,191 @@ Error FSLogReader::Reset()
 
 Error FSLogReader::OpenNextFile()
 {
-    mCurrentPos = 0;
-    mFD         = open(mLogFiles.begin()->CStr(), O_RDONLY);
+    StaticString<cFilePathLen> path = *mLogFiles.begin();
+
     mLogFiles.Erase(mLogFiles.begin());
 
+    mCurrentPos   = 0;
+    mReadPos      = 0;
+    mReadSize     = 0;
+    mNextBlockPos = 0;
+    mEndOfFile    = false;
+    mCompressed   = logger::IsCompressedLogFile(path);
+    mFD           = open(path.CStr(), O_RDONLY);
+
+    // Log file may be compressed by the backend after it is listed: read its compressed copy.
+    if (mFD < 0 && errno == ENOENT && !mCompressed) {
+        path.Append(logger::cCompressedLogSuffix);
+
+        mCompressed = true;
+        mFD         = open(path.CStr(), O_RDONLY);
+    }
+
     if (mFD < 0) {
         return Error(ErrorEnum::eFailed, "failed to open log file");
     }
 
+    ApplyLogIndex(path);
+
+    if (mReadRanges.IsEmpty()) {
+        CloseFile();
+
+        return ErrorEnum::eNotFound;
+    }
+
+    if (auto err = Seek(mReadRanges.Front().mStart); !err.IsNone()) {
+        CloseFile();
+
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Selects log index segments to read. Log entries of a log index segment are not earlier than its index entry, and they
+// are not later than the next index entry unless the wall clock goes backwards there. The same applies to the first
+// index entry of the next log file. So segments which end before the requested time range or start after it are
+// skipped. If instance is requested, only segments where the instance logs appear are read. Log files without index and
+// instance log files are read completely.
+void FSLogReader::ApplyLogIndex(const String& path)
+{
+    mReadRanges.Clear();
+
+    if (mInstanceLog || (!mFilter.mFrom.HasValue() && !mFilter.mTill.HasValue() && !mFilter.mInstanceID.HasValue())
+        || !logger::ReadLogIndex(path, mLogIndex).IsNone() || mLogIndex.IsEmpty()) {
+        AddReadRange(0, SIZE_MAX);
+
+        return;
+    }
+
+    bool useInstanceIndex = false;
+
+    if (mFilter.mInstanceID.HasValue()) {
+        auto instanceKey = logger::GetInstanceKey(mFilter.mInstanceID.GetValue());
+
+        useInstanceIndex = logger::ReadInstanceIndex(path, instanceKey, mInstanceSegments).IsNone();
+    }
+
+    Optional<Time> fileEnd;
+
+    if (!mLogFiles.IsEmpty()) {
+        if (auto [entry, err] = logger::GetFirstLogIndexEntry(mLogFiles.Front());
+            err.IsNone() && !entry.IsClockJump()) {
+            fileEnd.SetValue(entry.GetTime());
+        }
+    }
+
+    // Log entries before the first log index entry are not indexed.
+    if (mLogIndex[0].mOffset > 0 && (mLogIndex[0].IsClockJump() || !IsBeforeFrom(mLogIndex[0].GetTime()))) {
+        AddReadRange(0, mLogIndex[0].mOffset);
+    }
+
+    for (size_t i = 0; i < mLogIndex.Size(); i++) {
+        auto isLast = i + 1 == mLogIndex.Size();
+
+        // Clock jumps may overflow the log index, then the rest of the log file is read without time checks.
+        if (isLast && mLogIndex.IsFull()) {
+            AddReadRange(mLogIndex[i].mOffset, SIZE_MAX);
+
+            break;
+        }
+
+        // Segments after a clock jump may be earlier, so the rest of the index is checked too.
+        if (mFilter.mTill.HasValue() && !(mLogIndex[i].GetTime() < mFilter.mTill.GetValue())) {
+            continue;
+        }
+
+        if (useInstanceIndex && !mInstanceSegments.IsSet(i)) {
+            continue;
+        }
+
+        Optional<Time> segmentEnd;
+
+        if (isLast) {
+            segmentEnd = fileEnd;
+        } else if (!mLogIndex[i + 1].IsClockJump()) {
+            segmentEnd.SetValue(mLogIndex[i + 1].GetTime());
+        }
+
+        if (segmentEnd.HasValue() && IsBeforeFrom(segmentEnd.GetValue())) {
+            continue;
+        }
+
+        AddReadRange(mLogIndex[i].mOffset, isLast ? SIZE_MAX : mLogIndex[i + 1].mOffset);
+    }
+}
+
+void FSLogReader::AddReadRange(size_t start, size_t end)
+{
+    if (!mReadRanges.IsEmpty() && mReadRanges.Back().mEnd == start) {
+        mReadRanges.Back().mEnd = end;
+
+        return;
+    }
+
+    mReadRanges.PushBack({start, end});
+}
+
+bool FSLogReader::IsBeforeFrom(const Time& time) const
+{
+    return mFilter.mFrom.HasValue() && time < mFilter.mFrom.GetValue();
+}
+
+// Moves forward to the position. If the position is out of the read buffer, plain log files are seeked directly and
+// compressed blocks before the position are skipped without decompression.
+Error FSLogReader::Seek(size_t pos)
+{
+    mCurrentPos = pos;
+
+    if (pos >= mNextBlockPos - mReadSize && pos < mNextBlockPos) {
+        mReadPos = pos - (mNextBlockPos - mReadSize);
+
+        return ErrorEnum::eNone;
+    }
+
+    mReadPos   = 0;
+    mReadSize  = 0;
+    mEndOfFile = false;
+
+    if (!mCompressed) {
+        if (auto ret = lseek(mFD, pos, SEEK_SET); ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        mNextBlockPos = pos;
+
+        return ErrorEnum::eNone;
+    }
+
+    while (true) {
+        logger::CompressedBlockHeader header;
+
+        auto nread = read(mFD, &header, sizeof(header));
+        if (nread != sizeof(header)) {
+            return nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eNotFound;
+        }
+
+        if (mNextBlockPos + header.mRawSize > pos) {
+            break;
+        }
+
+        if (auto ret = lseek(mFD, header.mCompressedSize, SEEK_CUR); ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        mNextBlockPos += header.mRawSize;
+    }
+
+    if (auto ret = lseek(mFD, -static_cast<off_t>(sizeof(logger::CompressedBlockHeader)), SEEK_CUR); ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    if (auto err = ReadBlock(); !err.IsNone()) {
+        return err;
+    }
+
+    mReadPos = pos - (mNextBlockPos - mReadSize);
+
     return ErrorEnum::eNone;
 }
 
@@ -80,10 +261,13 @@ void FSLogReader::CloseFile()
         mFD = -1;
     }
 
-    mCurrentPos = 0;
+    mCurrentPos   = 0;
+    mReadPos      = 0;
+    mReadSize     = 0;
+    mNextBlockPos = 0;
 }
 
-Error FSLogReader::ReadLine()
+Error FSLogReader::ReadEntry()
 {
     if (mFD == -1) {
         if (auto err = OpenNextFile(); !err.IsNone()) {
@@ -91,28 +275,204 @@ Error FSLogReader::ReadLine()
         }
     }
 
+    while (mCurrentPos >= mReadRanges.Front().mEnd) {
+        mReadRanges.Erase(mReadRanges.begin());
+
+        if (mReadRanges.IsEmpty()) {
+            CloseFile();
+
+            return ErrorEnum::eNotFound;
+        }
+
+        if (auto err = Seek(mReadRanges.Front().mStart); !err.IsNone()) {
+            CloseFile();
+
+            return err;
+        }
+    }
+
+    return ReadBufferedEntry();
+}
+
+// Log files are read by large blocks into the read buffer, entries are parsed in memory. Entries may cross block
+// boundaries, so the rest of the previous block is kept in the read buffer.
+Error FSLogReader::ReadBufferedEntry()
+{
+    while (true) {
+        auto [entrySize, err] = ParseEntry(mReadBuffer + mReadPos, mReadSize - mReadPos, mEndOfFile);
+        if (err.IsNone()) {
+            mReadPos    += entrySize;
+            mCurrentPos += entrySize;
+
+            return ErrorEnum::eNone;
+        }
+
+        if (!err.Is(ErrorEnum::eNotFound) || mEndOfFile) {
+            CloseFile();
+
+            return err;
+        }
+
+        if (err = ReadBlock(); err.Is(ErrorEnum::eNotFound)) {
+            mEndOfFile = true;
+        } else if (!err.IsNone()) {
+            CloseFile();
+
+            return err;
+        }
+    }
+}
+
+Error FSLogReader::ReadBlock()
+{
+    memmove(mReadBuffer, mReadBuffer + mReadPos, mReadSize - mReadPos);
+
+    mReadSize -= mReadPos;
+
+    mReadPos = 0;
+
+    auto [blockSize, err] = mCompressed ? ReadCompressedBlock() : ReadPlainBlock();
+
+    mReadSize     += blockSize;
+    mNextBlockPos += blockSize;
+
+    // Terminate the buffer, so text lines can be searched with C string functions.
+    mReadBuffer[mReadSize] = '\0';
+
+    return err;
+}
+
+RetWithError<size_t> FSLogReader::ReadPlainBlock()
+{
+    auto nread = read(mFD, mReadBuffer + mReadSize, Min(cReadBlockSize, cReadBufferSize - mReadSize));
+    if (nread < 0) {
+        return {0, AOS_ERROR_WRAP(errno)};
+    }
+
+    if (nread == 0) {
+        return {0, ErrorEnum::eNotFound};
+    }
+
+    return static_cast<size_t>(nread);
+}
+
+RetWithError<size_t> FSLogReader::ReadCompressedBlock()
+{
+    logger::CompressedBlockHeader header;
+
+    auto nread = read(mFD, &header, sizeof(header));
+    if (nread == 0) {
+        return {0, ErrorEnum::eNotFound};
+    }
+
+    if (nread != sizeof(header)) {
+        return {0, nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime};
+    }
+
+    if (header.mRawSize > cReadBufferSize - mReadSize || header.mCompressedSize > header.mRawSize
+        || header.mCompressedSize > sizeof(mCompressedBuffer)) {
+        return {0, Error(ErrorEnum::eInvalidArgument, "invalid compressed block")};
+    }
+
+    auto rawData = mReadBuffer + mReadSize;
+    auto data    = header.mCompressedSize == header.mRawSize ? rawData : mCompressedBuffer;
+
+    nread = read(mFD, data, header.mCompressedSize);
+    if (nread != header.mCompressedSize) {
+        return {0, nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime};
+    }
+
+    if (data != rawData) {
+        auto [size, err] = logger::DecompressBlock(data, header.mCompressedSize, rawData, header.mRawSize);
+        if (!err.IsNone() || size != header.mRawSize) {
+            return {0, Error(ErrorEnum::eInvalidArgument, "invalid compressed block")};
+        }
+    }
+
+    return static_cast<size_t>(header.mRawSize);
+}
+
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+// Binary records carry time and instance ID as integers and strings, so no text parsing is needed for filtering.
+RetWithError<size_t> FSLogReader::ParseEntry(const uint8_t* data, size_t size, bool endOfFile)
+{
+    (void)endOfFile;
+
+    auto [recordSize, err] = logger::DecodeLogRecord(data, size, mLogRecord);
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
     mCurrentEntry.EmplaceValue();
+    mCurrentEntry->mTime.SetValue(mLogRecord.GetTime());
 
-    if (auto err = fs::ReadLine(mFD, mCurrentPos, mCurrentEntry->mContent, "\r\n\0"); !err.IsNone()) {
-        CloseFile();
+    if (!mLogRecord.mInstanceID.IsEmpty()) {
+        mCurrentEntry->mInstanceID.SetValue(mLogRecord.mInstanceID);
+    }
 
-        return err;
+    if (err = logger::FormatLogRecord(mLogRecord, mCurrentEntry->mContent); !err.IsNone()) {
+        return {0, err};
     }
 
-    mCurrentPos += mCurrentEntry->mContent.Size() + 1;
+    return recordSize;
+}
+#else
+// The data is terminated by the read buffer, so the line end is searched by strcspn which stops at '\0' as well.
+RetWithError<size_t> FSLogReader::ParseEntry(const uint8_t* data, size_t size, bool endOfFile)
+{
+    if (size == 0) {
+        return {0, ErrorEnum::eNotFound};
+    }
+
+    auto line      = reinterpret_cast<const char*>(data);
+    auto lineSize  = strcspn(line, "\r\n");
+    auto entrySize = lineSize + 1;
+
+    // Line without end is either the last line of the file or the line which exceeds max log entry length.
+    if (lineSize >= size) {
+        if (!endOfFile && size < logger::cLogEntryLen) {
+            return {0, ErrorEnum::eNotFound};
+        }
+
+        lineSize  = Min(size, logger::cLogEntryLen);
+        entrySize = lineSize;
+    }
+
+    mCurrentEntry.EmplaceValue();
+    mCurrentEntry->mContent.Assign(String(line, Min(lineSize, mCurrentEntry->mContent.MaxSize())));
 
     if (auto [time, err] = Time::UTC(mCurrentEntry->mContent); err.IsNone()) {
         mCurrentEntry->mTime.SetValue(time);
     }
 
-    return ErrorEnum::eNone;
+    return entrySize;
 }
+#endif
 
 Error FSLogReader::ReadLogFiles()
+{
+    mInstanceLog = false;
+
+    if (mFilter.mInstanceID.HasValue()) {
+        if (auto err = ReadLogFiles(logger::GetInstanceLogDir(mFilter.mInstanceID.GetValue())); !err.IsNone()) {
+            return err;
+        }
+
+        if (!mLogFiles.IsEmpty()) {
+            mInstanceLog = true;
+
+            return ErrorEnum::eNone;
+        }
+    }
+
+    return ReadLogFiles(logger::cLogDir);
+}
+
+Error FSLogReader::ReadLogFiles(const String& dir)
 {
     mLogFiles.Clear();
 
-    fs::DirIterator dirIterator(logger::cLogDir);
+    fs::DirIterator dirIterator(dir);
 
     while (dirIterator.Next()) {
         if (dirIterator->mIsDir) {
@@ -133,6 +493,21 @@ Error FSLogReader::ReadLogFiles()
 
     mLogFiles.Sort();
 
+    // Log file is listed together with its compressed copy while the backend replaces it: skip the original one.
+    for (auto it = mLogFiles.begin(); it != mLogFiles.end() && it + 1 != mLogFiles.end();) {
+        StaticString<cFilePathLen> compressedPath = *it;
+
+        compressedPath.Append(logger::cCompressedLogSuffix);
+
+        if (compressedPath == *(it + 1)) {
+            mLogFiles.Erase(it);
+
+            continue;
+        }
+
+        it++;
+    }
+
     return ErrorEnum::eNone;
 }
 
@@ -11,6 +11,10 @@
 #include <aos/common/tools/optional.hpp>
 #include <aos/common/tools/thread.hpp>
 
+#include "logger/compression.hpp"
+#include "logger/instancelog.hpp"
+#include "logger/logindex.hpp"
+#include "logger/logrecord.hpp"
 #include "logger/types.hpp"
 
 #include "logprovider/logprovider.hpp"
@@ -19,6 +23,9 @@ namespace aos::zephyr::logprovider {
 
 /**
  * File system log reader.
+ *
+ * If the instance is requested and it has per-instance log files (see logger::InstanceLog), only these files are read.
+ * Otherwise system log files are read.
  */
 class FSLogReader : public LogReaderItf, public NonCopyable {
 public:
@@ -40,22 +47,54 @@ public:
     /**
      * Resets reader.
      *
+     * @param filter log reader filter.
      * @return Error.
      */
-    Error Reset() override;
+    Error Reset(const LogReaderFilter& filter) override;
 
 private:
-    Error OpenNextFile();
-    void  CloseFile();
-    Error ReadLine();
-    Error ReadLogFiles();
-    bool  HasFilesToRead() const;
-
-    Optional<LogEntry>                                            mCurrentEntry = {};
-    size_t                                                        mCurrentPos   = 0;
-    int                                                           mFD           = -1;
-    StaticArray<StaticString<cFilePathLen>, logger::cMaxLogFiles> mLogFiles;
-    Mutex                                                         mMutex;
+    struct ReadRange {
+        size_t mStart;
+        size_t mEnd;
+    };
+
+    static constexpr size_t cReadBlockSize  = logger::cCompressionBlockSize;
+    static constexpr size_t cReadBufferSize = cReadBlockSize + logger::cLogEntryLen + logger::cMaxLogRecordLen;
+
+    Error                OpenNextFile();
+    void                 ApplyLogIndex(const String& path);
+    void                 AddReadRange(size_t start, size_t end);
+    bool                 IsBeforeFrom(const Time& time) const;
+    Error                Seek(size_t pos);
+    void                 CloseFile();
+    Error                ReadEntry();
+    Error                ReadBufferedEntry();
+    Error                ReadBlock();
+    RetWithError<size_t> ReadPlainBlock();
+    RetWithError<size_t> ReadCompressedBlock();
+    RetWithError<size_t> ParseEntry(const uint8_t* data, size_t size, bool endOfFile);
+    Error                ReadLogFiles();
+    Error                ReadLogFiles(const String& dir);
+    bool                 HasFilesToRead() const;
+
+    Optional<LogEntry>                                               mCurrentEntry = {};
+    size_t                                                           mCurrentPos   = 0;
+    int                                                              mFD           = -1;
+    bool                                                             mCompressed   = false;
+    bool                                                             mEndOfFile    = false;
+    bool                                                             mInstanceLog  = false;
+    size_t                                                           mReadPos      = 0;
+    size_t                                                           mReadSize     = 0;
+    size_t                                                           mNextBlockPos = 0;
+    LogReaderFilter                                                  mFilter;
+    logger::LogIndex                                                 mLogIndex;
+    logger::LogIndexSegments                                         mInstanceSegments;
+    StaticArray<ReadRange, logger::cMaxLogIndexEntries + 1>          mReadRanges;
+    StaticArray<StaticString<cFilePathLen>, logger::cMaxNumLogFiles> mLogFiles;
+    Mutex                                                            mMutex;
+    logger::LogRecord                                                mLogRecord;
+    uint8_t                                                          mReadBuffer[cReadBufferSize + 1];
+    uint8_t                                                          mCompressedBuffer[logger::cCompressionBlockSize];
 };
 
 } // namespace aos::zephyr::logprovider
@@ -8,25 +8,122 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/timeutil.h>
 
 #include <aos/common/tools/memory.hpp>
 
+#if CONFIG_AOS_LOG_FLIGHT_RECORDER
+#include "logger/flightrecorder.hpp"
+#endif
+
 #include "log.hpp"
 #include "logprovider.hpp"
 
 namespace aos::zephyr::logprovider {
 
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+// Log level names as they are formatted by the log backend. Severity is the name index + 1, the same as zephyr log
+// level and binary log record level.
+const char* const cLevelNames[] = {"err", "wrn", "inf", "dbg"};
+
+uint8_t GetLevelSeverity(LogLevel level)
+{
+    switch (level.GetValue()) {
+    case LogLevelEnum::eError:
+        return 1;
+
+    case LogLevelEnum::eWarning:
+        return 2;
+
+    case LogLevelEnum::eInfo:
+        return 3;
+
+    default:
+        return 4;
+    }
+}
+
+// Text log entry format: "<time> <level> <module>: <message>". Zero severity means the level is unknown.
+uint8_t GetTextEntrySeverity(const String& entry)
+{
+    auto tag = strstr(entry.CStr(), " <");
+    if (tag == nullptr) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(cLevelNames); i++) {
+        if (strncmp(tag + 2, cLevelNames[i], 3) == 0 && tag[5] == '>') {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+// Returns module of text log entry, empty if the entry format is unknown.
+String GetTextEntryModule(const String& entry)
+{
+    auto tag = strstr(entry.CStr(), " <");
+    if (tag == nullptr || strnlen(tag, 7) < 7 || tag[5] != '>' || tag[6] != ' ') {
+        return String();
+    }
+
+    auto module = tag + 7;
+    auto end    = strchr(module, ':');
+
+    if (end == nullptr) {
+        return String();
+    }
+
+    return String(module, static_cast<size_t>(end - module));
+}
+
+// Sending followed logs produces debug entries of these modules (e.g. SM client logs each sent chunk). They are not
+// followed, otherwise each sent chunk would produce a new one.
+const char* const cFollowIgnoredModules[] = {"logprovider", "smclient"};
+
+bool IsFollowIgnoredModule(const String& module)
+{
+    for (auto ignoredModule : cFollowIgnoredModules) {
+        if (module == String(ignoredModule)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+#endif
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
 
-Error LogProvider::Init(LogReaderItf& logReader, sm::launcher::StorageItf& launcherStorage)
+Error LogProvider::Init(const Array<LogReaderItf*>& logReaders, sm::launcher::StorageItf& launcherStorage,
+    CrashLogReaderItf* crashLogReader)
 {
-    LOG_DBG() << "Initialize log provider";
+    LOG_DBG() << "Initialize log provider" << Log::Field("numWorkers", logReaders.Size());
+
+    if (logReaders.IsEmpty() || logReaders.Size() > cMaxNumLogWorkers) {
+        return Error(ErrorEnum::eInvalidArgument, "wrong number of log readers");
+    }
+
+    for (size_t i = 0; i < logReaders.Size(); i++) {
+        mWorkers[i].mLogReader = logReaders[i];
+    }
 
-    mLogReader       = &logReader;
+    mNumWorkers      = logReaders.Size();
     mLauncherStorage = &launcherStorage;
+    mCrashLogReader  = crashLogReader;
 
     return ErrorEnum::eNone;
 }
@@ -43,7 +140,27 @@ Error LogProvider::Start()
 
     mStopped = false;
 
-    return mThread.Run([this](void*) { ProcessLogRequests(); });
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    {
+        LockGuard followLock {mFollowDataMutex};
+
+        mFollowStopped = false;
+    }
+
+    if (auto err = mFollowThread.Run([this](void*) { ProcessFollowedLogs(); }); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+#endif
+
+    for (size_t i = 0; i < mNumWorkers; i++) {
+        auto& worker = mWorkers[i];
+
+        if (auto err = worker.mThread.Run([this, &worker](void*) { ProcessLogRequests(worker); }); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+    }
+
+    return ErrorEnum::eNone;
 }
 
 Error LogProvider::Stop()
@@ -61,50 +178,68 @@ Error LogProvider::Stop()
         mCondVar.NotifyAll();
     }
 
-    return mThread.Join();
+    Error stopErr;
+
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    {
+        LockGuard followLock {mFollowDataMutex};
+
+        mFollowStopped = true;
+        mFollowCondVar.NotifyAll();
+    }
+
+    stopErr = mFollowThread.Join();
+#endif
+
+    for (size_t i = 0; i < mNumWorkers; i++) {
+        if (auto err = mWorkers[i].mThread.Join(); !err.IsNone() && stopErr.IsNone()) {
+            stopErr = AOS_ERROR_WRAP(err);
+        }
+    }
+
+    return stopErr;
 }
 
 Error LogProvider::GetInstanceLog(const cloudprotocol::RequestLog& request)
 {
-    LockGuard lock {mMutex};
-
     LOG_DBG() << "Get instance log" << Log::Field("logID", request.mLogID)
               << Log::Field("filter", request.mFilter.mInstanceFilter);
 
-    if (auto err = mLogRequests.PushBack(request); !err.IsNone()) {
-        return err;
-    }
-
-    mCondVar.NotifyAll();
-
-    return ErrorEnum::eNone;
+    return AddLogRequest(request, false);
 }
 
 Error LogProvider::GetInstanceCrashLog(const cloudprotocol::RequestLog& request)
 {
-    LOG_DBG() << "Get instance crash log: logID=" << request.mLogID;
+    LOG_DBG() << "Get instance crash log" << Log::Field("logID", request.mLogID);
+
+    if (mCrashLogReader == nullptr) {
+        return ErrorEnum::eNotSupported;
+    }
 
-    return ErrorEnum::eNotSupported;
+    return AddLogRequest(request, true);
 }
 
 Error LogProvider::GetSystemLog(const cloudprotocol::RequestLog& request)
 {
-    LockGuard lock {mMutex};
-
-    LOG_DBG() << "Get system log: logID=" << request.mLogID;
+    LOG_DBG() << "Get system log" << Log::Field("logID", request.mLogID);
 
-    if (auto err = mLogRequests.PushBack(request); !err.IsNone()) {
-        return err;
+#if CONFIG_AOS_LOG_FLIGHT_RECORDER
+    // Put recorded debug context into the log and write it to the log file, so it is included into the requested log.
+    if (auto err = logger::FlightRecorder::Get().Dump(); !err.IsNone()) {
+        LOG_WRN() << "Can't dump flight recorder" << Log::Field(err);
     }
 
-    mCondVar.NotifyAll();
+    if (auto err = logger::backend::FSBackend::Get().Sync(); !err.IsNone()) {
+        LOG_WRN() << "Can't sync log backend" << Log::Field(err);
+    }
+#endif
 
-    return ErrorEnum::eNone;
+    return AddLogRequest(request, false);
 }
 
 Error LogProvider::Subscribe(sm::logprovider::LogObserverItf& observer)
 {
-    LockGuard lock {mMutex};
+    LockGuard lock {mObserverMutex};
 
     LOG_DBG() << "Subscribe log observer";
 
@@ -119,7 +254,7 @@ Error LogProvider::Subscribe(sm::logprovider::LogObserverItf& observer)
 
 Error LogProvider::Unsubscribe(sm::logprovider::LogObserverItf& observer)
 {
-    LockGuard lock {mMutex};
+    LockGuard lock {mObserverMutex};
 
     LOG_DBG() << "Unsubscribe log observer";
 
@@ -128,12 +263,175 @@ Error LogProvider::Unsubscribe(sm::logprovider::LogObserverItf& observer)
     return ErrorEnum::eNone;
 }
 
+Error LogProvider::CancelLogRequest(const String& logID)
+{
+    {
+        LockGuard lock {mMutex};
+
+        LOG_DBG() << "Cancel log request" << Log::Field("logID", logID);
+
+        if (auto worker = FindBusyWorker(logID); worker != nullptr) {
+            worker->mCanceled = true;
+
+            return ErrorEnum::eNone;
+        }
+
+        auto request
+            = mLogRequests.FindIf([&logID](const LogRequest& item) { return item.mRequest.mLogID == logID; });
+        if (request == mLogRequests.end()) {
+            return ErrorEnum::eNotFound;
+        }
+
+        mLogRequests.Erase(request);
+    }
+
+    LockGuard lock {mAllocatorMutex};
+
+    // Pending request is replied here as no worker will process it.
+    return SendErrorLog(logID, Error(ErrorEnum::eFailed, "log request canceled"), mAllocator);
+}
+
+Error LogProvider::GetLogRequestProgress(const String& logID, LogRequestProgress& progress)
+{
+    LockGuard lock {mMutex};
+
+    auto worker = FindBusyWorker(logID);
+    if (worker == nullptr) {
+        return ErrorEnum::eNotFound;
+    }
+
+    progress = worker->mProgress;
+
+    return ErrorEnum::eNone;
+}
+
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+Error LogProvider::FollowLog(const cloudprotocol::RequestLog& request, LogLevel level)
+{
+    LOG_DBG() << "Follow log" << Log::Field("logID", request.mLogID) << Log::Field("level", level);
+
+    UniqueLock allocatorLock {mAllocatorMutex};
+
+    auto [instanceIDFilter, filterErr] = GetInstanceFilter(request, mAllocator);
+    if (!filterErr.IsNone()) {
+        return filterErr;
+    }
+
+    allocatorLock.Unlock();
+
+    if (!(request.mFilter.mInstanceFilter == cloudprotocol::InstanceFilter {}) && !instanceIDFilter.HasValue()) {
+        return Error(ErrorEnum::eNotFound, "instance not found");
+    }
+
+    LockGuard lock {mFollowMutex};
+
+    if (mLogFollowers.FindIf([&request](const LogFollower& item) { return item.mLog.mLogID == request.mLogID; })
+        != mLogFollowers.end()) {
+        return ErrorEnum::eAlreadyExist;
+    }
+
+    if (auto err = mLogFollowers.EmplaceBack(); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    auto& follower = mLogFollowers.Back();
+
+    follower.mLog.mLogID       = request.mLogID;
+    follower.mLog.mMessageType = cloudprotocol::LogMessageTypeEnum::ePushLog;
+    follower.mLog.mStatus      = cloudprotocol::LogStatusEnum::eOk;
+    follower.mLog.mPartsCount  = 0;
+    follower.mLog.mPart        = 0;
+    follower.mInstanceID       = instanceIDFilter;
+    follower.mMaxSeverity      = GetLevelSeverity(level);
+
+    LockGuard followLock {mFollowDataMutex};
+
+    mFollowing = true;
+
+    return ErrorEnum::eNone;
+}
+
+Error LogProvider::StopFollowLog(const String& logID)
+{
+    LockGuard lock {mFollowMutex};
+
+    LOG_DBG() << "Stop follow log" << Log::Field("logID", logID);
+
+    auto follower
+        = mLogFollowers.FindIf([&logID](const LogFollower& item) { return item.mLog.mLogID == logID; });
+    if (follower == mLogFollowers.end()) {
+        return ErrorEnum::eNotFound;
+    }
+
+    Error err;
+
+    if (!follower->mLog.mContent.IsEmpty()) {
+        err = SendLogChunk(follower->mLog);
+    }
+
+    if (err.IsNone()) {
+        err = SendFinalChunk(follower->mLog);
+    }
+
+    mLogFollowers.Erase(follower);
+
+    LockGuard followLock {mFollowDataMutex};
+
+    mFollowing = !mLogFollowers.IsEmpty();
+
+    if (mFollowDroppedSize > 0) {
+        LOG_WRN() << "Followed log entries dropped" << Log::Field("size", mFollowDroppedSize);
+
+        mFollowDroppedSize = 0;
+    }
+
+    return err;
+}
+
+// Called from the log backend flush thread: the entries are only copied here and handled by the follow thread.
+void LogProvider::OnLogEntries(const uint8_t* data, size_t size)
+{
+    LockGuard lock {mFollowDataMutex};
+
+    if (!mFollowing) {
+        return;
+    }
+
+    if (size > mFollowData.MaxSize() - mFollowData.Size()) {
+        mFollowDroppedSize += size;
+
+        return;
+    }
+
+    mFollowData.Insert(mFollowData.end(), data, data + size);
+    mFollowCondVar.NotifyOne();
+}
+#endif
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
 
+Error LogProvider::AddLogRequest(const cloudprotocol::RequestLog& request, bool crashLog)
+{
+    LockGuard lock {mMutex};
+
+    if (auto err = mLogRequests.EmplaceBack(); !err.IsNone()) {
+        return err;
+    }
+
+    mLogRequests.Back().mRequest  = request;
+    mLogRequests.Back().mCrashLog = crashLog;
+
+    mCondVar.NotifyAll();
+
+    return ErrorEnum::eNone;
+}
+
 Error LogProvider::SendLogChunk(cloudprotocol::PushLog& log)
 {
+    LockGuard lock {mObserverMutex};
+
     ++log.mPart;
     ++log.mPartsCount;
 
@@ -157,9 +455,12 @@ Error LogProvider::SendFinalChunk(cloudprotocol::PushLog& log)
     return SendLogChunk(log);
 }
 
-Error LogProvider::SendErrorLog(const String& logID, const Error& err)
+Error LogProvider::SendErrorLog(const String& logID, const Error& err, Allocator& allocator)
 {
-    auto log = MakeUnique<cloudprotocol::PushLog>(&mAllocator);
+    auto log = MakeUnique<cloudprotocol::PushLog>(&allocator);
+    if (log.Get() == nullptr) {
+        return AOS_ERROR_WRAP(ErrorEnum::eNoMemory);
+    }
 
     log->mLogID       = logID;
     log->mMessageType = cloudprotocol::LogMessageTypeEnum::ePushLog;
@@ -171,32 +472,50 @@ Error LogProvider::SendErrorLog(const String& logID, const Error& err)
     return SendLogChunk(*log);
 }
 
-Error LogProvider::HandleLogRequest(const cloudprotocol::RequestLog& request)
+Error LogProvider::HandleLogRequest(Worker& worker)
 {
-    LOG_DBG() << "Handle log request: logID=" << request.mLogID;
+    const auto& request = worker.mRequest;
 
-    if (auto err = mLogReader->Reset(); !err.IsNone()) {
+    LOG_DBG() << "Handle log request" << Log::Field("logID", request.mLogID);
+
+    auto [instanceIDFilter, filterErr] = GetInstanceFilter(request, worker.mAllocator);
+    if (!filterErr.IsNone()) {
+        return filterErr;
+    }
+
+    if (auto err = worker.mLogReader->Reset({request.mFilter.mFrom, request.mFilter.mTill, instanceIDFilter});
+        !err.IsNone()) {
         return err;
     }
 
-    auto instanceIDFilter = GetInstanceFilter(request);
+    auto logEntry = MakeUnique<LogEntry>(&worker.mAllocator);
+    auto log      = MakeUnique<cloudprotocol::PushLog>(&worker.mAllocator);
 
-    auto logEntry = MakeUnique<LogEntry>(&mAllocator);
+    if (logEntry.Get() == nullptr || log.Get() == nullptr) {
+        return AOS_ERROR_WRAP(ErrorEnum::eNoMemory);
+    }
 
-    auto log          = MakeUnique<cloudprotocol::PushLog>(&mAllocator);
     log->mLogID       = request.mLogID;
     log->mMessageType = cloudprotocol::LogMessageTypeEnum::ePushLog;
     log->mStatus      = cloudprotocol::LogStatusEnum::eOk;
 
-    while (mLogReader->Next()) {
+    LogRequestProgress progress;
+
+    while (worker.mLogReader->Next()) {
+        if (auto err = UpdateProgress(worker, progress); !err.IsNone()) {
+            return err;
+        }
+
         logEntry->Reset();
 
-        if (auto err = mLogReader->GetEntry(*logEntry); !err.IsNone()) {
-            LOG_WRN() << "Failed to read log entry: err=" << err;
+        if (auto err = worker.mLogReader->GetEntry(*logEntry); !err.IsNone()) {
+            LOG_WRN() << "Failed to read log entry" << Log::Field(err);
 
             continue;
         }
 
+        progress.mReadEntries++;
+
         if (FilterByDate(*logEntry, request)) {
             continue;
         }
@@ -211,45 +530,347 @@ Error LogProvider::HandleLogRequest(const cloudprotocol::RequestLog& request)
             if (auto err = SendLogChunk(*log); !err.IsNone()) {
                 return err;
             }
+
+            progress.mSentParts++;
         }
 
         log->mContent.Append(logEntry->mContent);
+
+        progress.mSentEntries++;
+        progress.mSentSize += logEntry->mContent.Size();
     }
 
     if (!log->mContent.IsEmpty()) {
         if (auto err = SendLogChunk(*log); !err.IsNone()) {
             return err;
         }
+
+        progress.mSentParts++;
+    }
+
+    if (auto err = UpdateProgress(worker, progress); !err.IsNone()) {
+        return err;
     }
 
+    LOG_DBG() << "Log request done" << Log::Field("logID", request.mLogID)
+              << Log::Field("readEntries", progress.mReadEntries) << Log::Field("sentEntries", progress.mSentEntries)
+              << Log::Field("sentSize", progress.mSentSize) << Log::Field("sentParts", progress.mSentParts);
+
     return SendFinalChunk(*log);
 }
 
-void LogProvider::ProcessLogRequests()
+// Crash logs are small and contain console output without timestamps, so they are sent as is without filtering.
+Error LogProvider::HandleCrashLogRequest(Worker& worker)
 {
+    const auto& request = worker.mRequest;
+
+    LOG_DBG() << "Handle crash log request" << Log::Field("logID", request.mLogID);
+
+    auto [instanceID, filterErr] = GetInstanceFilter(request, worker.mAllocator);
+    if (!filterErr.IsNone()) {
+        return filterErr;
+    }
+
+    if (!instanceID.HasValue()) {
+        return Error(ErrorEnum::eNotFound, "instance not found");
+    }
+
+    auto log = MakeUnique<cloudprotocol::PushLog>(&worker.mAllocator);
+    if (log.Get() == nullptr) {
+        return AOS_ERROR_WRAP(ErrorEnum::eNoMemory);
+    }
+
+    log->mLogID       = request.mLogID;
+    log->mMessageType = cloudprotocol::LogMessageTypeEnum::ePushLog;
+    log->mStatus      = cloudprotocol::LogStatusEnum::eOk;
+
+    LogRequestProgress progress;
+
     while (true) {
-        UniqueLock lock {mMutex};
+        if (auto err = UpdateProgress(worker, progress); !err.IsNone()) {
+            return err;
+        }
 
-        mCondVar.Wait(lock, [this]() { return !mLogRequests.IsEmpty() || mStopped; });
+        if (auto err = mCrashLogReader->ReadCrashLog(*instanceID, progress.mSentSize, log->mContent); !err.IsNone()) {
+            return err;
+        }
 
-        if (mStopped) {
-            return;
+        if (log->mContent.IsEmpty()) {
+            break;
         }
 
-        if (auto err = HandleLogRequest(mLogRequests.Front()); !err.IsNone()) {
-            if (auto sendErr = SendErrorLog(mLogRequests.Front().mLogID, err); !sendErr.IsNone()) {
-                LOG_ERR() << "Failed to send error log: err=" << sendErr;
+        progress.mSentSize += log->mContent.Size();
+
+        if (auto err = SendLogChunk(*log); !err.IsNone()) {
+            return err;
+        }
+
+        progress.mSentParts++;
+    }
+
+    return SendFinalChunk(*log);
+}
+
+// Publishes request progress and checks if the request should be aborted. It is called per log entry, so a request can
+// be canceled while it is being read.
+Error LogProvider::UpdateProgress(Worker& worker, const LogRequestProgress& progress)
+{
+    LockGuard lock {mMutex};
+
+    worker.mProgress = progress;
+
+    if (worker.mCanceled) {
+        return Error(ErrorEnum::eFailed, "log request canceled");
+    }
+
+    if (mStopped) {
+        return Error(ErrorEnum::eWrongState, "log provider stopped");
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Requests are taken from the queue under the lock and handled without it, so new requests can be queued, canceled and
+// handled by other workers meanwhile.
+void LogProvider::ProcessLogRequests(Worker& worker)
+{
+    while (true) {
+        {
+            UniqueLock lock {mMutex};
+
+            mCondVar.Wait(lock, [this]() { return !mLogRequests.IsEmpty() || mStopped; });
+
+            if (mStopped) {
+                return;
             }
+
+            worker.mRequest  = mLogRequests.Front().mRequest;
+            worker.mCrashLog = mLogRequests.Front().mCrashLog;
+            worker.mProgress = {};
+            worker.mBusy     = true;
+            worker.mCanceled = false;
+
+            mLogRequests.Erase(mLogRequests.begin());
         }
 
-        mLogRequests.Erase(mLogRequests.begin());
+        if (auto err = worker.mCrashLog ? HandleCrashLogRequest(worker) : HandleLogRequest(worker); !err.IsNone()) {
+            if (auto sendErr = SendErrorLog(worker.mRequest.mLogID, err, worker.mAllocator); !sendErr.IsNone()) {
+                LOG_ERR() << "Failed to send error log" << Log::Field(sendErr);
+            }
+        }
+
+        {
+            LockGuard lock {mMutex};
+
+            worker.mBusy = false;
+        }
 
 #if AOS_CONFIG_THREAD_STACK_USAGE
-        LOG_DBG() << "Stack usage: size=" << mThread.GetStackUsage();
+        LOG_DBG() << "Stack usage" << Log::Field("size", worker.mThread.GetStackUsage());
 #endif
     }
 }
 
+LogProvider::Worker* LogProvider::FindBusyWorker(const String& logID)
+{
+    for (size_t i = 0; i < mNumWorkers; i++) {
+        if (mWorkers[i].mBusy && mWorkers[i].mRequest.mLogID == logID) {
+            return &mWorkers[i];
+        }
+    }
+
+    return nullptr;
+}
+
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+// Sending followed logs may produce new log entries, e.g. the log observer may log sent chunks. Entries logged on send
+// errors are followed only once as the failed follower is removed.
+void LogProvider::ProcessFollowedLogs()
+{
+    auto pending = false;
+
+    while (true) {
+        {
+            UniqueLock lock {mFollowDataMutex};
+
+            auto ready = [this]() { return !mFollowData.IsEmpty() || mFollowStopped; };
+
+            if (pending) {
+                mFollowCondVar.Wait(lock, cFollowLatency, ready);
+            } else {
+                mFollowCondVar.Wait(lock, ready);
+            }
+
+            if (mFollowStopped) {
+                return;
+            }
+
+            mFollowBatch = mFollowData;
+            mFollowData.Clear();
+        }
+
+        LockGuard lock {mFollowMutex};
+
+        HandleFollowedEntries(mFollowBatch.Get(), mFollowBatch.Size());
+
+        pending = SendFollowedLogs();
+
+        RemoveFailedFollowers();
+    }
+}
+
+void LogProvider::HandleFollowedEntries(const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+        uint8_t severity = 0;
+
+        auto [entrySize, err] = ParseFollowedEntry(data, size, severity);
+        if (!err.IsNone()) {
+            return;
+        }
+
+        data += entrySize;
+        size -= entrySize;
+
+        if (mFollowEntry.mContent.IsEmpty()) {
+            continue;
+        }
+
+        if (severity >= GetLevelSeverity(LogLevelEnum::eDebug) && IsFollowIgnoredModule(GetFollowedEntryModule())) {
+            continue;
+        }
+
+        mFollowEntry.mContent.Append("\n");
+
+        for (auto& follower : mLogFollowers) {
+            if (follower.mFailed || severity > follower.mMaxSeverity) {
+                continue;
+            }
+
+            if (follower.mInstanceID.HasValue() && FilterByInstanceID(mFollowEntry, *follower.mInstanceID)) {
+                continue;
+            }
+
+            if (follower.mLog.mContent.Size() + mFollowEntry.mContent.Size() > follower.mLog.mContent.MaxSize()) {
+                SendFollowedLog(follower);
+            }
+
+            if (follower.mLog.mContent.IsEmpty()) {
+                follower.mPendingTime = k_uptime_get();
+            }
+
+            follower.mLog.mContent.Append(mFollowEntry.mContent);
+        }
+    }
+}
+
+// Sends followed log chunks which have been pending for cFollowLatency. Returns true if there are pending chunks left.
+bool LogProvider::SendFollowedLogs()
+{
+    auto pending = false;
+    auto now     = k_uptime_get();
+
+    for (auto& follower : mLogFollowers) {
+        if (follower.mFailed || follower.mLog.mContent.IsEmpty()) {
+            continue;
+        }
+
+        if (now - follower.mPendingTime >= cFollowLatencyMs) {
+            SendFollowedLog(follower);
+
+            continue;
+        }
+
+        pending = true;
+    }
+
+    return pending;
+}
+
+// If the chunk can't be sent, following is stopped: the follower is removed by RemoveFailedFollowers.
+void LogProvider::SendFollowedLog(LogFollower& follower)
+{
+    if (auto err = SendLogChunk(follower.mLog); !err.IsNone()) {
+        LOG_ERR() << "Can't send followed log" << Log::Field("logID", follower.mLog.mLogID) << Log::Field(err);
+
+        follower.mFailed = true;
+    }
+
+    follower.mLog.mContent.Clear();
+}
+
+void LogProvider::RemoveFailedFollowers()
+{
+    for (auto it = mLogFollowers.end(); it != mLogFollowers.begin();) {
+        if ((--it)->mFailed) {
+            mLogFollowers.Erase(it);
+        }
+    }
+
+    LockGuard lock {mFollowDataMutex};
+
+    mFollowing = !mLogFollowers.IsEmpty();
+}
+
+#if CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+RetWithError<size_t> LogProvider::ParseFollowedEntry(const uint8_t* data, size_t size, uint8_t& severity)
+{
+    auto [recordSize, err] = logger::DecodeLogRecord(data, size, mFollowRecord);
+    if (!err.IsNone()) {
+        return {0, err};
+    }
+
+    mFollowEntry.Reset();
+    mFollowEntry.mTime.SetValue(mFollowRecord.GetTime());
+
+    if (!mFollowRecord.mInstanceID.IsEmpty()) {
+        mFollowEntry.mInstanceID.SetValue(mFollowRecord.mInstanceID);
+    }
+
+    if (err = logger::FormatLogRecord(mFollowRecord, mFollowEntry.mContent); !err.IsNone()) {
+        return {0, err};
+    }
+
+    severity = mFollowRecord.mLevel;
+
+    return recordSize;
+}
+
+String LogProvider::GetFollowedEntryModule() const
+{
+    return mFollowRecord.mModule;
+}
+#else
+RetWithError<size_t> LogProvider::ParseFollowedEntry(const uint8_t* data, size_t size, uint8_t& severity)
+{
+    auto   line      = reinterpret_cast<const char*>(data);
+    size_t entrySize = 0;
+
+    while (entrySize < size && line[entrySize] != '\n' && line[entrySize] != '\0') {
+        entrySize++;
+    }
+
+    auto lineSize = entrySize;
+
+    if (lineSize > 0 && line[lineSize - 1] == '\r') {
+        lineSize--;
+    }
+
+    mFollowEntry.Reset();
+    mFollowEntry.mContent.Assign(String(line, Min(lineSize, mFollowEntry.mContent.MaxSize())));
+
+    severity = GetTextEntrySeverity(mFollowEntry.mContent);
+
+    return Min(entrySize + 1, size);
+}
+
+String LogProvider::GetFollowedEntryModule() const
+{
+    return GetTextEntryModule(mFollowEntry.mContent);
+}
+#endif
+#endif
+
 bool LogProvider::FilterByDate(const LogEntry& logEntry, const cloudprotocol::RequestLog& request)
 {
     if (logEntry.mContent.IsEmpty()) {
@@ -286,6 +907,10 @@ bool LogProvider::FilterByInstanceID(const LogEntry& logEntry, const String& ins
         return true;
     }
 
+    if (logEntry.mInstanceID.HasValue()) {
+        return logEntry.mInstanceID.GetValue() != instanceFilter;
+    }
+
     StaticString<cInstanceIDLen + 2> instanceIdent;
 
     instanceIdent.Append("[").Append(instanceFilter).Append("]");
@@ -293,22 +918,31 @@ bool LogProvider::FilterByInstanceID(const LogEntry& logEntry, const String& ins
     return !logEntry.mContent.FindSubstr(0, instanceIdent).mError.IsNone();
 }
 
-Optional<StaticString<cInstanceIDLen>> LogProvider::GetInstanceFilter(const cloudprotocol::RequestLog& request)
+RetWithError<Optional<StaticString<cInstanceIDLen>>> LogProvider::GetInstanceFilter(
+    const cloudprotocol::RequestLog& request, Allocator& allocator)
 {
+    Optional<StaticString<cInstanceIDLen>> instanceID;
+
     if (request.mFilter.mInstanceFilter == cloudprotocol::InstanceFilter {}) {
-        return {};
+        return instanceID;
+    }
+
+    auto instances = MakeUnique<sm::launcher::InstanceDataStaticArray>(&allocator);
+    if (instances.Get() == nullptr) {
+        return {instanceID, AOS_ERROR_WRAP(ErrorEnum::eNoMemory)};
     }
 
-    auto instances = MakeUnique<sm::launcher::InstanceDataStaticArray>(&mAllocator);
     mLauncherStorage->GetAllInstances(*instances);
 
     for (const auto& instance : *instances) {
         if (request.mFilter.mInstanceFilter.Match(instance.mInstanceInfo.mInstanceIdent)) {
-            return {instance.mInstanceID};
+            instanceID.SetValue(instance.mInstanceID);
+
+            break;
         }
     }
 
-    return {};
+    return instanceID;
 }
 
 } // namespace aos::zephyr::logprovider
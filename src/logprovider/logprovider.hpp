@@ -11,17 +11,24 @@
 #include <aos/common/tools/thread.hpp>
 #include <aos/sm/logprovider.hpp>
 
+#include "logger/logrecord.hpp"
 #include "logger/types.hpp"
 #include "storage/storage.hpp"
 
 namespace aos::zephyr::logprovider {
 
+/**
+ * Max number of log requests processed concurrently.
+ */
+static constexpr auto cMaxNumLogWorkers = CONFIG_AOS_LOG_PROVIDER_NUM_WORKERS;
+
 /**
  * Log entry structure.
  */
 struct LogEntry {
-    StaticString<logger::cLogEntryLen> mContent;
-    Optional<Time>                     mTime = {};
+    StaticString<logger::cLogEntryLen>     mContent;
+    Optional<Time>                         mTime       = {};
+    Optional<StaticString<cInstanceIDLen>> mInstanceID = {};
 
     /**
      * Resets underlying data.
@@ -30,9 +37,31 @@ struct LogEntry {
     {
         mContent.Clear();
         mTime.Reset();
+        mInstanceID.Reset();
     }
 };
 
+/**
+ * Log reader filter.
+ *
+ * Log reader may use it to skip log entries which are filtered out by the log provider anyway.
+ */
+struct LogReaderFilter {
+    Optional<Time>                         mFrom       = {};
+    Optional<Time>                         mTill       = {};
+    Optional<StaticString<cInstanceIDLen>> mInstanceID = {};
+};
+
+/**
+ * Log request progress.
+ */
+struct LogRequestProgress {
+    size_t mReadEntries = 0;
+    size_t mSentEntries = 0;
+    size_t mSentSize    = 0;
+    size_t mSentParts   = 0;
+};
+
 /**
  * Log reader interface.
  */
@@ -61,23 +90,57 @@ public:
     /**
      * Resets reader.
      *
+     * @param filter log reader filter.
      * @return Error.
      */
-    virtual Error Reset() = 0;
+    virtual Error Reset(const LogReaderFilter& filter) = 0;
+};
+
+/**
+ * Crash log reader interface.
+ */
+class CrashLogReaderItf {
+public:
+    /**
+     * Destructor.
+     */
+    virtual ~CrashLogReaderItf() = default;
+
+    /**
+     * Reads part of instance crash log.
+     *
+     * @param instanceID instance ID.
+     * @param offset offset in the crash log.
+     * @param[out] log crash log part up to the log max size, empty at the end of the crash log.
+     * @return Error eNotFound if there is no crash log for the instance.
+     */
+    virtual Error ReadCrashLog(const String& instanceID, size_t offset, String& log) = 0;
 };
 
 /**
  * Log provider.
+ *
+ * If CONFIG_AOS_LOG_PROVIDER_FOLLOW is enabled, besides log requests, which scan log files, the log provider supports
+ * following logs: it subscribes to the log backend as log listener and streams new log entries to the log observer.
  */
-class LogProvider : public sm::logprovider::LogProviderItf {
+class LogProvider : public sm::logprovider::LogProviderItf
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    , public logger::LogListenerItf
+#endif
+{
 public:
     /**
      * Initializes log provider.
      *
-     * @param logReader log reader.
+     * Log requests are processed concurrently by a worker per log reader, so each reader should have its own cursor.
+     *
+     * @param logReaders log readers, up to cMaxNumLogWorkers.
+     * @param launcherStorage launcher storage.
+     * @param crashLogReader crash log reader, crash logs are not supported if it is not set.
      * @return Error.
      */
-    Error Init(LogReaderItf& logReader, sm::launcher::StorageItf& launcherStorage);
+    Error Init(const Array<LogReaderItf*>& logReaders, sm::launcher::StorageItf& launcherStorage,
+        CrashLogReaderItf* crashLogReader = nullptr);
 
     /**
      * Starts log provider.
@@ -133,29 +196,145 @@ public:
      */
     Error Unsubscribe(sm::logprovider::LogObserverItf& observer) override;
 
+    /**
+     * Cancels pending or processed log request.
+     *
+     * @param logID log ID.
+     * @return Error.
+     */
+    Error CancelLogRequest(const String& logID);
+
+    /**
+     * Returns progress of processed log request.
+     *
+     * @param logID log ID.
+     * @param[out] progress log request progress.
+     * @return Error.
+     */
+    Error GetLogRequestProgress(const String& logID, LogRequestProgress& progress);
+
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    /**
+     * Starts following log.
+     *
+     * New log entries which match the request instance filter and the log level are sent to the log observer. Entries
+     * are batched into push log chunks, a chunk is sent when it is full or when cFollowLatency is expired. Debug
+     * entries produced by sending chunks are not followed. Following is stopped if a chunk can't be sent.
+     *
+     * @param request request log.
+     * @param level min log level.
+     * @return Error.
+     */
+    Error FollowLog(const cloudprotocol::RequestLog& request, LogLevel level = LogLevelEnum::eInfo);
+
+    /**
+     * Stops following log.
+     *
+     * @param logID log ID.
+     * @return Error.
+     */
+    Error StopFollowLog(const String& logID);
+
+    /**
+     * Handles log entries written by the log backend.
+     *
+     * @param data log entries.
+     * @param size data size.
+     */
+    void OnLogEntries(const uint8_t* data, size_t size) override;
+#endif
+
 private:
     static constexpr auto cMaxNumLogRequests = 4;
-    static constexpr auto cAllocatorSize
+    static constexpr auto cWorkerAllocatorSize
         = sizeof(cloudprotocol::PushLog) + sizeof(LogEntry) + sizeof(sm::launcher::InstanceDataStaticArray);
+    // API callers allocate one object at a time under mAllocatorMutex: error log on canceling a pending request or
+    // instances on starting log following.
+    static constexpr auto cAllocatorSize
+        = sizeof(cloudprotocol::PushLog) > sizeof(sm::launcher::InstanceDataStaticArray)
+        ? sizeof(cloudprotocol::PushLog)
+        : sizeof(sm::launcher::InstanceDataStaticArray);
+
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    static constexpr auto cMaxNumLogFollowers = 2;
+    static constexpr auto cFollowBufferSize   = CONFIG_AOS_LOG_PROVIDER_FOLLOW_BUFFER_SIZE;
+    static constexpr auto cFollowLatencyMs    = CONFIG_AOS_LOG_PROVIDER_FOLLOW_LATENCY;
+    static constexpr auto cFollowLatency      = cFollowLatencyMs * Time::cMilliseconds;
+
+    struct LogFollower {
+        cloudprotocol::PushLog                 mLog;
+        Optional<StaticString<cInstanceIDLen>> mInstanceID;
+        uint8_t                                mMaxSeverity = 0;
+        int64_t                                mPendingTime = 0;
+        bool                                   mFailed      = false;
+    };
+#endif
+
+    struct LogRequest {
+        cloudprotocol::RequestLog mRequest;
+        bool                      mCrashLog = false;
+    };
+
+    struct Worker {
+        Thread<>                              mThread;
+        StaticAllocator<cWorkerAllocatorSize> mAllocator;
+        LogReaderItf*                         mLogReader = {};
+        cloudprotocol::RequestLog             mRequest;
+        LogRequestProgress                    mProgress;
+        bool                                  mCrashLog = false;
+        bool                                  mBusy     = false;
+        bool                                  mCanceled = false;
+    };
 
-    Error SendLogChunk(cloudprotocol::PushLog& log);
-    Error SendFinalChunk(cloudprotocol::PushLog& log);
-    Error SendErrorLog(const String& logID, const Error& err);
-    Error HandleLogRequest(const cloudprotocol::RequestLog& request);
-    void  ProcessLogRequests();
-    bool  FilterByDate(const LogEntry& logEntry, const cloudprotocol::RequestLog& request);
-    bool  FilterByInstanceID(const LogEntry& logEntry, const String& instanceFilter);
-    Optional<StaticString<cInstanceIDLen>> GetInstanceFilter(const cloudprotocol::RequestLog& request);
+    Error   SendLogChunk(cloudprotocol::PushLog& log);
+    Error   SendFinalChunk(cloudprotocol::PushLog& log);
+    Error   SendErrorLog(const String& logID, const Error& err, Allocator& allocator);
+    Error   HandleLogRequest(Worker& worker);
+    Error   HandleCrashLogRequest(Worker& worker);
+    Error   AddLogRequest(const cloudprotocol::RequestLog& request, bool crashLog);
+    Error   UpdateProgress(Worker& worker, const LogRequestProgress& progress);
+    void    ProcessLogRequests(Worker& worker);
+    Worker* FindBusyWorker(const String& logID);
+    bool    FilterByDate(const LogEntry& logEntry, const cloudprotocol::RequestLog& request);
+    bool    FilterByInstanceID(const LogEntry& logEntry, const String& instanceFilter);
+    RetWithError<Optional<StaticString<cInstanceIDLen>>> GetInstanceFilter(
+        const cloudprotocol::RequestLog& request, Allocator& allocator);
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    void                 ProcessFollowedLogs();
+    void                 HandleFollowedEntries(const uint8_t* data, size_t size);
+    bool                 SendFollowedLogs();
+    void                 SendFollowedLog(LogFollower& follower);
+    void                 RemoveFailedFollowers();
+    RetWithError<size_t> ParseFollowedEntry(const uint8_t* data, size_t size, uint8_t& severity);
+    String               GetFollowedEntryModule() const;
+#endif
 
     StaticAllocator<cAllocatorSize>                            mAllocator;
-    StaticArray<cloudprotocol::RequestLog, cMaxNumLogRequests> mLogRequests;
+    Mutex                                                      mAllocatorMutex;
+    StaticArray<LogRequest, cMaxNumLogRequests>                mLogRequests;
     Mutex                                                      mMutex;
+    Mutex                                                      mObserverMutex;
     ConditionalVariable                                        mCondVar;
-    Thread<>                                                   mThread;
+    Worker                                                     mWorkers[cMaxNumLogWorkers];
+    size_t                                                     mNumWorkers      = 0;
     bool                                                       mStopped         = true;
     sm::logprovider::LogObserverItf*                           mLogObserver     = {};
-    LogReaderItf*                                              mLogReader       = {};
     sm::launcher::StorageItf*                                  mLauncherStorage = {};
+    CrashLogReaderItf*                                         mCrashLogReader  = {};
+#if CONFIG_AOS_LOG_PROVIDER_FOLLOW
+    Mutex                                                      mFollowMutex;
+    Mutex                                                      mFollowDataMutex;
+    ConditionalVariable                                        mFollowCondVar;
+    Thread<>                                                   mFollowThread;
+    StaticArray<LogFollower, cMaxNumLogFollowers>              mLogFollowers;
+    StaticArray<uint8_t, cFollowBufferSize>                    mFollowData;
+    StaticArray<uint8_t, cFollowBufferSize>                    mFollowBatch;
+    LogEntry                                                   mFollowEntry;
+    logger::LogRecord                                          mFollowRecord;
+    size_t                                                     mFollowDroppedSize = 0;
+    bool                                                       mFollowing         = false;
+    bool                                                       mFollowStopped     = true;
+#endif
 };
 
 } // namespace aos::zephyr::logprovider
@@ -4,10 +4,21 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <domain.h>
 #include <xen_console.h>
 #include <xen_dom_mgmt.h>
 
+#include <aos/common/tools/fs.hpp>
+
+#if CONFIG_AOS_RUNNER_CONSOLE_DIRECT_LOG || CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+#include "logger/fsbackend.hpp"
+#endif
 #include "runner/consolereader.hpp"
 
 #include "log.hpp"
@@ -35,12 +46,55 @@ RetWithError<xen_domain*> DomainByInstanceID(const String& instanceID)
     return domain;
 }
 
+StaticString<cFilePathLen> GetCrashLogPath(const String& instanceID)
+{
+    return fs::JoinPath(cCrashLogDir, instanceID);
+}
+
+String TrimLine(char* data, size_t size)
+{
+    constexpr auto cSpaces = " \t\r\n";
+
+    auto start = data;
+    auto end   = data + size;
+
+    while (start < end && strchr(cSpaces, *start)) {
+        start++;
+    }
+
+    while (end > start && strchr(cSpaces, *(end - 1))) {
+        end--;
+    }
+
+    *end = '\0';
+
+    return String(start, end - start);
+}
+
 } // namespace
 
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
 
+ConsoleReader::ConsoleReader()
+{
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    mFlushWork.mReader = this;
+
+    k_work_init_delayable(&mFlushWork.mWork, FlushInstanceLogs);
+#endif
+}
+
+ConsoleReader::~ConsoleReader()
+{
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    struct k_work_sync sync;
+
+    k_work_cancel_delayable_sync(&mFlushWork.mWork, &sync);
+#endif
+}
+
 Error ConsoleReader::Subscribe(const String& instanceID)
 {
     LockGuard lock {mMutex};
@@ -57,11 +111,19 @@ Error ConsoleReader::Subscribe(const String& instanceID)
         return AOS_ERROR_WRAP(aos::ErrorEnum::eAlreadyExist);
     }
 
-    err = mHandlers.EmplaceBack(domain->name);
+    err = mHandlers.EmplaceBack(domain->name, this);
     if (!err.IsNone()) {
         return AOS_ERROR_WRAP(err);
     }
 
+    if (err = mHandlers.Back().OpenInstanceLog(); !err.IsNone()) {
+        LOG_WRN() << "Can't open instance log" << Log::Field("instanceID", instanceID) << Log::Field(err);
+    }
+
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    ScheduleInstanceLogFlush();
+#endif
+
     if (auto ret = set_console_feed_cb(domain, OnConsoleFeed, &mHandlers.Back()); ret != 0) {
         return AOS_ERROR_WRAP(-ret);
     }
@@ -69,66 +131,407 @@ Error ConsoleReader::Subscribe(const String& instanceID)
     return ErrorEnum::eNone;
 }
 
+// Domain which doesn't exist on unsubscribe has exited by itself, not by the stop request: its console output is saved
+// as crash log. The handler is closed before saving, so the last console line without line end gets into the crash log.
 Error ConsoleReader::Unsubscribe(const String& instanceID)
 {
     LockGuard lock {mMutex};
 
     LOG_DBG() << "Unsubscribe console reader" << Log::Field("instanceID", instanceID);
 
+    auto it = mHandlers.FindIf([instanceID](const auto& reader) { return reader.GetInstanceID() == instanceID; });
+    if (it == mHandlers.end()) {
+        return AOS_ERROR_WRAP(aos::ErrorEnum::eNotFound);
+    }
+
     auto [domain, err] = DomainByInstanceID(instanceID);
+    if (err.IsNone()) {
+        if (auto ret = set_console_feed_cb(domain, nullptr, nullptr); ret != 0) {
+            LOG_WRN() << "Could not unregister console feed callback" << Log::Field("instanceID", instanceID)
+                      << Log::Field("code", ret);
+        }
+    }
+
+    it->Close();
+
     if (!err.IsNone()) {
-        return AOS_ERROR_WRAP(err);
+        LOG_WRN() << "Domain exited, save crash log" << Log::Field("instanceID", instanceID);
+
+        if (err = fs::MakeDirAll(cCrashLogDir); err.IsNone()) {
+            err = it->SaveConsoleLog(GetCrashLogPath(instanceID));
+        }
+
+        if (!err.IsNone()) {
+            LOG_ERR() << "Can't save crash log" << Log::Field("instanceID", instanceID) << Log::Field(err);
+        }
+    }
+
+    auto stats = it->GetStats();
+
+    LOG_DBG() << "Console stats" << Log::Field("instanceID", instanceID) << Log::Field("bytes", stats.mNumBytes)
+              << Log::Field("lines", stats.mNumLines) << Log::Field("maxBytesPerSec", stats.mMaxBytesPerSec);
+
+    mHandlers.Erase(it);
+
+    return aos::ErrorEnum::eNone;
+}
+
+// Instance may be restarted after the crash, so the saved crash log is preferred over the console output of the running
+// instance.
+Error ConsoleReader::ReadConsoleLog(const String& instanceID, size_t offset, String& log)
+{
+    LockGuard lock {mMutex};
+
+    log.Clear();
+
+    auto fd = open(GetCrashLogPath(instanceID).CStr(), O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        auto it = mHandlers.FindIf([instanceID](const auto& reader) { return reader.GetInstanceID() == instanceID; });
+        if (it == mHandlers.end()) {
+            return ErrorEnum::eNotFound;
+        }
+
+        return log.Resize(it->ReadConsoleLog(offset, log.Get(), log.MaxSize()));
     }
 
-    if (auto ret = set_console_feed_cb(domain, nullptr, nullptr); ret != 0) {
-        LOG_WRN() << "Could not unregister console feed callback" << Log::Field("instanceID", instanceID)
-                  << Log::Field("code", ret);
+    Error err;
+
+    if (auto ret = lseek(fd, offset, SEEK_SET); ret < 0) {
+        err = AOS_ERROR_WRAP(errno);
+    } else if (auto nread = read(fd, log.Get(), log.MaxSize()); nread < 0) {
+        err = AOS_ERROR_WRAP(errno);
+    } else {
+        err = log.Resize(nread);
     }
 
+    close(fd);
+
+    return err;
+}
+
+Error ConsoleReader::GetConsoleStats(const String& instanceID, ConsoleStats& stats)
+{
+    LockGuard lock {mMutex};
+
     auto it = mHandlers.FindIf([instanceID](const auto& reader) { return reader.GetInstanceID() == instanceID; });
     if (it == mHandlers.end()) {
-        return AOS_ERROR_WRAP(aos::ErrorEnum::eNotFound);
+        return AOS_ERROR_WRAP(ErrorEnum::eNotFound);
     }
 
-    mHandlers.Erase(it);
+    stats = it->GetStats();
 
-    return aos::ErrorEnum::eNone;
+    return ErrorEnum::eNone;
 }
 
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
 
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+// Instance log files are flushed periodically while there are console handlers: console output of the silent instance
+// would not be visible to log readers otherwise.
+void ConsoleReader::FlushInstanceLogs(struct k_work* work)
+{
+    auto reader = CONTAINER_OF(k_work_delayable_from_work(work), FlushWork, mWork)->mReader;
+
+    LockGuard lock {reader->mMutex};
+
+    for (auto& handler : reader->mHandlers) {
+        if (auto err = handler.FlushInstanceLog(); !err.IsNone()) {
+            LOG_ERR() << "Can't flush instance log" << Log::Field("instanceID", handler.GetInstanceID())
+                      << Log::Field(err);
+        }
+    }
+
+    reader->ScheduleInstanceLogFlush();
+}
+
+void ConsoleReader::ScheduleInstanceLogFlush()
+{
+    if (cInstanceLogFlushPeriod > 0 && !mHandlers.IsEmpty()) {
+        k_work_schedule(&mFlushWork.mWork, K_MSEC(cInstanceLogFlushPeriod));
+    }
+}
+
+// Called from the console callback: buffered console lines are written by the flush work without waiting for the
+// flush period.
+void ConsoleReader::RequestInstanceLogFlush()
+{
+    k_work_reschedule(&mFlushWork.mWork, K_NO_WAIT);
+}
+#endif
+
 ConsoleReader::ConsoleHandler::~ConsoleHandler()
 {
     LOG_DBG() << "Destroy domain console reader" << aos::Log::Field("instanceID", mInstanceID);
 
-    if (!mBuffer.IsEmpty()) {
-        Log();
+    ProcessLine();
+}
+
+Error ConsoleReader::ConsoleHandler::OpenInstanceLog()
+{
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    return mInstanceLog.Open(mInstanceID);
+#else
+    return ErrorEnum::eNone;
+#endif
+}
+
+// Buffered console lines are written to the instance log file here, not in the console callback. The line is written
+// to the FS log backend if the instance log file can't be written.
+Error ConsoleReader::ConsoleHandler::FlushInstanceLog()
+{
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    auto& line = mReader->mInstanceLogLine;
+
+    while (GetInstanceLogLine(line)) {
+        if (!mInstanceLog.Write(line).IsNone()) {
+            LogToBackend(line);
+        }
     }
+
+    return mInstanceLog.Flush();
+#else
+    return ErrorEnum::eNone;
+#endif
+}
+
+void ConsoleReader::ConsoleHandler::Close()
+{
+    ProcessLine();
+
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    FlushInstanceLog();
+
+    mInstanceLog.Close();
+#endif
 }
 
+// Called for each console character, so it only collects the line: the line is processed as a whole on the line end.
 void ConsoleReader::ConsoleHandler::OnConsoleFeed(char ch)
 {
-    if (mBuffer.IsFull()) {
-        Log();
+    if (ch != '\0') {
+        mLine[mLineSize++] = ch;
     }
 
-    if (ch == '\n' || ch == '\0') {
-        Log();
-    } else {
-        mBuffer.Append(aos::String(&ch, 1));
+    if (ch == '\n' || ch == '\0' || mLineSize == cLineSize) {
+        ProcessLine();
+    }
+}
+
+// Console log is the tail of the ring buffer: mConsoleLogSize bytes before mConsoleLogPos.
+size_t ConsoleReader::ConsoleHandler::ReadConsoleLog(size_t offset, char* data, size_t size)
+{
+    size_t readSize = 0;
+    auto   key      = k_spin_lock(&mConsoleLogLock);
+
+    if (offset < mConsoleLogSize) {
+        auto start = (mConsoleLogPos + cConsoleLogSize - mConsoleLogSize + offset) % cConsoleLogSize;
+
+        readSize = Min(size, mConsoleLogSize - offset);
+
+        for (size_t i = 0; i < readSize; i++) {
+            data[i] = mConsoleLog[(start + i) % cConsoleLogSize];
+        }
+    }
+
+    k_spin_unlock(&mConsoleLogLock, key);
+
+    return readSize;
+}
+
+Error ConsoleReader::ConsoleHandler::SaveConsoleLog(const String& path)
+{
+    auto fd = open(path.CStr(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    Error  err;
+    char   chunk[cSaveChunkSize];
+    size_t offset = 0;
+
+    while (auto size = ReadConsoleLog(offset, chunk, sizeof(chunk))) {
+        if (auto nwrite = write(fd, chunk, size); nwrite != static_cast<ssize_t>(size)) {
+            err = nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+
+            break;
+        }
+
+        offset += size;
+    }
+
+    if (auto ret = close(fd); ret < 0 && err.IsNone()) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    return err;
+}
+
+ConsoleStats ConsoleReader::ConsoleHandler::GetStats()
+{
+    auto key = k_spin_lock(&mConsoleLogLock);
+
+    UpdateRate(k_uptime_get());
+
+    auto stats = mStats;
+
+    k_spin_unlock(&mConsoleLogLock, key);
+
+    return stats;
+}
+
+void ConsoleReader::ConsoleHandler::ProcessLine()
+{
+    if (mLineSize == 0) {
+        return;
+    }
+
+    PutConsoleLog(mLine, mLineSize);
+
+    Log(TrimLine(mLine, mLineSize));
+
+    mLineSize = 0;
+}
+
+void ConsoleReader::ConsoleHandler::PutConsoleLog(const char* data, size_t size)
+{
+    auto now = k_uptime_get();
+    auto key = k_spin_lock(&mConsoleLogLock);
+
+    UpdateRate(now);
+
+    mStats.mNumBytes += size;
+    mStats.mNumLines++;
+    mRatePeriodBytes += size;
+
+    if (size > cConsoleLogSize) {
+        data += size - cConsoleLogSize;
+        size  = cConsoleLogSize;
+    }
+
+    auto tailSize = Min(size, cConsoleLogSize - mConsoleLogPos);
+
+    memcpy(mConsoleLog + mConsoleLogPos, data, tailSize);
+    memcpy(mConsoleLog, data + tailSize, size - tailSize);
+
+    mConsoleLogPos  = (mConsoleLogPos + size) % cConsoleLogSize;
+    mConsoleLogSize = Min(mConsoleLogSize + size, cConsoleLogSize);
+
+    k_spin_unlock(&mConsoleLogLock, key);
+}
+
+// Rate is calculated for the last complete period, so it is updated when the period is over.
+void ConsoleReader::ConsoleHandler::UpdateRate(int64_t now)
+{
+    auto period = now - mRatePeriodStart;
+    if (period < cRatePeriod) {
+        return;
     }
+
+    mStats.mBytesPerSec    = mRatePeriodBytes * 1000 / period;
+    mStats.mMaxBytesPerSec = Max(mStats.mMaxBytesPerSec, mStats.mBytesPerSec);
+
+    mRatePeriodStart = now;
+    mRatePeriodBytes = 0;
 }
 
-void ConsoleReader::ConsoleHandler::Log()
+void ConsoleReader::ConsoleHandler::Log(const String& line)
 {
-    mBuffer.Trim(" \t\r\n");
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    if (PutInstanceLogLine(line)) {
+        return;
+    }
+#endif
+
+    LogToBackend(line);
+}
+
+void ConsoleReader::ConsoleHandler::LogToBackend(const String& line)
+{
+    // Binary log records keep instance ID in a dedicated field, which is set by PutInstanceLog only.
+#if CONFIG_AOS_RUNNER_CONSOLE_DIRECT_LOG || CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT
+    if (logger::backend::FSBackend::Get().PutInstanceLog(mInstanceID, line).IsNone()) {
+        return;
+    }
+#endif
+
+    LOG_INF() << "[" << mInstanceID << "]" << line;
+}
+
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+// Lines are put into the buffer as a whole with the line end, so only complete lines are taken from it. The flush work
+// is requested when the buffer is half full or if there is no flush period.
+bool ConsoleReader::ConsoleHandler::PutInstanceLogLine(const String& line)
+{
+    auto key = k_spin_lock(&mConsoleLogLock);
+
+    auto put = mInstanceLogSize + line.Size() + 1 <= cInstanceLogBufferSize;
+    if (put) {
+        auto pos = (mInstanceLogPos + mInstanceLogSize) % cInstanceLogBufferSize;
+
+        for (size_t i = 0; i <= line.Size(); i++) {
+            mInstanceLogBuffer[(pos + i) % cInstanceLogBufferSize] = i < line.Size() ? line[i] : '\n';
+        }
+
+        mInstanceLogSize += line.Size() + 1;
+    }
+
+    auto flush = cInstanceLogFlushPeriod == 0 || mInstanceLogSize >= cInstanceLogBufferSize / 2;
+
+    k_spin_unlock(&mConsoleLogLock, key);
+
+    if (flush) {
+        mReader->RequestInstanceLogFlush();
+    }
+
+    return put;
+}
+
+bool ConsoleReader::ConsoleHandler::GetInstanceLogLine(String& line)
+{
+    auto key = k_spin_lock(&mConsoleLogLock);
+
+    if (mInstanceLogSize == 0) {
+        k_spin_unlock(&mConsoleLogLock, key);
+
+        return false;
+    }
+
+    size_t size    = 0;
+    bool   lineEnd = false;
+
+    while (size < mInstanceLogSize) {
+        auto ch = mInstanceLogBuffer[(mInstanceLogPos + size) % cInstanceLogBufferSize];
+        if (ch == '\n') {
+            lineEnd = true;
+
+            break;
+        }
+
+        if (size == line.MaxSize()) {
+            break;
+        }
+
+        line.Get()[size++] = ch;
+    }
+
+    auto takenSize = lineEnd ? size + 1 : size;
+
+    mInstanceLogPos   = (mInstanceLogPos + takenSize) % cInstanceLogBufferSize;
+    mInstanceLogSize -= takenSize;
+
+    k_spin_unlock(&mConsoleLogLock, key);
 
-    LOG_INF() << "[" << mInstanceID << "]" << mBuffer;
+    line.Resize(size);
 
-    mBuffer.Clear();
+    return true;
 }
+#endif
 
 void ConsoleReader::OnConsoleFeed(char ch, void* data)
 {
@@ -7,18 +7,64 @@
 #ifndef CONSOLEREADER_HPP_
 #define CONSOLEREADER_HPP_
 
+#include <zephyr/kernel.h>
+
 #include <aos/common/tools/error.hpp>
 #include <aos/common/tools/string.hpp>
 #include <aos/common/tools/thread.hpp>
 #include <aos/common/types.hpp>
 
+#include "logger/instancelog.hpp"
+
 namespace aos::zephyr::runner {
 
+/**
+ * Size of recent console output kept in RAM per domain.
+ */
+static constexpr size_t cConsoleLogSize = CONFIG_AOS_RUNNER_CONSOLE_LOG_SIZE;
+
+/**
+ * Crash log directory.
+ */
+static constexpr auto cCrashLogDir = CONFIG_AOS_RUNNER_CRASH_LOG_DIR;
+
+/**
+ * Console statistics.
+ */
+struct ConsoleStats {
+    size_t mNumBytes;
+    size_t mNumLines;
+    size_t mBytesPerSec;
+    size_t mMaxBytesPerSec;
+};
+
 /**
  * Console reader class handles console output from Xen domains.
+ *
+ * Besides logging console output, recent console output of each domain is kept in the RAM ring buffer. If the domain
+ * exits abnormally, the ring buffer is saved into the crash log file, so the crash log is available without scanning
+ * log files.
+ *
+ * Console output is collected by lines: each line is put into the ring buffer at once and, if
+ * CONFIG_AOS_RUNNER_CONSOLE_DIRECT_LOG or CONFIG_AOS_LOG_BACKEND_FS_BINARY_FORMAT is enabled, written directly to the
+ * instance log of the FS log backend without formatting by the logging subsystem. If CONFIG_AOS_LOG_INSTANCE_FILES is
+ * enabled, console output is written to per-instance log files instead (see logger::InstanceLog). Console lines are
+ * buffered in RAM per instance and written to the instance log files from the system work queue every
+ * CONFIG_AOS_LOG_BACKEND_FS_FLUSH_PERIOD or when the buffer is half full, so the console callback never waits for the
+ * file system. If the buffer is full, the line is written to the FS log backend instead.
  */
 class ConsoleReader {
 public:
+    /**
+     * Constructor.
+     */
+    ConsoleReader();
+
+    /**
+     * Destructor.
+     */
+    ~ConsoleReader();
+
     /**
      * Subscribes to console output for a specific instance ID.
      *
@@ -35,11 +81,32 @@ public:
      */
     Error Unsubscribe(const String& instanceID);
 
+    /**
+     * Reads part of instance console log: saved crash log or, if there is none, recent console output of running
+     * instance.
+     *
+     * @param instanceID instance ID.
+     * @param offset offset in the console log.
+     * @param[out] log console log part up to the log max size, empty at the end of the console log.
+     * @return Error.
+     */
+    Error ReadConsoleLog(const String& instanceID, size_t offset, String& log);
+
+    /**
+     * Returns console statistics of running instance.
+     *
+     * @param instanceID instance ID.
+     * @param[out] stats console statistics.
+     * @return Error.
+     */
+    Error GetConsoleStats(const String& instanceID, ConsoleStats& stats);
+
 private:
     class ConsoleHandler {
     public:
-        explicit ConsoleHandler(const String& instanceID)
+        ConsoleHandler(const String& instanceID, ConsoleReader* reader)
             : mInstanceID(instanceID)
+            , mReader(reader)
         {
         }
 
@@ -49,17 +116,69 @@ private:
 
         String GetInstanceID() const { return mInstanceID; }
 
+        Error        OpenInstanceLog();
+        Error        FlushInstanceLog();
+        void         Close();
+        size_t       ReadConsoleLog(size_t offset, char* data, size_t size);
+        Error        SaveConsoleLog(const String& path);
+        ConsoleStats GetStats();
+
     private:
-        void Log();
+        static constexpr size_t cSaveChunkSize = 256;
+        static constexpr size_t cLineSize      = Log::cMaxLineLen;
+        static constexpr auto   cRatePeriod    = 1000;
+
+        void ProcessLine();
+        void PutConsoleLog(const char* data, size_t size);
+        void UpdateRate(int64_t now);
+        void Log(const String& line);
+        void LogToBackend(const String& line);
 
-        StaticString<Log::cMaxLineLen> mBuffer;
-        StaticString<cInstanceIDLen>   mInstanceID;
+        StaticString<cInstanceIDLen> mInstanceID;
+        ConsoleReader*               mReader;
+        char                         mLine[cLineSize + 1] {};
+        size_t                       mLineSize = 0;
+        struct k_spinlock            mConsoleLogLock {};
+        char                         mConsoleLog[cConsoleLogSize] {};
+        size_t                       mConsoleLogPos   = 0;
+        size_t                       mConsoleLogSize  = 0;
+        ConsoleStats                 mStats           = {};
+        int64_t                      mRatePeriodStart = 0;
+        size_t                       mRatePeriodBytes = 0;
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+        static constexpr size_t cInstanceLogBufferSize = CONFIG_AOS_LOG_INSTANCE_BUFFER_SIZE;
+
+        bool PutInstanceLogLine(const String& line);
+        bool GetInstanceLogLine(String& line);
+
+        char                mInstanceLogBuffer[cInstanceLogBufferSize] {};
+        size_t              mInstanceLogPos  = 0;
+        size_t              mInstanceLogSize = 0;
+        logger::InstanceLog mInstanceLog;
+#endif
     };
 
     static void OnConsoleFeed(char ch, void* data);
 
     StaticArray<ConsoleHandler, cMaxNumInstances> mHandlers;
     Mutex                                         mMutex;
+
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    static constexpr auto cInstanceLogFlushPeriod = CONFIG_AOS_LOG_BACKEND_FS_FLUSH_PERIOD;
+
+    struct FlushWork {
+        struct k_work_delayable mWork;
+        ConsoleReader*          mReader;
+    };
+
+    static void FlushInstanceLogs(struct k_work* work);
+
+    void ScheduleInstanceLogFlush();
+    void RequestInstanceLogFlush();
+
+    FlushWork                      mFlushWork {};
+    StaticString<Log::cMaxLineLen> mInstanceLogLine;
+#endif
 };
 
 } // namespace aos::zephyr::runner
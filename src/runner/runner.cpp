@@ -57,4 +57,9 @@ Error Runner::StopInstance(const String& instanceID)
     return ErrorEnum::eNone;
 }
 
+Error Runner::ReadCrashLog(const String& instanceID, size_t offset, String& log)
+{
+    return mConsoleReader.ReadConsoleLog(instanceID, offset, log);
+}
+
 } // namespace aos::zephyr::runner
@@ -10,6 +10,7 @@
 
 #include <aos/sm/runner.hpp>
 
+#include "logprovider/logprovider.hpp"
 #include "runner/consolereader.hpp"
 
 namespace aos::zephyr::runner {
@@ -17,7 +18,7 @@ namespace aos::zephyr::runner {
 /**
  * Runner instance.
  */
-class Runner : public sm::runner::RunnerItf, private NonCopyable {
+class Runner : public sm::runner::RunnerItf, public logprovider::CrashLogReaderItf, private NonCopyable {
 public:
     /**
      * Initializes runner instance.
@@ -45,6 +46,16 @@ public:
      */
     Error StopInstance(const String& instanceID) override;
 
+    /**
+     * Reads part of instance crash log.
+     *
+     * @param instanceID instance ID.
+     * @param offset offset in the crash log.
+     * @param[out] log crash log part.
+     * @return Error.
+     */
+    Error ReadCrashLog(const String& instanceID, size_t offset, String& log) override;
+
 private:
     static constexpr int cConsoleSocket = 0;
 
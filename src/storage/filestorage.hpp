@@ -9,11 +9,13 @@
 #define FILE_STORAGE_HPP_
 
 #include <fcntl.h>
+#include <stddef.h>
 #include <sys/stat.h>
 
 #include <unistd.h>
 
 #include <aos/common/tools/allocator.hpp>
+#include <aos/common/tools/array.hpp>
 #include <aos/common/tools/error.hpp>
 #include <aos/common/tools/memory.hpp>
 #include <aos/common/tools/noncopyable.hpp>
@@ -94,182 +96,277 @@ public:
     template <typename F>
     Error Add(const T& data, F filter)
     {
-        auto ret = lseek(mFd, sizeof(Header), SEEK_SET);
-        if (ret < 0) {
-            return AOS_ERROR_WRAP(errno);
-        }
+        off_t deletedRecordOffset {-1};
+        off_t endOffset {sizeof(Header)};
 
-        UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
-        ssize_t           nread {};
-        off_t             deletedRecordOffset {-1};
+        auto err = ForEachRecord([&](const Record& record, off_t offset) -> RetWithError<bool> {
+            endOffset = offset + static_cast<off_t>(sizeof(Record));
 
-        while ((nread = read(mFd, record.Get(), sizeof(Record))) == sizeof(Record)) {
-            if (!record->mDeleted && filter(record->mData, data)) {
-                return ErrorEnum::eAlreadyExist;
+            if (!record.mDeleted && filter(record.mData, data)) {
+                return {true, ErrorEnum::eAlreadyExist};
             }
 
-            if (deletedRecordOffset == -1 && record->mDeleted) {
-                deletedRecordOffset = lseek(mFd, 0, SEEK_CUR) - static_cast<off_t>(sizeof(Record));
-                if (deletedRecordOffset < 0) {
-                    return AOS_ERROR_WRAP(errno);
-                }
+            if (deletedRecordOffset == -1 && record.mDeleted) {
+                deletedRecordOffset = offset;
             }
-        }
 
-        if (nread < 0) {
-            return AOS_ERROR_WRAP(errno);
+            return false;
+        });
+        if (!err.IsNone()) {
+            return err;
         }
 
+        UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
+
         record->mData    = data;
         record->mDeleted = 0;
 
-        auto checksum = utils::CalculateSha256(
-            Array<uint8_t>(reinterpret_cast<uint8_t*>(record.Get()), sizeof(Record) - cSHA256Size));
-        if (!checksum.mError.IsNone()) {
-            return checksum.mError;
+        if (err = WriteRecord(*record, deletedRecordOffset >= 0 ? deletedRecordOffset : endOffset, true);
+            !err.IsNone()) {
+            return err;
         }
 
-        Array<uint8_t>(reinterpret_cast<uint8_t*>(record->mChecksum), cSHA256Size) = checksum.mValue;
+        if (err = Sync(); !err.IsNone()) {
+            return err;
+        }
 
-        if (deletedRecordOffset >= 0) {
-            ret = lseek(mFd, deletedRecordOffset, SEEK_SET);
-            if (ret < 0) {
-                return AOS_ERROR_WRAP(errno);
+        return ErrorEnum::eNone;
+    }
+
+    /**
+     * Updates the records in the database.
+     *
+     * @tparam F Filter type.
+     * @param data Record to update.
+     * @param filter Filter to find record.
+     * @return Error
+     */
+    template <typename F>
+    Error Update(const T& data, F filter)
+    {
+        bool found = false;
+
+        auto err = ForEachRecord([&](Record& record, off_t offset) -> RetWithError<bool> {
+            if (record.mDeleted || !filter(record.mData)) {
+                return false;
             }
+
+            found        = true;
+            record.mData = data;
+
+            return {true, WriteRecord(record, offset, true)};
+        });
+        if (!err.IsNone()) {
+            return err;
         }
 
-        ssize_t nwrite = write(mFd, record.Get(), sizeof(Record));
-        if (nwrite != sizeof(Record)) {
-            return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+        if (found) {
+            return ErrorEnum::eNone;
         }
 
-        auto err = Sync();
-        if (!err.IsNone()) {
+        if (err = Sync(); !err.IsNone()) {
             return err;
         }
 
-        return ErrorEnum::eNone;
+        return ErrorEnum::eNotFound;
     }
 
     /**
-     * Updates the records in the database.
+     * Removes record from the database.
      *
      * @tparam F Filter type.
-     * @param data Record to update.
      * @param filter Filter to find record.
      * @return Error
      */
     template <typename F>
-    Error Update(const T& data, F filter)
+    Error Remove(F filter)
     {
-        auto ret = lseek(mFd, sizeof(Header), SEEK_SET);
-        if (ret < 0) {
-            return AOS_ERROR_WRAP(errno);
+        bool found = false;
+
+        auto err = ForEachRecord([&](Record& record, off_t offset) -> RetWithError<bool> {
+            if (record.mDeleted || !filter(record.mData)) {
+                return false;
+            }
+
+            found           = true;
+            record.mDeleted = 1;
+
+            if (auto err = WriteRecord(record, offset, false); !err.IsNone()) {
+                return {true, err};
+            }
+
+            return {true, Sync()};
+        });
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        if (!found) {
+            return ErrorEnum::eNotFound;
+        }
+
+        return ErrorEnum::eNone;
+    }
+
+    /**
+     * Adds new records to the database using single database scan and single sync.
+     *
+     * Nothing is written if any of the records already exists or the batch contains the same record twice. If writing
+     * a record fails, the records of the batch written before are marked as deleted.
+     *
+     * @tparam G Getter type.
+     * @tparam F Filter type.
+     * @param count Number of records to add.
+     * @param get Function which fills record data by index.
+     * @param filter Filter to check if record with index already exists.
+     * @return Error
+     */
+    template <typename G, typename F>
+    Error AddRecords(size_t count, G get, F filter)
+    {
+        if (count > cMaxBatchSize) {
+            return AOS_ERROR_WRAP(ErrorEnum::eNoMemory);
         }
 
         UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
-        ssize_t           nread {};
 
-        while ((nread = read(mFd, record.Get(), sizeof(Record))) == sizeof(Record)) {
-            if (record->mDeleted) {
-                continue;
+        for (size_t i = 1; i < count; i++) {
+            if (auto err = get(i, record->mData); !err.IsNone()) {
+                return err;
             }
 
-            if (!filter(record->mData)) {
-                continue;
+            for (size_t j = 0; j < i; j++) {
+                if (filter(record->mData, j)) {
+                    return ErrorEnum::eAlreadyExist;
+                }
             }
+        }
 
-            off_t offset = -static_cast<off_t>(sizeof(Record));
+        StaticArray<off_t, cMaxBatchSize> deletedOffsets;
+        off_t                             endOffset {sizeof(Header)};
 
-            ret = lseek(mFd, offset, SEEK_CUR);
-            if (ret < 0) {
-                return AOS_ERROR_WRAP(errno);
+        auto err = ForEachRecord([&](const Record& record, off_t offset) -> RetWithError<bool> {
+            endOffset = offset + static_cast<off_t>(sizeof(Record));
+
+            if (record.mDeleted) {
+                if (deletedOffsets.Size() < count) {
+                    deletedOffsets.PushBack(offset);
+                }
+
+                return false;
             }
 
-            record->mData = data;
+            for (size_t i = 0; i < count; i++) {
+                if (filter(record.mData, i)) {
+                    return {true, ErrorEnum::eAlreadyExist};
+                }
+            }
 
-            auto checksum = utils::CalculateSha256(
-                Array<uint8_t>(reinterpret_cast<uint8_t*>(record.Get()), sizeof(Record) - cSHA256Size));
-            if (!checksum.mError.IsNone()) {
-                return checksum.mError;
+            return false;
+        });
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        StaticArray<off_t, cMaxBatchSize> offsets;
+
+        for (size_t i = 0; i < count; i++) {
+            if (err = get(i, record->mData); !err.IsNone()) {
+                break;
             }
 
-            Array<uint8_t>(reinterpret_cast<uint8_t*>(record->mChecksum), cSHA256Size) = checksum.mValue;
+            record->mDeleted = 0;
 
-            ssize_t nwrite = write(mFd, record.Get(), sizeof(Record));
-            if (nwrite != sizeof(Record)) {
-                return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+            off_t offset = endOffset;
+
+            if (i < deletedOffsets.Size()) {
+                offset = deletedOffsets[i];
+            } else {
+                endOffset += sizeof(Record);
             }
 
-            return ErrorEnum::eNone;
-        }
+            // Track the offset before writing as a failed write may leave a partially written record.
+            offsets.PushBack(offset);
 
-        if (nread < 0) {
-            return AOS_ERROR_WRAP(errno);
+            if (err = WriteRecord(*record, offset, true); !err.IsNone()) {
+                break;
+            }
         }
 
-        auto err = Sync();
         if (!err.IsNone()) {
+            // Best effort rollback: the original error is returned anyway.
+            MarkDeleted(offsets);
+            Sync();
+
             return err;
         }
 
-        return ErrorEnum::eNotFound;
+        return Sync();
     }
 
     /**
-     * Removes record from the database.
+     * Updates records in the database using single database scan and single sync.
      *
+     * Nothing is written if any of the records is not found. If writing a record fails, the records of the batch
+     * written before stay updated.
+     *
+     * @tparam G Getter type.
      * @tparam F Filter type.
-     * @param filter Filter to find record.
+     * @param count Number of records to update.
+     * @param get Function which fills record data by index.
+     * @param filter Filter to find record with index.
      * @return Error
      */
-    template <typename F>
-    Error Remove(F filter)
+    template <typename G, typename F>
+    Error UpdateRecords(size_t count, G get, F filter)
     {
-        auto ret = lseek(mFd, sizeof(Header), SEEK_SET);
-        if (ret < 0) {
-            return AOS_ERROR_WRAP(errno);
+        StaticArray<off_t, cMaxBatchSize> offsets;
+
+        if (auto err = FindRecords(count, filter, offsets); !err.IsNone()) {
+            return err;
         }
 
         UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
-        ssize_t           nread {};
-
-        while ((nread = read(mFd, record.Get(), sizeof(Record))) == sizeof(Record)) {
-            if (record->mDeleted) {
-                continue;
-            }
 
-            if (!filter(record->mData)) {
-                continue;
+        for (size_t i = 0; i < count; i++) {
+            if (auto err = get(i, record->mData); !err.IsNone()) {
+                return err;
             }
 
-            off_t offset = -static_cast<off_t>(sizeof(Record));
+            record->mDeleted = 0;
 
-            ret = lseek(mFd, offset, SEEK_CUR);
-            if (ret < 0) {
-                return AOS_ERROR_WRAP(errno);
+            if (auto err = WriteRecord(*record, offsets[i], true); !err.IsNone()) {
+                return err;
             }
+        }
 
-            record->mDeleted = 1;
-
-            ssize_t nwrite = write(mFd, record.Get(), sizeof(Record));
-            if (nwrite != sizeof(Record)) {
-                return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
-            }
+        return Sync();
+    }
 
-            auto err = Sync();
-            if (!err.IsNone()) {
-                return err;
-            }
+    /**
+     * Removes records from the database using single database scan and single sync.
+     *
+     * Nothing is removed if any of the records is not found.
+     *
+     * @tparam F Filter type.
+     * @param count Number of records to remove.
+     * @param filter Filter to find record with index.
+     * @return Error
+     */
+    template <typename F>
+    Error RemoveRecords(size_t count, F filter)
+    {
+        StaticArray<off_t, cMaxBatchSize> offsets;
 
-            return ErrorEnum::eNone;
+        if (auto err = FindRecords(count, filter, offsets); !err.IsNone()) {
+            return err;
         }
 
-        if (nread < 0) {
-            return AOS_ERROR_WRAP(errno);
+        if (auto err = MarkDeleted(offsets); !err.IsNone()) {
+            return err;
         }
 
-        return ErrorEnum::eNotFound;
+        return Sync();
     }
 
     /**
@@ -282,30 +379,19 @@ public:
     template <typename F>
     Error ReadRecords(F append)
     {
-        auto ret = lseek(mFd, sizeof(Header), SEEK_SET);
-        if (ret < 0) {
-            return AOS_ERROR_WRAP(errno);
-        }
-
-        UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
-        ssize_t           nread {};
+        return ForEachRecord([&append](const Record& record, off_t offset) -> RetWithError<bool> {
+            (void)offset;
 
-        while ((nread = read(mFd, record.Get(), sizeof(Record))) == sizeof(Record)) {
-            if (record->mDeleted) {
-                continue;
+            if (record.mDeleted) {
+                return false;
             }
 
-            auto err = append(record->mData);
-            if (!err.IsNone()) {
-                return err;
+            if (auto err = append(record.mData); !err.IsNone()) {
+                return {true, err};
             }
-        }
-
-        if (nread < 0) {
-            return AOS_ERROR_WRAP(errno);
-        }
 
-        return ErrorEnum::eNone;
+            return false;
+        });
     }
 
     /**
@@ -318,35 +404,142 @@ public:
      */
     template <typename F>
     Error ReadRecordByFilter(T& data, F filter)
+    {
+        bool found = false;
+
+        auto err = ForEachRecord([&](const Record& record, off_t offset) -> RetWithError<bool> {
+            (void)offset;
+
+            if (record.mDeleted || !filter(record.mData)) {
+                return false;
+            }
+
+            found = true;
+            data  = record.mData;
+
+            return true;
+        });
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        if (!found) {
+            return ErrorEnum::eNotFound;
+        }
+
+        return ErrorEnum::eNone;
+    }
+
+private:
+    static constexpr auto cReadBlockSize = CONFIG_AOS_STORAGE_READ_BLOCK_SIZE;
+    static constexpr auto cMaxBatchSize  = CONFIG_AOS_STORAGE_BATCH_SIZE;
+
+    struct Header {
+        uint64_t mVersion;
+        uint8_t  mReserved[256];
+        uint8_t  mChecksum[cSHA256Size];
+    };
+
+    struct Record {
+        T       mData;
+        uint8_t mDeleted;
+        uint8_t mChecksum[cSHA256Size];
+    };
+
+    static constexpr auto cReadBlockRecords = Max(cReadBlockSize / sizeof(Record), static_cast<size_t>(1));
+
+    // Reads the database in blocks of cReadBlockRecords records and calls the handler for each record, including
+    // deleted ones. The handler returns true to stop iteration. An incomplete trailing record is treated as EOF.
+    template <typename F>
+    Error ForEachRecord(F handler)
     {
         auto ret = lseek(mFd, sizeof(Header), SEEK_SET);
         if (ret < 0) {
             return AOS_ERROR_WRAP(errno);
         }
 
-        UniquePtr<Record> record = MakeUnique<Record>(&mAllocator);
-        ssize_t           nread {};
+        off_t offset = sizeof(Header);
 
-        while ((nread = read(mFd, record.Get(), sizeof(Record))) == sizeof(Record)) {
-            if (record->mDeleted) {
-                continue;
+        while (true) {
+            ssize_t nread = read(mFd, mReadBlock, sizeof(mReadBlock));
+            if (nread < 0) {
+                return AOS_ERROR_WRAP(errno);
             }
 
-            if (filter(record->mData)) {
-                data = record->mData;
+            size_t numRecords = static_cast<size_t>(nread) / sizeof(Record);
+
+            for (size_t i = 0; i < numRecords; i++) {
+                auto [stop, err] = handler(mReadBlock[i], offset);
+                if (!err.IsNone() || stop) {
+                    return err;
+                }
+
+                offset += sizeof(Record);
+            }
 
+            if (static_cast<size_t>(nread) < sizeof(mReadBlock)) {
                 return ErrorEnum::eNone;
             }
         }
+    }
 
-        if (nread < 0) {
-            return AOS_ERROR_WRAP(errno);
+    // Finds offsets of not deleted records matching filter for each index in one database scan.
+    template <typename F>
+    Error FindRecords(size_t count, F filter, Array<off_t>& offsets)
+    {
+        if (auto err = offsets.Resize(count, -1); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
         }
 
-        return ErrorEnum::eNotFound;
+        size_t numFound = 0;
+
+        auto err = ForEachRecord([&](const Record& record, off_t offset) -> RetWithError<bool> {
+            if (record.mDeleted) {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                if (offsets[i] == -1 && filter(record.mData, i)) {
+                    offsets[i] = offset;
+                    numFound++;
+
+                    break;
+                }
+            }
+
+            return numFound == count;
+        });
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        if (numFound != count) {
+            return ErrorEnum::eNotFound;
+        }
+
+        return ErrorEnum::eNone;
+    }
+
+    // Only deleted flag is changed. Checksum is not updated the same way as in Remove.
+    Error MarkDeleted(const Array<off_t>& offsets)
+    {
+        const uint8_t deleted = 1;
+
+        for (const auto& offset : offsets) {
+            auto ret = lseek(mFd, offset + offsetof(Record, mDeleted), SEEK_SET);
+            if (ret < 0) {
+                return AOS_ERROR_WRAP(errno);
+            }
+
+            ssize_t nwrite = write(mFd, &deleted, sizeof(deleted));
+            if (nwrite != sizeof(deleted)) {
+                return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+            }
+        }
+
+        return ErrorEnum::eNone;
     }
 
-private:
     // Currently, zephyr doesn't provide Posix API (fsync) to flush the file correctly. We have to
     // rewrite this class using zephyr FS API. As workaround, we just reopen the file.
     Error Sync()
@@ -366,21 +559,35 @@ private:
         return ErrorEnum::eNone;
     }
 
-    struct Header {
-        uint64_t mVersion;
-        uint8_t  mReserved[256];
-        uint8_t  mChecksum[cSHA256Size];
-    };
+    Error WriteRecord(Record& record, off_t offset, bool updateChecksum)
+    {
+        if (updateChecksum) {
+            auto checksum = utils::CalculateSha256(
+                Array<uint8_t>(reinterpret_cast<uint8_t*>(&record), sizeof(Record) - cSHA256Size));
+            if (!checksum.mError.IsNone()) {
+                return checksum.mError;
+            }
 
-    struct Record {
-        T       mData;
-        uint8_t mDeleted;
-        uint8_t mChecksum[cSHA256Size];
-    };
+            Array<uint8_t>(reinterpret_cast<uint8_t*>(record.mChecksum), cSHA256Size) = checksum.mValue;
+        }
+
+        auto ret = lseek(mFd, offset, SEEK_SET);
+        if (ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        ssize_t nwrite = write(mFd, &record, sizeof(Record));
+        if (nwrite != sizeof(Record)) {
+            return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+        }
+
+        return ErrorEnum::eNone;
+    }
 
     StaticString<cFilePathLen>                           mFileName;
     StaticAllocator<Max(sizeof(Header), sizeof(Record))> mAllocator;
     int                                                  mFd {-1};
+    Record                                               mReadBlock[cReadBlockRecords];
 };
 
 } // namespace aos::zephyr::storage
@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zephyr/sys/crc.h>
+
+#include <aos/common/tools/fs.hpp>
+
+#include "kvstorage.hpp"
+#include "log.hpp"
+
+namespace aos::zephyr::storage {
+
+/***********************************************************************************************************************
+ * Public
+ **********************************************************************************************************************/
+
+KVStorage::~KVStorage()
+{
+    if (mFd >= 0) {
+        close(mFd);
+    }
+}
+
+Error KVStorage::Init(const String& path)
+{
+    LOG_DBG() << "Initialize KV storage: path=" << path;
+
+    mFileName = path;
+
+    // Leftover of interrupted compaction: the storage file is replaced atomically, so it is still valid.
+    if (auto err = fs::Remove(GetTmpFileName()); !err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    mFd = open(mFileName.CStr(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (mFd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    if (auto err = Load(); !err.IsNone()) {
+        return err;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error KVStorage::Set(uint32_t key, const Array<uint8_t>& value)
+{
+    EntryHeader header {key, static_cast<uint32_t>(value.Size()), 0};
+
+    header.mCRC = crc32_ieee_update(0, reinterpret_cast<const uint8_t*>(&header), offsetof(EntryHeader, mCRC));
+    header.mCRC = crc32_ieee_update(header.mCRC, value.Get(), value.Size());
+
+    auto entry = FindEntry(key);
+    if (entry == nullptr && mEntries.Size() == mEntries.MaxSize()) {
+        return AOS_ERROR_WRAP(ErrorEnum::eNoMemory);
+    }
+
+    if (auto ret = lseek(mFd, mFileSize, SEEK_SET); ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    if (auto err = Write(mFd, &header, sizeof(header)); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = Write(mFd, value.Get(), value.Size()); !err.IsNone()) {
+        return err;
+    }
+
+    if (auto err = Sync(); !err.IsNone()) {
+        return err;
+    }
+
+    if (entry == nullptr) {
+        mEntries.EmplaceBack();
+
+        entry       = &mEntries.Back();
+        entry->mKey = key;
+    }
+
+    entry->mOffset = mFileSize;
+    entry->mSize   = header.mSize;
+
+    mFileSize += sizeof(header) + value.Size();
+
+    // The value is already stored, so compaction failure is not fatal: it will be retried on next set.
+    if (mFileSize > cCompactionSize && static_cast<size_t>(mFileSize) > 2 * GetLiveSize()) {
+        if (auto err = Compact(); !err.IsNone()) {
+            LOG_WRN() << "Can't compact KV storage: path=" << mFileName << ", err=" << err;
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error KVStorage::Get(uint32_t key, Array<uint8_t>& value)
+{
+    auto entry = FindEntry(key);
+    if (entry == nullptr) {
+        return ErrorEnum::eNotFound;
+    }
+
+    if (auto err = value.Resize(entry->mSize); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    if (auto ret = lseek(mFd, entry->mOffset + sizeof(EntryHeader), SEEK_SET); ret < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    ssize_t nread = read(mFd, value.Get(), value.Size());
+    if (nread != static_cast<ssize_t>(value.Size())) {
+        return nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+/***********************************************************************************************************************
+ * Private
+ **********************************************************************************************************************/
+
+Error KVStorage::Load()
+{
+    mEntries.Clear();
+
+    auto fileSize = lseek(mFd, 0, SEEK_END);
+    if (fileSize < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    off_t       offset = 0;
+    EntryHeader header;
+
+    while (offset + static_cast<off_t>(sizeof(header)) <= fileSize) {
+        if (auto ret = lseek(mFd, offset, SEEK_SET); ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        ssize_t nread = read(mFd, &header, sizeof(header));
+        if (nread < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        if (nread != sizeof(header) || offset + static_cast<off_t>(sizeof(header) + header.mSize) > fileSize) {
+            break;
+        }
+
+        auto [crc, err] = CalculateCRC(header, offset + sizeof(header));
+        if (!err.IsNone()) {
+            return err;
+        }
+
+        if (crc != header.mCRC) {
+            break;
+        }
+
+        auto entry = FindEntry(header.mKey);
+        if (entry == nullptr) {
+            if (err = mEntries.EmplaceBack(); !err.IsNone()) {
+                return AOS_ERROR_WRAP(err);
+            }
+
+            entry       = &mEntries.Back();
+            entry->mKey = header.mKey;
+        }
+
+        entry->mOffset = offset;
+        entry->mSize   = header.mSize;
+
+        offset += sizeof(header) + header.mSize;
+    }
+
+    mFileSize = offset;
+
+    if (offset != fileSize) {
+        LOG_WRN() << "KV storage is corrupted, drop invalid entries: path=" << mFileName << ", offset=" << offset
+                  << ", size=" << fileSize;
+
+        return Compact();
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error KVStorage::Compact()
+{
+    LOG_DBG() << "Compact KV storage: path=" << mFileName << ", size=" << mFileSize;
+
+    auto tmpFileName = GetTmpFileName();
+
+    int tmpFd = open(tmpFileName.CStr(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (tmpFd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    StaticArray<Entry, cMaxNumKeys> entries = mEntries;
+    off_t                           offset  = 0;
+
+    if (auto err = CopyEntries(tmpFd, entries, offset); !err.IsNone()) {
+        close(tmpFd);
+        fs::Remove(tmpFileName);
+
+        return err;
+    }
+
+    if (auto ret = close(tmpFd); ret < 0) {
+        auto err = AOS_ERROR_WRAP(errno);
+
+        fs::Remove(tmpFileName);
+
+        return err;
+    }
+
+    Error err;
+
+    if (auto ret = close(mFd); ret < 0) {
+        err = AOS_ERROR_WRAP(errno);
+    }
+
+    mFd = -1;
+
+    auto renamed = false;
+
+    if (err.IsNone()) {
+        if (err = fs::Rename(tmpFileName, mFileName); err.IsNone()) {
+            renamed = true;
+        } else {
+            err = AOS_ERROR_WRAP(err);
+        }
+    }
+
+    if (renamed) {
+        mEntries  = entries;
+        mFileSize = offset;
+        mBytesWritten += offset;
+        mNumCompactions++;
+    } else {
+        fs::Remove(tmpFileName);
+    }
+
+    // Reopen the storage file on any result: rename is atomic, so either the original or the compacted file is
+    // in place.
+    if (auto syncErr = Sync(); !syncErr.IsNone() && err.IsNone()) {
+        err = syncErr;
+    }
+
+    return err;
+}
+
+Error KVStorage::CopyEntries(int fd, Array<Entry>& entries, off_t& offset)
+{
+    uint8_t buffer[cCopyChunkSize];
+
+    for (auto& entry : entries) {
+        if (auto ret = lseek(mFd, entry.mOffset, SEEK_SET); ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        size_t size = sizeof(EntryHeader) + entry.mSize;
+
+        while (size > 0) {
+            auto chunkSize = Min(size, sizeof(buffer));
+
+            ssize_t nread = read(mFd, buffer, chunkSize);
+            if (nread != static_cast<ssize_t>(chunkSize)) {
+                return nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+            }
+
+            if (auto err = Write(fd, buffer, chunkSize); !err.IsNone()) {
+                return err;
+            }
+
+            size -= chunkSize;
+        }
+
+        entry.mOffset = offset;
+        offset += sizeof(EntryHeader) + entry.mSize;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+// Currently, zephyr doesn't provide Posix API (fsync) to flush the file correctly. As workaround, we just reopen
+// the file the same way FileStorage does.
+Error KVStorage::Sync()
+{
+    if (mFd >= 0) {
+        if (auto ret = close(mFd); ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+    }
+
+    mFd = open(mFileName.CStr(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (mFd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error KVStorage::Write(int fd, const void* data, size_t size)
+{
+    if (size == 0) {
+        return ErrorEnum::eNone;
+    }
+
+    ssize_t nwrite = write(fd, data, size);
+    if (nwrite != static_cast<ssize_t>(size)) {
+        return nwrite < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime;
+    }
+
+    if (fd == mFd) {
+        mBytesWritten += size;
+    }
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<uint32_t> KVStorage::CalculateCRC(const EntryHeader& header, off_t payloadOffset)
+{
+    uint32_t crc = crc32_ieee_update(0, reinterpret_cast<const uint8_t*>(&header), offsetof(EntryHeader, mCRC));
+    uint8_t  buffer[cCopyChunkSize];
+    size_t   size = header.mSize;
+
+    if (auto ret = lseek(mFd, payloadOffset, SEEK_SET); ret < 0) {
+        return {0, AOS_ERROR_WRAP(errno)};
+    }
+
+    while (size > 0) {
+        auto chunkSize = Min(size, sizeof(buffer));
+
+        ssize_t nread = read(mFd, buffer, chunkSize);
+        if (nread != static_cast<ssize_t>(chunkSize)) {
+            return {0, nread < 0 ? AOS_ERROR_WRAP(errno) : ErrorEnum::eRuntime};
+        }
+
+        crc = crc32_ieee_update(crc, buffer, chunkSize);
+        size -= chunkSize;
+    }
+
+    return crc;
+}
+
+size_t KVStorage::GetLiveSize() const
+{
+    size_t size = 0;
+
+    for (const auto& entry : mEntries) {
+        size += sizeof(EntryHeader) + entry.mSize;
+    }
+
+    return size;
+}
+
+StaticString<cFilePathLen> KVStorage::GetTmpFileName() const
+{
+    StaticString<cFilePathLen> tmpFileName = mFileName;
+
+    tmpFileName.Append(".tmp");
+
+    return tmpFileName;
+}
+
+KVStorage::Entry* KVStorage::FindEntry(uint32_t key)
+{
+    auto it = mEntries.FindIf([key](const Entry& entry) { return entry.mKey == key; });
+    if (it == mEntries.end()) {
+        return nullptr;
+    }
+
+    return it;
+}
+
+} // namespace aos::zephyr::storage
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef KVSTORAGE_HPP_
+#define KVSTORAGE_HPP_
+
+#include <sys/types.h>
+
+#include <aos/common/tools/array.hpp>
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/noncopyable.hpp>
+#include <aos/common/tools/string.hpp>
+#include <aos/common/types.hpp>
+
+namespace aos::zephyr::storage {
+
+/**
+ * Log-structured key/value storage.
+ *
+ * Each Set appends a new CRC protected entry to the end of the file instead of rewriting it. Only the latest entry
+ * of each key is live. When the file grows above the compaction size, live entries are copied into a new file which
+ * replaces the old one. It is intended for small, frequently updated settings.
+ */
+class KVStorage : public NonCopyable {
+public:
+    /**
+     * Max number of keys.
+     */
+    static constexpr auto cMaxNumKeys = 8;
+
+    /**
+     * Destructor.
+     */
+    ~KVStorage();
+
+    /**
+     * Initializes the storage.
+     *
+     * @param path path to storage file.
+     * @return Error.
+     */
+    Error Init(const String& path);
+
+    /**
+     * Sets value for the key.
+     *
+     * @param key key.
+     * @param value value.
+     * @return Error.
+     */
+    Error Set(uint32_t key, const Array<uint8_t>& value);
+
+    /**
+     * Returns value for the key.
+     *
+     * @param key key.
+     * @param[out] value value.
+     * @return Error.
+     */
+    Error Get(uint32_t key, Array<uint8_t>& value);
+
+    /**
+     * Returns total number of bytes written to the storage file since initialization.
+     *
+     * @return size_t.
+     */
+    size_t GetBytesWritten() const { return mBytesWritten; }
+
+    /**
+     * Returns number of compactions performed since initialization.
+     *
+     * @return size_t.
+     */
+    size_t GetNumCompactions() const { return mNumCompactions; }
+
+private:
+    static constexpr auto cCompactionSize = CONFIG_AOS_STORAGE_KV_COMPACTION_SIZE;
+    static constexpr auto cCopyChunkSize  = 256;
+
+    struct EntryHeader {
+        uint32_t mKey;
+        uint32_t mSize;
+        uint32_t mCRC;
+    };
+
+    struct Entry {
+        uint32_t mKey;
+        off_t    mOffset;
+        uint32_t mSize;
+    };
+
+    Error                      Load();
+    Error                      Compact();
+    Error                      CopyEntries(int fd, Array<Entry>& entries, off_t& offset);
+    Error                      Sync();
+    Error                      Write(int fd, const void* data, size_t size);
+    RetWithError<uint32_t>     CalculateCRC(const EntryHeader& header, off_t payloadOffset);
+    size_t                     GetLiveSize() const;
+    StaticString<cFilePathLen> GetTmpFileName() const;
+    Entry*                     FindEntry(uint32_t key);
+
+    StaticString<cFilePathLen>      mFileName;
+    int                             mFd = -1;
+    off_t                           mFileSize {};
+    size_t                          mBytesWritten {};
+    size_t                          mNumCompactions {};
+    StaticArray<Entry, cMaxNumKeys> mEntries;
+};
+
+} // namespace aos::zephyr::storage
+
+#endif
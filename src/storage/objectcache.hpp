@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OBJECTCACHE_HPP_
+#define OBJECTCACHE_HPP_
+
+#include <aos/common/tools/array.hpp>
+#include <aos/common/tools/error.hpp>
+#include <aos/common/tools/noncopyable.hpp>
+
+namespace aos::zephyr::storage {
+
+/**
+ * Read-through cache of decoded storage objects.
+ *
+ * The cache keeps the whole table. It is filled on the first read or lookup and is used until invalidated. If the table
+ * doesn't fit into the cache, the cache stays invalid and each read goes to the storage.
+ *
+ * @tparam T object type.
+ * @tparam cMaxNumItems max number of cached objects, 0 disables the cache.
+ */
+template <typename T, size_t cMaxNumItems>
+class ObjectCache : public NonCopyable {
+public:
+    /**
+     * Reads objects through the cache.
+     *
+     * @tparam L load function type.
+     * @tparam H handler type.
+     * @param load function which reads all objects from the storage and calls passed callback for each of them.
+     * @param handler handler which is called for each object.
+     * @return Error.
+     */
+    template <typename L, typename H>
+    Error Read(L load, H handler)
+    {
+        if (mValid) {
+            mHits++;
+
+            for (const auto& item : mItems) {
+                if (auto err = handler(item); !err.IsNone()) {
+                    return err;
+                }
+            }
+
+            return ErrorEnum::eNone;
+        }
+
+        mMisses++;
+
+        return Fill(load, handler);
+    }
+
+    /**
+     * Finds cached object. If the cache is not valid, it is filled from the storage first.
+     *
+     * @tparam L load function type.
+     * @tparam P predicate type.
+     * @param load function which reads all objects from the storage and calls passed callback for each of them.
+     * @param predicate predicate which matches the object.
+     * @return RetWithError<const T*> found object or nullptr, eNotSupported error if the table doesn't fit into the
+     * cache.
+     */
+    template <typename L, typename P>
+    RetWithError<const T*> Find(L load, P predicate)
+    {
+        if (!mValid) {
+            mMisses++;
+
+            // Don't reload the table which is known not to fit until the cache is invalidated.
+            if (mOverflow) {
+                return {nullptr, ErrorEnum::eNotSupported};
+            }
+
+            if (auto err = Fill(load, [](const T&) -> Error { return ErrorEnum::eNone; }); !err.IsNone()) {
+                return {nullptr, err};
+            }
+
+            if (!mValid) {
+                return {nullptr, ErrorEnum::eNotSupported};
+            }
+        } else {
+            mHits++;
+        }
+
+        auto it = mItems.FindIf(predicate);
+        if (it == mItems.end()) {
+            return {nullptr, ErrorEnum::eNone};
+        }
+
+        return {it, ErrorEnum::eNone};
+    }
+
+    /**
+     * Invalidates the cache.
+     */
+    void Invalidate()
+    {
+        mValid    = false;
+        mOverflow = false;
+        mItems.Clear();
+    }
+
+    /**
+     * Returns number of cache hits.
+     *
+     * @return size_t.
+     */
+    size_t GetHits() const { return mHits; }
+
+    /**
+     * Returns number of cache misses.
+     *
+     * @return size_t.
+     */
+    size_t GetMisses() const { return mMisses; }
+
+private:
+    template <typename L, typename H>
+    Error Fill(L load, H handler)
+    {
+        bool fits = true;
+
+        mItems.Clear();
+
+        auto err = load([this, &fits, &handler](const T& item) -> Error {
+            if (fits && !mItems.PushBack(item).IsNone()) {
+                fits = false;
+
+                mItems.Clear();
+            }
+
+            return handler(item);
+        });
+        if (!err.IsNone()) {
+            mItems.Clear();
+
+            return err;
+        }
+
+        mValid    = fits;
+        mOverflow = !fits;
+
+        return ErrorEnum::eNone;
+    }
+
+    StaticArray<T, cMaxNumItems> mItems;
+    bool                         mValid {};
+    bool                         mOverflow {};
+    size_t                       mHits {};
+    size_t                       mMisses {};
+};
+
+/**
+ * Disabled object cache: all reads go to the storage.
+ *
+ * @tparam T object type.
+ */
+template <typename T>
+class ObjectCache<T, 0> : public NonCopyable {
+public:
+    template <typename L, typename H>
+    Error Read(L load, H handler)
+    {
+        mMisses++;
+
+        return load(handler);
+    }
+
+    template <typename L, typename P>
+    RetWithError<const T*> Find(L load, P predicate)
+    {
+        (void)load;
+        (void)predicate;
+
+        mMisses++;
+
+        return {nullptr, ErrorEnum::eNotSupported};
+    }
+
+    void   Invalidate() { }
+    size_t GetHits() const { return 0; }
+    size_t GetMisses() const { return mMisses; }
+
+private:
+    size_t mMisses {};
+};
+
+} // namespace aos::zephyr::storage
+
+#endif
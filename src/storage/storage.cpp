@@ -7,11 +7,33 @@
 
 #include <aos/common/tools/fs.hpp>
 
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+#include "logger/instancelog.hpp"
+#endif
+
 #include "log.hpp"
 #include "storage.hpp"
 
 namespace aos::zephyr::storage {
 
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+// Instance logs are kept till the instance is removed: the instance may be restarted and its logs are still requested.
+void RemoveInstanceLog([[maybe_unused]] const String& instanceID)
+{
+#if CONFIG_AOS_LOG_INSTANCE_FILES
+    if (auto err = logger::RemoveInstanceLog(instanceID); !err.IsNone()) {
+        LOG_WRN() << "Can't remove instance log: id=" << instanceID << ", err=" << err;
+    }
+#endif
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -48,6 +70,12 @@ Error Storage::Init()
         return AOS_ERROR_WRAP(err);
     }
 
+    auto settingsPath = fs::JoinPath(cStoragePath, "settings.db");
+
+    if (auto err = mKVStorage.Init(settingsPath); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
     return ErrorEnum::eNone;
 }
 
@@ -85,10 +113,64 @@ Error Storage::RemoveInstance(const String& instanceID)
 
     LOG_DBG() << "Remove instance: id=" << instanceID;
 
+    RemoveInstanceLog(instanceID);
+
     return mInstanceDatabase.Remove(
         [&instanceID](const Storage::InstanceData& data) { return data.mInstanceID == instanceID; });
 }
 
+Error Storage::AddInstances(const Array<sm::launcher::InstanceData>& instances)
+{
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Add instances: count=" << instances.Size();
+
+    return mInstanceDatabase.AddRecords(
+        instances.Size(),
+        [&instances, this](size_t index, Storage::InstanceData& data) -> Error {
+            data = *ConvertInstanceData(instances[index]);
+
+            return ErrorEnum::eNone;
+        },
+        [&instances](const Storage::InstanceData& data, size_t index) {
+            return data.mInstanceID == instances[index].mInstanceID;
+        });
+}
+
+Error Storage::UpdateInstances(const Array<sm::launcher::InstanceData>& instances)
+{
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Update instances: count=" << instances.Size();
+
+    return mInstanceDatabase.UpdateRecords(
+        instances.Size(),
+        [&instances, this](size_t index, Storage::InstanceData& data) -> Error {
+            data = *ConvertInstanceData(instances[index]);
+
+            return ErrorEnum::eNone;
+        },
+        [&instances](const Storage::InstanceData& data, size_t index) {
+            return data.mInstanceID == instances[index].mInstanceID;
+        });
+}
+
+Error Storage::RemoveInstances(const Array<StaticString<cInstanceIDLen>>& instanceIDs)
+{
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Remove instances: count=" << instanceIDs.Size();
+
+    for (const auto& instanceID : instanceIDs) {
+        RemoveInstanceLog(instanceID);
+    }
+
+    return mInstanceDatabase.RemoveRecords(instanceIDs.Size(),
+        [&instanceIDs](const Storage::InstanceData& data, size_t index) {
+            return data.mInstanceID == instanceIDs[index];
+        });
+}
+
 Error Storage::GetAllInstances(Array<sm::launcher::InstanceData>& instances)
 {
     LockGuard lock(mMutex);
@@ -110,40 +192,204 @@ Error Storage::GetAllInstances(Array<sm::launcher::InstanceData>& instances)
 
 RetWithError<uint64_t> Storage::GetOperationVersion() const
 {
-    return 0;
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Get operation version";
+
+    uint64_t version = 0;
+
+    if (auto err = GetKVValue(cOperationVersionKey, &version, sizeof(version)); !err.IsNone()) {
+        if (err.Is(ErrorEnum::eNotFound)) {
+            return 0;
+        }
+
+        return {0, err};
+    }
+
+    return version;
 }
 
 Error Storage::SetOperationVersion(uint64_t version)
 {
-    (void)version;
+    LockGuard lock(mMutex);
 
-    return ErrorEnum::eNone;
+    LOG_DBG() << "Set operation version: version=" << version;
+
+    return SetKVValue(cOperationVersionKey, &version, sizeof(version));
 }
 
 Error Storage::GetOverrideEnvVars(Array<cloudprotocol::EnvVarsInstanceInfo>& envVarsInstanceInfos) const
 {
-    (void)envVarsInstanceInfos;
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Get override env vars";
+
+    if (auto err = mKVStorage.Get(cOverrideEnvVarsKey, mKVBuffer); !err.IsNone()) {
+        if (err.Is(ErrorEnum::eNotFound)) {
+            return ErrorEnum::eNone;
+        }
+
+        return AOS_ERROR_WRAP(err);
+    }
+
+    size_t offset = 0;
+
+    auto read = [this, &offset](void* data, size_t size) -> Error {
+        if (offset + size > mKVBuffer.Size()) {
+            return AOS_ERROR_WRAP(ErrorEnum::eRuntime);
+        }
+
+        memcpy(data, mKVBuffer.Get() + offset, size);
+        offset += size;
+
+        return ErrorEnum::eNone;
+    };
+
+    while (offset < mKVBuffer.Size()) {
+        Storage::EnvVarsInstanceInfo storageInstanceInfo;
+
+        if (auto err = read(&storageInstanceInfo, sizeof(storageInstanceInfo)); !err.IsNone()) {
+            return err;
+        }
+
+        if (auto err = envVarsInstanceInfos.EmplaceBack(); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        auto& instanceInfo = envVarsInstanceInfos.Back();
+
+        if (storageInstanceInfo.mHasServiceID) {
+            instanceInfo.mFilter.mServiceID.EmplaceValue();
+            instanceInfo.mFilter.mServiceID.GetValue() = storageInstanceInfo.mServiceID;
+        }
+
+        if (storageInstanceInfo.mHasSubjectID) {
+            instanceInfo.mFilter.mSubjectID.EmplaceValue();
+            instanceInfo.mFilter.mSubjectID.GetValue() = storageInstanceInfo.mSubjectID;
+        }
+
+        if (storageInstanceInfo.mHasInstance) {
+            instanceInfo.mFilter.mInstance.SetValue(storageInstanceInfo.mInstance);
+        }
+
+        for (uint32_t i = 0; i < storageInstanceInfo.mNumVariables; i++) {
+            Storage::EnvVarInfo storageEnvVar;
+
+            if (auto err = read(&storageEnvVar, sizeof(storageEnvVar)); !err.IsNone()) {
+                return err;
+            }
+
+            if (auto err = instanceInfo.mVariables.EmplaceBack(); !err.IsNone()) {
+                return AOS_ERROR_WRAP(err);
+            }
+
+            auto& envVar = instanceInfo.mVariables.Back();
+
+            envVar.mName  = storageEnvVar.mName;
+            envVar.mValue = storageEnvVar.mValue;
+
+            if (storageEnvVar.mHasTTL) {
+                envVar.mTTL.SetValue(Time::Unix(storageEnvVar.mTTL.tv_sec, storageEnvVar.mTTL.tv_nsec));
+            }
+        }
+    }
 
     return ErrorEnum::eNone;
 }
 
 Error Storage::SetOverrideEnvVars(const Array<cloudprotocol::EnvVarsInstanceInfo>& envVarsInstanceInfos)
 {
-    (void)envVarsInstanceInfos;
+    LockGuard lock(mMutex);
 
-    return ErrorEnum::eNone;
-};
+    LOG_DBG() << "Set override env vars: count=" << envVarsInstanceInfos.Size();
+
+    mKVBuffer.Clear();
+
+    auto write = [this](const void* data, size_t size) -> Error {
+        auto offset = mKVBuffer.Size();
+
+        if (auto err = mKVBuffer.Resize(offset + size); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        memcpy(mKVBuffer.Get() + offset, data, size);
+
+        return ErrorEnum::eNone;
+    };
+
+    for (const auto& instanceInfo : envVarsInstanceInfos) {
+        Storage::EnvVarsInstanceInfo storageInstanceInfo {};
+
+        storageInstanceInfo.mHasServiceID = instanceInfo.mFilter.mServiceID.HasValue();
+        storageInstanceInfo.mHasSubjectID = instanceInfo.mFilter.mSubjectID.HasValue();
+        storageInstanceInfo.mHasInstance  = instanceInfo.mFilter.mInstance.HasValue();
+        storageInstanceInfo.mNumVariables = instanceInfo.mVariables.Size();
+
+        if (storageInstanceInfo.mHasServiceID) {
+            strcpy(storageInstanceInfo.mServiceID, instanceInfo.mFilter.mServiceID.GetValue().CStr());
+        }
+
+        if (storageInstanceInfo.mHasSubjectID) {
+            strcpy(storageInstanceInfo.mSubjectID, instanceInfo.mFilter.mSubjectID.GetValue().CStr());
+        }
+
+        if (storageInstanceInfo.mHasInstance) {
+            storageInstanceInfo.mInstance = instanceInfo.mFilter.mInstance.GetValue();
+        }
+
+        if (auto err = write(&storageInstanceInfo, sizeof(storageInstanceInfo)); !err.IsNone()) {
+            return err;
+        }
+
+        for (const auto& envVar : instanceInfo.mVariables) {
+            Storage::EnvVarInfo storageEnvVar {};
+
+            strcpy(storageEnvVar.mName, envVar.mName.CStr());
+            strcpy(storageEnvVar.mValue, envVar.mValue.CStr());
+
+            storageEnvVar.mHasTTL = envVar.mTTL.HasValue();
+
+            if (storageEnvVar.mHasTTL) {
+                storageEnvVar.mTTL = envVar.mTTL.GetValue().UnixTime();
+            }
+
+            if (auto err = write(&storageEnvVar, sizeof(storageEnvVar)); !err.IsNone()) {
+                return err;
+            }
+        }
+    }
+
+    return mKVStorage.Set(cOverrideEnvVarsKey, mKVBuffer);
+}
 
 RetWithError<Time> Storage::GetOnlineTime() const
 {
-    return Time::Now();
+    LockGuard lock(mMutex);
+
+    LOG_DBG() << "Get online time";
+
+    timespec onlineTime {};
+
+    if (auto err = GetKVValue(cOnlineTimeKey, &onlineTime, sizeof(onlineTime)); !err.IsNone()) {
+        if (err.Is(ErrorEnum::eNotFound)) {
+            return Time::Now();
+        }
+
+        return {Time::Now(), err};
+    }
+
+    return Time::Unix(onlineTime.tv_sec, onlineTime.tv_nsec);
 }
 
 Error Storage::SetOnlineTime(const Time& time)
 {
-    (void)time;
+    LockGuard lock(mMutex);
 
-    return ErrorEnum::eNone;
+    LOG_DBG() << "Set online time: time=" << time;
+
+    auto onlineTime = time.UnixTime();
+
+    return SetKVValue(cOnlineTimeKey, &onlineTime, sizeof(onlineTime));
 }
 
 Error Storage::AddService(const sm::servicemanager::ServiceData& service)
@@ -152,6 +398,8 @@ Error Storage::AddService(const sm::servicemanager::ServiceData& service)
 
     LOG_DBG() << "Add service: id=" << service.mServiceID << ", version=" << service.mVersion;
 
+    mServiceCache.Invalidate();
+
     auto storageService = ConvertServiceData(service);
 
     return mServiceDatabase.Add(
@@ -167,22 +415,17 @@ Error Storage::GetServiceVersions(const String& serviceID, Array<sm::servicemana
 
     LOG_DBG() << "Get service versions: id=" << serviceID;
 
-    return mServiceDatabase.ReadRecords(
-        [&services, &serviceID, this](const Storage::ServiceData& storageService) -> Error {
-            if (storageService.mServiceID != serviceID) {
-                return ErrorEnum::eNone;
-            }
-
-            if (auto err = services.EmplaceBack(); !err.IsNone()) {
-                return AOS_ERROR_WRAP(err);
-            }
+    return ReadServices([&services, &serviceID](const sm::servicemanager::ServiceData& service) -> Error {
+        if (service.mServiceID != serviceID) {
+            return ErrorEnum::eNone;
+        }
 
-            if (auto err = ConvertServiceData(storageService, services.Back()); !err.IsNone()) {
-                return AOS_ERROR_WRAP(err);
-            }
+        if (auto err = services.PushBack(service); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
 
-            return ErrorEnum::eNone;
-        });
+        return ErrorEnum::eNone;
+    });
 }
 
 Error Storage::UpdateService(const sm::servicemanager::ServiceData& service)
@@ -192,6 +435,8 @@ Error Storage::UpdateService(const sm::servicemanager::ServiceData& service)
     LOG_DBG() << "Update service: id=" << service.mServiceID << ", version=" << service.mVersion
               << ", state=" << service.mState;
 
+    mServiceCache.Invalidate();
+
     auto storageService = ConvertServiceData(service);
 
     return mServiceDatabase.Update(*storageService, [&service](const Storage::ServiceData& data) {
@@ -205,6 +450,8 @@ Error Storage::RemoveService(const String& serviceID, const String& version)
 
     LOG_DBG() << "Remove service: id=" << serviceID << ", version=" << version;
 
+    mServiceCache.Invalidate();
+
     return mServiceDatabase.Remove([&serviceID, &version](const Storage::ServiceData& data) {
         return data.mServiceID == serviceID && data.mVersion == version;
     });
@@ -216,12 +463,8 @@ Error Storage::GetAllServices(Array<sm::servicemanager::ServiceData>& services)
 
     LOG_DBG() << "Get all services";
 
-    return mServiceDatabase.ReadRecords([&services, this](const Storage::ServiceData& storageData) -> Error {
-        if (auto err = services.EmplaceBack(); !err.IsNone()) {
-            return AOS_ERROR_WRAP(err);
-        }
-
-        if (auto err = ConvertServiceData(storageData, services.Back()); !err.IsNone()) {
+    return ReadServices([&services](const sm::servicemanager::ServiceData& service) -> Error {
+        if (auto err = services.PushBack(service); !err.IsNone()) {
             return AOS_ERROR_WRAP(err);
         }
 
@@ -235,6 +478,8 @@ Error Storage::AddLayer(const sm::layermanager::LayerData& layer)
 
     LOG_DBG() << "Add layer: digest=" << layer.mLayerDigest;
 
+    mLayerCache.Invalidate();
+
     auto storageLayer = ConvertLayerData(layer);
 
     return mLayerDatabase.Add(
@@ -249,6 +494,8 @@ Error Storage::RemoveLayer(const String& digest)
 
     LOG_DBG() << "Remove layer: digest=" << digest;
 
+    mLayerCache.Invalidate();
+
     return mLayerDatabase.Remove([&digest](const Storage::LayerData& data) { return data.mLayerDigest == digest; });
 }
 
@@ -258,19 +505,13 @@ Error Storage::GetAllLayers(Array<sm::layermanager::LayerData>& layers) const
 
     LOG_DBG() << "Get all layers";
 
-    return mLayerDatabase.ReadRecords([&layers, this](const Storage::LayerData& storageLayer) -> Error {
-        if (auto err = layers.EmplaceBack(); !err.IsNone()) {
-            return AOS_ERROR_WRAP(err);
-        }
-
-        if (auto err = ConvertLayerData(storageLayer, layers.Back()); !err.IsNone()) {
+    return ReadLayers([&layers](const sm::layermanager::LayerData& layer) -> Error {
+        if (auto err = layers.PushBack(layer); !err.IsNone()) {
             return AOS_ERROR_WRAP(err);
         }
 
         return ErrorEnum::eNone;
     });
-
-    return ErrorEnum::eNone;
 }
 
 Error Storage::GetLayer(const String& digest, sm::layermanager::LayerData& layer) const
@@ -279,6 +520,21 @@ Error Storage::GetLayer(const String& digest, sm::layermanager::LayerData& layer
 
     LOG_DBG() << "Get layer: digest=" << digest;
 
+    if (auto [cachedLayer, err] = mLayerCache.Find([this](auto add) { return LoadLayers(add); },
+            [&digest](const sm::layermanager::LayerData& data) { return data.mLayerDigest == digest; });
+        err.IsNone()) {
+        if (cachedLayer == nullptr) {
+            return AOS_ERROR_WRAP(ErrorEnum::eNotFound);
+        }
+
+        layer = *cachedLayer;
+
+        return ErrorEnum::eNone;
+    }
+
+    // Cache is disabled or the table doesn't fit into it: stop on the first match instead of loading and converting the
+    // whole table.
+
     auto storageLayer = MakeUnique<Storage::LayerData>(&mAllocator);
 
     if (auto err = mLayerDatabase.ReadRecordByFilter(
@@ -300,6 +556,8 @@ Error Storage::UpdateLayer(const sm::layermanager::LayerData& layer)
 
     LOG_DBG() << "Update layer: digest=" << layer.mLayerDigest;
 
+    mLayerCache.Invalidate();
+
     auto storageLayer = ConvertLayerData(layer);
 
     return mLayerDatabase.Update(
@@ -312,6 +570,8 @@ Error Storage::AddCertInfo(const String& certType, const iam::certhandler::CertI
 
     LOG_DBG() << "Add cert info: " << certType;
 
+    mCertCache.Invalidate();
+
     auto storageCertInfo = ConvertCertInfo(certType, certInfo);
 
     return mCertDatabase.Add(*storageCertInfo,
@@ -330,6 +590,8 @@ Error Storage::RemoveCertInfo(const String& certType, const String& certURL)
 
     LOG_DBG() << "Remove cert info: " << certType;
 
+    mCertCache.Invalidate();
+
     return mCertDatabase.Remove([&certType, &certURL](const Storage::CertInfo& data) {
         return data.mCertType == certType && data.mCertURL == certURL;
     });
@@ -341,6 +603,8 @@ Error Storage::RemoveAllCertsInfo(const String& certType)
 
     LOG_DBG() << "Remove all cert info: " << certType;
 
+    mCertCache.Invalidate();
+
     auto err = mCertDatabase.Remove([&certType](const Storage::CertInfo& data) { return data.mCertType == certType; });
     if (!err.IsNone() && !err.Is(ErrorEnum::eNotFound)) {
         return err;
@@ -355,20 +619,15 @@ Error Storage::GetCertsInfo(const String& certType, Array<iam::certhandler::Cert
 
     LOG_DBG() << "Get cert info: " << certType;
 
-    auto err = mCertDatabase.ReadRecords([&certsInfo, &certType, this](const Storage::CertInfo& certInfo) -> Error {
+    return ReadCerts([&certsInfo, &certType](const CachedCertInfo& certInfo) -> Error {
         if (certInfo.mCertType == certType) {
-            auto cert = ConvertCertInfo(certInfo);
-
-            auto err = certsInfo.PushBack(*cert);
-            if (!err.IsNone()) {
+            if (auto err = certsInfo.PushBack(certInfo.mCertInfo); !err.IsNone()) {
                 return AOS_ERROR_WRAP(err);
             }
         }
 
         return ErrorEnum::eNone;
     });
-
-    return err;
 }
 
 Error Storage::GetCertInfo(const Array<uint8_t>& issuer, const Array<uint8_t>& serial, iam::certhandler::CertInfo& cert)
@@ -377,6 +636,20 @@ Error Storage::GetCertInfo(const Array<uint8_t>& issuer, const Array<uint8_t>& s
 
     LOG_DBG() << "Get cert info by issuer and serial";
 
+    if (auto [cachedCertInfo, err] = mCertCache.Find([this](auto add) { return LoadCerts(add); },
+            [&issuer, &serial](const CachedCertInfo& certInfo) {
+                return certInfo.mCertInfo.mIssuer == issuer && certInfo.mCertInfo.mSerial == serial;
+            });
+        err.IsNone()) {
+        if (cachedCertInfo == nullptr) {
+            return ErrorEnum::eNotFound;
+        }
+
+        cert = cachedCertInfo->mCertInfo;
+
+        return ErrorEnum::eNone;
+    }
+
     UniquePtr<Storage::CertInfo> certInfo = MakeUnique<Storage::CertInfo>(&mAllocator);
 
     auto err = mCertDatabase.ReadRecordByFilter(*certInfo, [&issuer, &serial](const Storage::CertInfo& data) {
@@ -397,10 +670,101 @@ Error Storage::GetCertInfo(const Array<uint8_t>& issuer, const Array<uint8_t>& s
     return ErrorEnum::eNone;
 }
 
+size_t Storage::GetCacheHits() const
+{
+    LockGuard lock(mMutex);
+
+    return mServiceCache.GetHits() + mLayerCache.GetHits() + mCertCache.GetHits();
+}
+
+size_t Storage::GetCacheMisses() const
+{
+    LockGuard lock(mMutex);
+
+    return mServiceCache.GetMisses() + mLayerCache.GetMisses() + mCertCache.GetMisses();
+}
+
 /***********************************************************************************************************************
  * Private
  **********************************************************************************************************************/
 
+template <typename F>
+Error Storage::ReadServices(F handler)
+{
+    return mServiceCache.Read(
+        [this](auto add) {
+            return mServiceDatabase.ReadRecords([this, &add](const Storage::ServiceData& storageService) -> Error {
+                auto service = MakeUnique<sm::servicemanager::ServiceData>(&mAllocator);
+
+                if (auto err = ConvertServiceData(storageService, *service); !err.IsNone()) {
+                    return AOS_ERROR_WRAP(err);
+                }
+
+                return add(*service);
+            });
+        },
+        handler);
+}
+
+template <typename F>
+Error Storage::ReadLayers(F handler) const
+{
+    return mLayerCache.Read([this](auto add) { return LoadLayers(add); }, handler);
+}
+
+template <typename F>
+Error Storage::LoadLayers(F add) const
+{
+    return mLayerDatabase.ReadRecords([this, &add](const Storage::LayerData& storageLayer) -> Error {
+        auto layer = MakeUnique<sm::layermanager::LayerData>(&mAllocator);
+
+        if (auto err = ConvertLayerData(storageLayer, *layer); !err.IsNone()) {
+            return AOS_ERROR_WRAP(err);
+        }
+
+        return add(*layer);
+    });
+}
+
+template <typename F>
+Error Storage::ReadCerts(F handler)
+{
+    return mCertCache.Read([this](auto add) { return LoadCerts(add); }, handler);
+}
+
+template <typename F>
+Error Storage::LoadCerts(F add)
+{
+    return mCertDatabase.ReadRecords([this, &add](const Storage::CertInfo& storageCertInfo) -> Error {
+        auto certInfo = MakeUnique<CachedCertInfo>(&mAllocator);
+
+        certInfo->mCertType = storageCertInfo.mCertType;
+        certInfo->mCertInfo = *ConvertCertInfo(storageCertInfo);
+
+        return add(*certInfo);
+    });
+}
+
+Error Storage::SetKVValue(uint32_t key, const void* data, size_t size)
+{
+    return mKVStorage.Set(key, Array<uint8_t>(static_cast<const uint8_t*>(data), size));
+}
+
+Error Storage::GetKVValue(uint32_t key, void* data, size_t size) const
+{
+    Array<uint8_t> value(static_cast<uint8_t*>(data), size);
+
+    if (auto err = mKVStorage.Get(key, value); !err.IsNone()) {
+        return err;
+    }
+
+    if (value.Size() != size) {
+        return AOS_ERROR_WRAP(ErrorEnum::eRuntime);
+    }
+
+    return ErrorEnum::eNone;
+}
+
 UniquePtr<Storage::InstanceData> Storage::ConvertInstanceData(const sm::launcher::InstanceData& instance)
 {
     auto instanceInfo = MakeUnique<Storage::InstanceData>(&mAllocator);
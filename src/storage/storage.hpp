@@ -15,6 +15,8 @@
 #include <aos/sm/servicemanager.hpp>
 
 #include "filestorage.hpp"
+#include "kvstorage.hpp"
+#include "objectcache.hpp"
 
 namespace aos::zephyr::storage {
 
@@ -57,6 +59,30 @@ public:
      */
     Error RemoveInstance(const String& instanceID) override;
 
+    /**
+     * Adds new instances to storage with single database scan.
+     *
+     * @param instances instances to add.
+     * @return Error.
+     */
+    Error AddInstances(const Array<sm::launcher::InstanceData>& instances);
+
+    /**
+     * Updates previously stored instances with single database scan.
+     *
+     * @param instances instances to update.
+     * @return Error.
+     */
+    Error UpdateInstances(const Array<sm::launcher::InstanceData>& instances);
+
+    /**
+     * Removes previously stored instances with single database scan.
+     *
+     * @param instanceIDs instance IDs to remove.
+     * @return Error.
+     */
+    Error RemoveInstances(const Array<StaticString<cInstanceIDLen>>& instanceIDs);
+
     /**
      * Returns all stored instances.
      *
@@ -240,8 +266,29 @@ public:
      */
     Error RemoveAllCertsInfo(const String& certType) override;
 
+    /**
+     * Returns number of object cache hits.
+     *
+     * @return size_t.
+     */
+    size_t GetCacheHits() const;
+
+    /**
+     * Returns number of object cache misses.
+     *
+     * @return size_t.
+     */
+    size_t GetCacheMisses() const;
+
 private:
-    constexpr static auto cStoragePath = CONFIG_AOS_STORAGE_DIR;
+    constexpr static auto     cStoragePath         = CONFIG_AOS_STORAGE_DIR;
+    constexpr static auto     cKVMaxValueSize      = CONFIG_AOS_STORAGE_KV_MAX_VALUE_SIZE;
+    constexpr static auto     cServiceCacheSize    = CONFIG_AOS_STORAGE_CACHE_NUM_SERVICES;
+    constexpr static auto     cLayerCacheSize      = CONFIG_AOS_STORAGE_CACHE_NUM_LAYERS;
+    constexpr static auto     cCertCacheSize       = CONFIG_AOS_STORAGE_CACHE_NUM_CERTS;
+    constexpr static uint32_t cOperationVersionKey = 1;
+    constexpr static uint32_t cOnlineTimeKey       = 2;
+    constexpr static uint32_t cOverrideEnvVarsKey  = 3;
 
     struct InstanceIdent {
         char     mServiceID[cServiceIDLen + 1];
@@ -364,6 +411,42 @@ private:
         }
     };
 
+    struct EnvVarsInstanceInfo {
+        char     mServiceID[cServiceIDLen + 1];
+        char     mSubjectID[cSubjectIDLen + 1];
+        uint64_t mInstance;
+        bool     mHasServiceID;
+        bool     mHasSubjectID;
+        bool     mHasInstance;
+        uint32_t mNumVariables;
+    };
+
+    struct EnvVarInfo {
+        char     mName[cEnvVarNameLen + 1];
+        char     mValue[cEnvVarValueLen + 1];
+        timespec mTTL;
+        bool     mHasTTL;
+    };
+
+    struct CachedCertInfo {
+        StaticString<iam::certhandler::cCertTypeLen> mCertType;
+        iam::certhandler::CertInfo                   mCertInfo;
+    };
+
+    template <typename F>
+    Error ReadServices(F handler);
+    template <typename F>
+    Error ReadLayers(F handler) const;
+    template <typename F>
+    Error LoadLayers(F add) const;
+    template <typename F>
+    Error ReadCerts(F handler);
+    template <typename F>
+    Error LoadCerts(F add);
+
+    Error SetKVValue(uint32_t key, const void* data, size_t size);
+    Error GetKVValue(uint32_t key, void* data, size_t size) const;
+
     UniquePtr<Storage::InstanceData> ConvertInstanceData(const sm::launcher::InstanceData& instance);
     Error ConvertInstanceData(const Storage::InstanceData& dbInstance, sm::launcher::InstanceData& outInstance);
     UniquePtr<Storage::ServiceData> ConvertServiceData(const sm::servicemanager::ServiceData& service);
@@ -373,17 +456,22 @@ private:
     UniquePtr<Storage::CertInfo> ConvertCertInfo(const String& certType, const iam::certhandler::CertInfo& certInfo);
     UniquePtr<iam::certhandler::CertInfo> ConvertCertInfo(const Storage::CertInfo& certInfo);
 
-    FileStorage<Storage::InstanceData>      mInstanceDatabase;
-    FileStorage<Storage::ServiceData>       mServiceDatabase;
-    mutable FileStorage<Storage::LayerData> mLayerDatabase;
-    FileStorage<Storage::CertInfo>          mCertDatabase;
-    mutable Mutex                           mMutex;
+    FileStorage<Storage::InstanceData>                                mInstanceDatabase;
+    FileStorage<Storage::ServiceData>                                 mServiceDatabase;
+    mutable FileStorage<Storage::LayerData>                           mLayerDatabase;
+    FileStorage<Storage::CertInfo>                                    mCertDatabase;
+    mutable KVStorage                                                 mKVStorage;
+    ObjectCache<sm::servicemanager::ServiceData, cServiceCacheSize>   mServiceCache;
+    mutable ObjectCache<sm::layermanager::LayerData, cLayerCacheSize> mLayerCache;
+    ObjectCache<CachedCertInfo, cCertCacheSize>                       mCertCache;
+    mutable StaticArray<uint8_t, cKVMaxValueSize>                     mKVBuffer;
+    mutable Mutex                                                     mMutex;
 
     mutable StaticAllocator<Max(sizeof(Storage::InstanceData), sizeof(sm::launcher::InstanceData),
                                 sizeof(Storage::LayerData))
         + Max(sizeof(Storage::ServiceData), sizeof(sm::servicemanager::ServiceData))
         + Max(sizeof(Storage::LayerData), sizeof(sm::layermanager::LayerData))
-        + Max(sizeof(Storage::CertInfo), sizeof(iam::certhandler::CertInfo))>
+        + Max(sizeof(Storage::CertInfo), sizeof(iam::certhandler::CertInfo)) + sizeof(CachedCertInfo)>
         mAllocator;
 };
 
@@ -5,12 +5,67 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <mbedtls/sha256.h>
 
+#include <aos/common/tools/fs.hpp>
+
 #include "checksum.hpp"
 
 namespace aos::zephyr::utils {
 
+namespace {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+constexpr char cDigestPrefix[]   = "sha256:";
+constexpr auto cDigestLen        = sizeof(cDigestPrefix) - 1 + cSHA256Size * 2;
+constexpr auto cDigestFileSuffix = ".sha256";
+constexpr auto cReadBlockSize    = 512;
+
+RetWithError<StaticString<cDigestLen>> FormatDigest(const Array<uint8_t>& digest)
+{
+    StaticString<cSHA256Size * 2> hex;
+
+    if (auto err = hex.ByteArrayToHex(digest); !err.IsNone()) {
+        return {{}, AOS_ERROR_WRAP(err)};
+    }
+
+    StaticString<cDigestLen> digestStr {cDigestPrefix};
+
+    digestStr.Append(hex);
+
+    return digestStr;
+}
+
+Error HashFile(int fd, Sha256Calculator& calculator)
+{
+    uint8_t buffer[cReadBlockSize];
+
+    while (true) {
+        auto ret = read(fd, buffer, sizeof(buffer));
+        if (ret < 0) {
+            return AOS_ERROR_WRAP(errno);
+        }
+
+        if (ret == 0) {
+            return ErrorEnum::eNone;
+        }
+
+        if (auto err = calculator.Update(buffer, ret); !err.IsNone()) {
+            return err;
+        }
+    }
+}
+
+} // namespace
+
 /***********************************************************************************************************************
  * Public
  **********************************************************************************************************************/
@@ -54,4 +109,151 @@ RetWithError<StaticArray<uint8_t, cSHA256Size>> CalculateSha256(const Array<uint
     return digest;
 }
 
+Sha256Calculator::~Sha256Calculator()
+{
+    Reset();
+}
+
+Error Sha256Calculator::Start()
+{
+    static_assert(sizeof(mbedtls_sha256_context) <= cContextSize, "SHA-256 context storage is too small");
+
+    auto ctx = reinterpret_cast<mbedtls_sha256_context*>(mContext);
+
+    Reset();
+
+    mbedtls_sha256_init(ctx);
+
+    if (auto ret = mbedtls_sha256_starts(ctx, 0); ret != 0) {
+        mbedtls_sha256_free(ctx);
+
+        return AOS_ERROR_WRAP(ret);
+    }
+
+    mStarted = true;
+
+    return ErrorEnum::eNone;
+}
+
+Error Sha256Calculator::Update(const void* data, size_t size)
+{
+    if (!mStarted) {
+        return AOS_ERROR_WRAP(ErrorEnum::eWrongState);
+    }
+
+    auto ret = mbedtls_sha256_update(
+        reinterpret_cast<mbedtls_sha256_context*>(mContext), static_cast<const uint8_t*>(data), size);
+    if (ret != 0) {
+        return AOS_ERROR_WRAP(ret);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+RetWithError<StaticArray<uint8_t, cSHA256Size>> Sha256Calculator::Finish()
+{
+    StaticArray<uint8_t, cSHA256Size> digest;
+
+    digest.Resize(cSHA256Size);
+
+    if (!mStarted) {
+        return {digest, AOS_ERROR_WRAP(ErrorEnum::eWrongState)};
+    }
+
+    auto ret = mbedtls_sha256_finish(
+        reinterpret_cast<mbedtls_sha256_context*>(mContext), static_cast<uint8_t*>(digest.Get()));
+
+    Reset();
+
+    if (ret != 0) {
+        return {digest, AOS_ERROR_WRAP(ret)};
+    }
+
+    return digest;
+}
+
+void Sha256Calculator::Reset()
+{
+    if (!mStarted) {
+        return;
+    }
+
+    mbedtls_sha256_free(reinterpret_cast<mbedtls_sha256_context*>(mContext));
+
+    mStarted = false;
+}
+
+Error WriteSha256Digest(const String& path, const Array<uint8_t>& digest)
+{
+    auto [digestStr, err] = FormatDigest(digest);
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    if (err = fs::WriteStringToFile(GetSha256DigestPath(path), digestStr, S_IRUSR | S_IWUSR); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error ReadSha256Digest(const String& path, String& digest)
+{
+    if (auto err = fs::ReadFileToString(GetSha256DigestPath(path), digest); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    if (digest.Size() != cDigestLen || strncmp(digest.CStr(), cDigestPrefix, sizeof(cDigestPrefix) - 1) != 0) {
+        return AOS_ERROR_WRAP(Error(ErrorEnum::eInvalidChecksum, "invalid digest record"));
+    }
+
+    return ErrorEnum::eNone;
+}
+
+Error CalculateSha256Digest(const String& path, String& digest)
+{
+    Sha256Calculator calculator;
+
+    auto fd = open(path.CStr(), O_RDONLY);
+    if (fd < 0) {
+        return AOS_ERROR_WRAP(errno);
+    }
+
+    auto err = calculator.Start();
+    if (err.IsNone()) {
+        err = HashFile(fd, calculator);
+    }
+
+    close(fd);
+
+    if (!err.IsNone()) {
+        return err;
+    }
+
+    auto [sha256, finishErr] = calculator.Finish();
+    if (!finishErr.IsNone()) {
+        return finishErr;
+    }
+
+    auto [digestStr, formatErr] = FormatDigest(sha256);
+    if (!formatErr.IsNone()) {
+        return formatErr;
+    }
+
+    if (err = digest.Assign(digestStr); !err.IsNone()) {
+        return AOS_ERROR_WRAP(err);
+    }
+
+    return ErrorEnum::eNone;
+}
+
+StaticString<cFilePathLen> GetSha256DigestPath(const String& path)
+{
+    StaticString<cFilePathLen> digestPath {path};
+
+    digestPath.Append(cDigestFileSuffix);
+
+    return digestPath;
+}
+
 } // namespace aos::zephyr::utils
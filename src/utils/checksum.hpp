@@ -8,6 +8,7 @@
 #ifndef CHECKSUM_HPP_
 #define CHECKSUM_HPP_
 
+#include <aos/common/tools/noncopyable.hpp>
 #include <aos/common/types.hpp>
 
 namespace aos::zephyr::utils {
@@ -20,6 +21,89 @@ namespace aos::zephyr::utils {
  */
 RetWithError<StaticArray<uint8_t, cSHA256Size>> CalculateSha256(const Array<uint8_t>& data);
 
+/**
+ * Incremental SHA-256 calculator.
+ *
+ * Keeps mbedtls context in opaque storage, so users of the header don't depend on mbedtls. The context is owned by the
+ * calculator: it is freed when the calculation is finished, reset or restarted and when the calculator is destroyed.
+ */
+class Sha256Calculator : private NonCopyable {
+public:
+    /**
+     * Destroys SHA-256 calculator.
+     */
+    ~Sha256Calculator();
+
+    /**
+     * Starts SHA-256 calculation.
+     *
+     * @return Error.
+     */
+    Error Start();
+
+    /**
+     * Updates SHA-256 with data.
+     *
+     * @param data[in] data.
+     * @param size[in] data size.
+     * @return Error.
+     */
+    Error Update(const void* data, size_t size);
+
+    /**
+     * Finishes SHA-256 calculation.
+     *
+     * @return RetWithError<aos::StaticArray<aos::cSHA256Size>>.
+     */
+    RetWithError<StaticArray<uint8_t, cSHA256Size>> Finish();
+
+    /**
+     * Resets started SHA-256 calculation.
+     */
+    void Reset();
+
+private:
+    static constexpr auto cContextSize = 128;
+
+    bool               mStarted = false;
+    alignas(8) uint8_t mContext[cContextSize] {};
+};
+
+/**
+ * Writes SHA-256 digest record of the file.
+ *
+ * @param path[in] file path.
+ * @param digest[in] SHA-256 digest.
+ * @return Error.
+ */
+Error WriteSha256Digest(const String& path, const Array<uint8_t>& digest);
+
+/**
+ * Reads SHA-256 digest record of the file.
+ *
+ * @param path[in] file path.
+ * @param digest[out] digest in "sha256:<hex>" format.
+ * @return Error.
+ */
+Error ReadSha256Digest(const String& path, String& digest);
+
+/**
+ * Calculates SHA-256 digest of the file content.
+ *
+ * @param path[in] file path.
+ * @param digest[out] digest in "sha256:<hex>" format.
+ * @return Error.
+ */
+Error CalculateSha256Digest(const String& path, String& digest);
+
+/**
+ * Returns path of SHA-256 digest record of the file.
+ *
+ * @param path[in] file path.
+ * @return StaticString<cFilePathLen>.
+ */
+StaticString<cFilePathLen> GetSha256DigestPath(const String& path);
+
 } // namespace aos::zephyr::utils
 
 #endif
@@ -9,23 +9,69 @@
 #include <zephyr/tc_util.h>
 #include <zephyr/ztest.h>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <memory>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <aos/common/tools/log.hpp>
 #include <aos/common/tools/timer.hpp>
+#include <aos/common/tools/utils.hpp>
 
 #include "downloader/downloader.hpp"
+#include "utils/checksum.hpp"
 #include "utils/log.hpp"
 
+/***********************************************************************************************************************
+ * Syscall wrappers
+ **********************************************************************************************************************/
+
+// The write syscall is wrapped by the linker (see CMakeLists.txt) to count file writes, writes which don't cover
+// whole write blocks and writes of the resent data.
+
+constexpr auto cWriteBlockSize = CONFIG_AOS_DOWNLOADER_WRITE_BLOCK_SIZE;
+constexpr auto cResentData     = "xx";
+
+static size_t sNumFileWrites    = 0;
+static size_t sNumPartialWrites = 0;
+static size_t sNumResentWrites  = 0;
+
+extern "C" {
+
+ssize_t __real_write(int fd, const void* buffer, size_t count);
+
+ssize_t __wrap_write(int fd, const void* buffer, size_t count)
+{
+    if (fd > STDERR_FILENO) {
+        auto offset = lseek(fd, 0, SEEK_CUR);
+
+        if (offset % cWriteBlockSize != 0 || count % cWriteBlockSize != 0) {
+            sNumPartialWrites++;
+        }
+
+        auto data = static_cast<const char*>(buffer);
+
+        if (std::search(data, data + count, cResentData, cResentData + strlen(cResentData)) != data + count) {
+            sNumResentWrites++;
+        }
+
+        sNumFileWrites++;
+    }
+
+    return __real_write(fd, buffer, count);
+}
+}
+
 using namespace aos::zephyr;
 
 constexpr auto cDownloadPath = "download";
 constexpr auto cFileName     = "test.txt";
 constexpr auto cDownloadUrl  = "http://www.example.com";
 constexpr auto cData         = "file content";
+constexpr auto cDigestA      = "sha256:84d89877f0d4041efb6bf91a16f0248f2fd573e6af05c19f96bedb9f882f7882";
+constexpr auto cDigestB      = "sha256:bef57ec7f53a6d40beb640a780a639c83bc29ac8a9816f1fc6c5c6dcd93c4721";
 
 static downloader::Downloader sDownloader;
 
@@ -51,6 +97,128 @@ void sendImageContentInfo(void*)
 
 static aos::Timer timerReceive {};
 
+struct TestChunk {
+    const char* mRelativePath;
+    uint64_t    mPartsCount;
+    uint64_t    mPart;
+    const char* mData;
+    bool        mInvalid;
+};
+
+// Chunks are interleaved, out of order and contain a duplicate. Tests keep one file open at once, so the files are
+// closed and reopened between their chunks.
+static const TestChunk cInterleavedChunks[] = {
+    {"a.bin", 3, 3, "89"},
+    {"dir/b.bin", 2, 2, "ef"},
+    {"a.bin", 3, 1, "0123"},
+    {"dir/b.bin", 2, 1, "abcd"},
+    {"dir/b.bin", 2, 1, "abcd"},
+    {"a.bin", 3, 2, "4567"},
+};
+
+// Download is interrupted by invalid chunk after two parts of the file are received.
+static const TestChunk cInterruptedChunks[] = {
+    {"a.bin", 3, 3, "89"},
+    {"a.bin", 3, 1, "0123"},
+    {"a.bin", 3, 4, "xx", true},
+};
+
+// Already received parts are resent with different data to check that they are not written again. Resent data is
+// detected by the write wrapper.
+static const TestChunk cResumedChunks[] = {
+    {"a.bin", 3, 1, "xxxx"},
+    {"a.bin", 3, 2, "4567"},
+    {"a.bin", 3, 3, "xx"},
+    {"dir/b.bin", 2, 1, "abcd"},
+    {"dir/b.bin", 2, 2, "ef"},
+};
+
+// Checksum of the file is wrong, so the last chunk of the file fails.
+static const TestChunk cWrongChecksumChunks[] = {
+    {"dir/b.bin", 2, 1, "abcd"},
+    {"dir/b.bin", 2, 2, "ef"},
+    {"a.bin", 3, 1, "0123"},
+    {"a.bin", 3, 2, "4567"},
+    {"a.bin", 3, 3, "89", true},
+};
+
+static uint64_t         sChunksRequestID {};
+static const TestChunk* sTestChunks {};
+static size_t           sNumTestChunks {};
+
+static aos::StaticArray<uint8_t, aos::cSHA256Size> sFileSHA256 {};
+
+void sendTestChunks(void*)
+{
+    auto files = std::make_unique<aos::StaticArray<downloader::FileInfo, 32>>();
+
+    files->PushBack(downloader::FileInfo {"a.bin", sFileSHA256, 10});
+    files->PushBack(downloader::FileInfo {"dir/b.bin", {}, 6});
+
+    zassert_equal(sDownloader.ReceiveImageContentInfo(downloader::ImageContentInfo {sChunksRequestID, *files}),
+        aos::ErrorEnum::eNone, "Failed to receive image content info");
+
+    for (size_t i = 0; i < sNumTestChunks; i++) {
+        const auto& testChunk = sTestChunks[i];
+        auto        chunk     = std::make_unique<downloader::FileChunk>();
+
+        chunk->mRequestID    = sChunksRequestID;
+        chunk->mRelativePath = testChunk.mRelativePath;
+        chunk->mPartsCount   = testChunk.mPartsCount;
+        chunk->mPart         = testChunk.mPart;
+
+        chunk->mData.Resize(strlen(testChunk.mData));
+        memcpy(chunk->mData.Get(), testChunk.mData, strlen(testChunk.mData));
+
+        zassert_equal(sDownloader.ReceiveFileChunk(*chunk).IsNone(), !testChunk.mInvalid,
+            "Unexpected file chunk receive result");
+    }
+}
+
+class ChunksDownloadRequester : public downloader::DownloadRequesterItf {
+public:
+    template <size_t cSize>
+    explicit ChunksDownloadRequester(const TestChunk (&chunks)[cSize])
+    {
+        sTestChunks    = chunks;
+        sNumTestChunks = cSize;
+    }
+
+    aos::Error SendImageContentRequest(const downloader::ImageContentRequest& request) override
+    {
+        sChunksRequestID = request.mRequestID;
+
+        timerReceive.Start(aos::Time::cMilliseconds * 100, sendTestChunks);
+
+        return aos::ErrorEnum::eNone;
+    }
+};
+
+static void checkFileContent(const char* relativePath, const char* content)
+{
+    aos::StaticString<aos::cFilePathLen> filePath {aos::fs::JoinPath(cDownloadPath, relativePath)};
+
+    auto file = open(filePath.CStr(), O_RDONLY, 0644);
+    zassert_false(file < 0, "Failed to open file");
+
+    char buffer[32] {};
+
+    auto ret = read(file, buffer, sizeof(buffer));
+    close(file);
+
+    zassert_equal(ret, strlen(content), "Wrong file size: %s", relativePath);
+    zassert_equal(memcmp(buffer, content, strlen(content)), 0, "Wrong file content: %s", relativePath);
+}
+
+static void checkFileDigest(const char* relativePath, const char* digest)
+{
+    aos::StaticString<aos::cFilePathLen> filePath {aos::fs::JoinPath(cDownloadPath, relativePath)};
+    aos::StaticString<80>                fileDigest;
+
+    zassert_equal(utils::ReadSha256Digest(filePath, fileDigest), aos::ErrorEnum::eNone, "Failed to read digest");
+    zassert_equal(fileDigest, digest, "Wrong file digest: %s", relativePath);
+}
+
 class TestDownloadRequester : public downloader::DownloadRequesterItf {
 public:
     TestDownloadRequester(bool skipSendRequest = false)
@@ -85,6 +253,124 @@ private:
     bool mSkipSendRequest;
 };
 
+// Benchmark file is sent in chunks which are not aligned to the write block size.
+constexpr auto cBenchmarkFileName  = "bench.bin";
+constexpr auto cBenchmarkChunkSize = aos::Min<size_t>(1000, aos::cFileChunkSize);
+constexpr auto cBenchmarkNumParts  = 256;
+constexpr auto cBenchmarkFileSize  = cBenchmarkChunkSize * cBenchmarkNumParts;
+
+struct BenchmarkResult {
+    uint64_t mTime;
+    size_t   mNumWrites;
+    size_t   mNumPartialWrites;
+};
+
+static uint64_t        sBenchmarkRequestID {};
+static BenchmarkResult sDownloadResult {};
+
+K_SEM_DEFINE(sBenchmarkDone, 0, 1);
+
+static uint64_t getTimeUs()
+{
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static BenchmarkResult startBenchmark()
+{
+    return BenchmarkResult {getTimeUs(), sNumFileWrites, sNumPartialWrites};
+}
+
+static BenchmarkResult stopBenchmark(const BenchmarkResult& start)
+{
+    return BenchmarkResult {
+        getTimeUs() - start.mTime, sNumFileWrites - start.mNumWrites, sNumPartialWrites - start.mNumPartialWrites};
+}
+
+static void printBenchmark(const char* name, const BenchmarkResult& result)
+{
+    printk("%-16s size=%zu bytes, writes=%zu, partial writes=%zu, total=%llu us, speed=%.2f MB/s\n", name,
+        static_cast<size_t>(cBenchmarkFileSize), result.mNumWrites, result.mNumPartialWrites,
+        static_cast<unsigned long long>(result.mTime),
+        static_cast<double>(cBenchmarkFileSize) / (result.mTime != 0 ? result.mTime : 1));
+}
+
+static void fillBenchmarkChunk(downloader::FileChunk& chunk, uint64_t part)
+{
+    chunk.mRelativePath = cBenchmarkFileName;
+    chunk.mPartsCount   = cBenchmarkNumParts;
+    chunk.mPart         = part;
+
+    chunk.mData.Resize(cBenchmarkChunkSize);
+    memset(chunk.mData.Get(), static_cast<int>(part), cBenchmarkChunkSize);
+}
+
+void sendBenchmarkChunks(void*)
+{
+    auto files = std::make_unique<aos::StaticArray<downloader::FileInfo, 32>>();
+
+    files->PushBack(downloader::FileInfo {cBenchmarkFileName, {}, cBenchmarkFileSize});
+
+    zassert_equal(sDownloader.ReceiveImageContentInfo(downloader::ImageContentInfo {sBenchmarkRequestID, *files}),
+        aos::ErrorEnum::eNone, "Failed to receive image content info");
+
+    auto chunk = std::make_unique<downloader::FileChunk>();
+    auto start = startBenchmark();
+
+    chunk->mRequestID = sBenchmarkRequestID;
+
+    for (uint64_t part = 1; part <= cBenchmarkNumParts; part++) {
+        fillBenchmarkChunk(*chunk, part);
+
+        zassert_equal(sDownloader.ReceiveFileChunk(*chunk), aos::ErrorEnum::eNone, "Failed to receive file chunk");
+    }
+
+    sDownloadResult = stopBenchmark(start);
+
+    k_sem_give(&sBenchmarkDone);
+}
+
+class BenchmarkDownloadRequester : public downloader::DownloadRequesterItf {
+public:
+    aos::Error SendImageContentRequest(const downloader::ImageContentRequest& request) override
+    {
+        sBenchmarkRequestID = request.mRequestID;
+
+        timerReceive.Start(aos::Time::cMilliseconds * 100, sendBenchmarkChunks);
+
+        return aos::ErrorEnum::eNone;
+    }
+};
+
+// Writes each chunk at its offset as the downloader did before the writes were coalesced.
+static BenchmarkResult benchmarkChunkWrites()
+{
+    aos::StaticString<aos::cFilePathLen> filePath {aos::fs::JoinPath(cDownloadPath, cBenchmarkFileName)};
+
+    auto chunk = std::make_unique<downloader::FileChunk>();
+    auto file  = open(filePath.CStr(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    zassert_false(file < 0, "Failed to open file");
+
+    auto start = startBenchmark();
+
+    for (uint64_t part = 1; part <= cBenchmarkNumParts; part++) {
+        fillBenchmarkChunk(*chunk, part);
+
+        zassert_false(lseek(file, (part - 1) * cBenchmarkChunkSize, SEEK_SET) < 0, "Failed to seek file");
+        zassert_equal(
+            write(file, chunk->mData.Get(), chunk->mData.Size()), chunk->mData.Size(), "Failed to write file");
+    }
+
+    auto result = stopBenchmark(start);
+
+    close(file);
+
+    return result;
+}
+
 ZTEST_SUITE(downloader, NULL, NULL, NULL, NULL, NULL);
 
 ZTEST(downloader, test_download_image)
@@ -115,6 +401,83 @@ ZTEST(downloader, test_download_image)
     zassert_equal(memcmp(fileData.Get(), cData, strlen(cData)), 0, "File content is not equal to expected");
 }
 
+ZTEST(downloader, test_download_interleaved_chunks)
+{
+    aos::Log::SetCallback(TestLogCallback);
+
+    ChunksDownloadRequester requester {cInterleavedChunks};
+
+    zassert_equal(sDownloader.Init(requester), aos::ErrorEnum::eNone, "Failed to initialize downloader");
+
+    aos::StaticString<aos::cURLLen>      url {cDownloadUrl};
+    aos::StaticString<aos::cFilePathLen> path {cDownloadPath};
+
+    zassert_equal(sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService),
+        aos::ErrorEnum::eNone, "Failed to download image");
+
+    checkFileContent("a.bin", "0123456789");
+    checkFileContent("dir/b.bin", "abcdef");
+
+    checkFileDigest("a.bin", cDigestA);
+    checkFileDigest("dir/b.bin", cDigestB);
+}
+
+ZTEST(downloader, test_download_wrong_checksum)
+{
+    aos::Log::SetCallback(TestLogCallback);
+
+    ChunksDownloadRequester requester {cWrongChecksumChunks};
+
+    zassert_equal(sDownloader.Init(requester), aos::ErrorEnum::eNone, "Failed to initialize downloader");
+
+    aos::StaticString<aos::cURLLen>      url {cDownloadUrl};
+    aos::StaticString<aos::cFilePathLen> path {cDownloadPath};
+
+    sFileSHA256.Resize(aos::cSHA256Size, 0);
+
+    auto err = sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService);
+
+    sFileSHA256.Clear();
+
+    zassert_equal(err, aos::ErrorEnum::eInvalidChecksum, "Expected invalid checksum error");
+}
+
+ZTEST(downloader, test_resume_download)
+{
+    aos::Log::SetCallback(TestLogCallback);
+
+    aos::StaticString<aos::cURLLen>      url {cDownloadUrl};
+    aos::StaticString<aos::cFilePathLen> path {cDownloadPath};
+    aos::StaticString<aos::cFilePathLen> progressPath {aos::fs::JoinPath(cDownloadPath, "a.bin.parts")};
+
+    ChunksDownloadRequester interruptedRequester {cInterruptedChunks};
+
+    zassert_equal(sDownloader.Init(interruptedRequester), aos::ErrorEnum::eNone, "Failed to initialize downloader");
+
+    zassert_equal(sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService),
+        aos::ErrorEnum::eInvalidArgument, "Expected invalid argument error");
+
+    struct stat st {};
+
+    zassert_equal(stat(progressPath.CStr(), &st), 0, "Download progress is not saved");
+
+    ChunksDownloadRequester resumedRequester {cResumedChunks};
+
+    zassert_equal(sDownloader.Init(resumedRequester), aos::ErrorEnum::eNone, "Failed to initialize downloader");
+
+    sNumResentWrites = 0;
+
+    zassert_equal(sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService),
+        aos::ErrorEnum::eNone, "Failed to download image");
+
+    zassert_equal(sNumResentWrites, 0, "Resent parts are written again");
+
+    checkFileContent("a.bin", "0123456789");
+    checkFileDigest("a.bin", cDigestA);
+
+    zassert_not_equal(stat(progressPath.CStr(), &st), 0, "Download progress is not removed");
+}
+
 ZTEST(downloader, test_timeout_download_image)
 {
     aos::Log::SetCallback(TestLogCallback);
@@ -129,3 +492,31 @@ ZTEST(downloader, test_timeout_download_image)
     zassert_equal(sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService),
         aos::ErrorEnum::eTimeout, "Expected timeout error");
 }
+
+ZTEST(downloader, test_download_benchmark)
+{
+    aos::Log::SetCallback([](const aos::String&, aos::LogLevel, const aos::String&) {});
+
+    auto chunkWritesResult = benchmarkChunkWrites();
+
+    BenchmarkDownloadRequester requester;
+
+    zassert_equal(sDownloader.Init(requester), aos::ErrorEnum::eNone, "Failed to initialize downloader");
+
+    aos::StaticString<aos::cURLLen>      url {cDownloadUrl};
+    aos::StaticString<aos::cFilePathLen> path {cDownloadPath};
+
+    auto err = sDownloader.Download(url, path, aos::cloudprotocol::DownloadTargetEnum::eService);
+
+    aos::Log::SetCallback(TestLogCallback);
+
+    zassert_equal(err, aos::ErrorEnum::eNone, "Failed to download image");
+    zassert_equal(k_sem_take(&sBenchmarkDone, K_SECONDS(10)), 0, "Benchmark is not finished");
+
+    printBenchmark("chunk writes", chunkWritesResult);
+    printBenchmark("download", sDownloadResult);
+
+    // Writes of the downloaded file are coalesced, only progress and digest records are written partially.
+    zassert_true(sDownloadResult.mNumPartialWrites < chunkWritesResult.mNumPartialWrites / 10,
+        "Too many partial writes");
+}
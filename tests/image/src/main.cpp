@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/tc_util.h>
+#include <zephyr/ztest.h>
+
+#include <string.h>
+#include <sys/stat.h>
+
+#include <aos/common/tools/fs.hpp>
+#include <aos/common/tools/log.hpp>
+
+#include "image/imagehandler.hpp"
+#include "utils/checksum.hpp"
+#include "utils/log.hpp"
+#include "utils/utils.hpp"
+
+namespace aos::zephyr::image {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Constants
+ **********************************************************************************************************************/
+
+constexpr auto cTestDir    = "image_test";
+constexpr auto cServiceDir = "image_test/service";
+constexpr auto cData       = "hello";
+constexpr auto cDataDigest = "sha256:2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824";
+constexpr auto cZeroDigest = "sha256:0000000000000000000000000000000000000000000000000000000000000000";
+
+/***********************************************************************************************************************
+ * Utils
+ **********************************************************************************************************************/
+
+void* Setup(void)
+{
+    Log::SetCallback(TestLogCallback);
+
+    return nullptr;
+}
+
+void Before(void*)
+{
+    fs::RemoveAll(cTestDir);
+
+    auto err = fs::MakeDirAll(cServiceDir);
+    zassert_true(err.IsNone(), "Can't create test dir: %s", utils::ErrorToCStr(err));
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(image, nullptr, Setup, Before, nullptr, nullptr);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(image, test_calculate_digest_without_record)
+{
+    auto path = fs::JoinPath(cServiceDir, "file.txt");
+
+    auto err = fs::WriteStringToFile(path, cData, S_IRUSR | S_IWUSR);
+    zassert_true(err.IsNone(), "Can't write file: %s", utils::ErrorToCStr(err));
+
+    ImageHandler imageHandler;
+
+    auto result = imageHandler.CalculateDigest(path);
+    zassert_true(result.mError.IsNone(), "Can't calculate digest: %s", utils::ErrorToCStr(result.mError));
+    zassert_true(result.mValue == cDataDigest, "Wrong digest: %s", result.mValue.CStr());
+
+    result = imageHandler.CalculateDigest(fs::JoinPath(cServiceDir, "missing.txt"));
+    zassert_false(result.mError.IsNone(), "Digest of missing file should fail");
+}
+
+ZTEST(image, test_calculate_digest_from_record)
+{
+    auto path = fs::JoinPath(cServiceDir, "file.txt");
+
+    auto err = fs::WriteStringToFile(path, cData, S_IRUSR | S_IWUSR);
+    zassert_true(err.IsNone(), "Can't write file: %s", utils::ErrorToCStr(err));
+
+    StaticArray<uint8_t, cSHA256Size> recordedDigest;
+
+    recordedDigest.Resize(cSHA256Size);
+
+    err = utils::WriteSha256Digest(path, recordedDigest);
+    zassert_true(err.IsNone(), "Can't write digest record: %s", utils::ErrorToCStr(err));
+
+    ImageHandler imageHandler;
+
+    auto result = imageHandler.CalculateDigest(path);
+    zassert_true(result.mError.IsNone(), "Can't calculate digest: %s", utils::ErrorToCStr(result.mError));
+    zassert_true(result.mValue == cZeroDigest, "Wrong digest: %s", result.mValue.CStr());
+}
+
+ZTEST(image, test_sha256_calculator_restart)
+{
+    utils::Sha256Calculator calculator;
+
+    auto err = calculator.Start();
+    zassert_true(err.IsNone(), "Can't start calculator: %s", utils::ErrorToCStr(err));
+
+    err = calculator.Update("garbage", strlen("garbage"));
+    zassert_true(err.IsNone(), "Can't update calculator: %s", utils::ErrorToCStr(err));
+
+    // Restart drops the data of the previous calculation.
+    err = calculator.Start();
+    zassert_true(err.IsNone(), "Can't start calculator: %s", utils::ErrorToCStr(err));
+
+    err = calculator.Update(cData, strlen(cData));
+    zassert_true(err.IsNone(), "Can't update calculator: %s", utils::ErrorToCStr(err));
+
+    auto [sha256, finishErr] = calculator.Finish();
+    zassert_true(finishErr.IsNone(), "Can't finish calculator: %s", utils::ErrorToCStr(finishErr));
+
+    StaticString<oci::cMaxDigestLen> digest {"sha256:"};
+    StaticString<cSHA256Size * 2>    hex;
+
+    zassert_true(hex.ByteArrayToHex(sha256).IsNone(), "Can't convert digest");
+    zassert_true(digest.Append(hex) == cDataDigest, "Wrong digest: %s", digest.CStr());
+
+    err = calculator.Update(cData, strlen(cData));
+    zassert_true(err.Is(ErrorEnum::eWrongState), "Finished calculator should not be updated");
+}
+
+ZTEST(image, test_calculate_digest_folder)
+{
+    auto err = fs::WriteStringToFile(fs::JoinPath(cServiceDir, "file.txt"), cData, S_IRUSR | S_IWUSR);
+    zassert_true(err.IsNone(), "Can't write file: %s", utils::ErrorToCStr(err));
+
+    ImageHandler imageHandler;
+
+    auto result = imageHandler.CalculateDigest(cServiceDir);
+    zassert_true(result.mError.IsNone(), "Can't calculate digest: %s", utils::ErrorToCStr(result.mError));
+    zassert_true(result.mValue.IsEmpty(), "Folder digest should be empty: %s", result.mValue.CStr());
+}
+
+ZTEST(image, test_validate_service_without_records)
+{
+    auto err = fs::WriteStringToFile(fs::JoinPath(cServiceDir, "config.json"), "{}", S_IRUSR | S_IWUSR);
+    zassert_true(err.IsNone(), "Can't write file: %s", utils::ErrorToCStr(err));
+
+    auto rootfsPath = fs::JoinPath(cServiceDir, "rootfs");
+
+    err = fs::MakeDirAll(rootfsPath);
+    zassert_true(err.IsNone(), "Can't create dir: %s", utils::ErrorToCStr(err));
+
+    err = fs::WriteStringToFile(fs::JoinPath(rootfsPath, "file.txt"), cData, S_IRUSR | S_IWUSR);
+    zassert_true(err.IsNone(), "Can't write file: %s", utils::ErrorToCStr(err));
+
+    ImageHandler imageHandler;
+
+    err = imageHandler.ValidateService(cServiceDir);
+    zassert_true(err.IsNone(), "Can't validate service: %s", utils::ErrorToCStr(err));
+
+    err = imageHandler.ValidateService(fs::JoinPath(cTestDir, "missing"));
+    zassert_false(err.IsNone(), "Missing service should not be valid");
+}
+
+} // namespace aos::zephyr::image
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include "logger/compression.hpp"
+#include "utils/utils.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Vars
+ **********************************************************************************************************************/
+
+uint8_t  sRawData[cCompressionBlockSize];
+uint8_t  sCompressedData[cCompressionBlockSize * 2];
+uint8_t  sDecompressedData[cCompressionBlockSize];
+uint16_t sHashTable[cCompressionHashTableSize];
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+void FillIncompressibleData(uint8_t* data, size_t size)
+{
+    uint32_t state = 0x12345678;
+
+    for (size_t i = 0; i < size; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        data[i] = static_cast<uint8_t>(state);
+    }
+}
+
+void CheckRoundtrip(size_t size)
+{
+    auto [compressedSize, err] = CompressBlock(sRawData, size, sCompressedData, sizeof(sCompressedData), sHashTable);
+    zassert_true(err.IsNone(), "Failed to compress block: %s", utils::ErrorToCStr(err));
+
+    auto [decompressedSize, decompressErr]
+        = DecompressBlock(sCompressedData, compressedSize, sDecompressedData, sizeof(sDecompressedData));
+    zassert_true(decompressErr.IsNone(), "Failed to decompress block: %s", utils::ErrorToCStr(decompressErr));
+
+    zassert_equal(decompressedSize, size);
+    zassert_mem_equal(sDecompressedData, sRawData, size);
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(compression, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(compression, test_CompressText)
+{
+    size_t size = 0;
+
+    for (auto i = 0; size < sizeof(sRawData) - 64; i++) {
+        size += snprintf(reinterpret_cast<char*>(sRawData) + size, sizeof(sRawData) - size,
+            "2025-01-01T00:00:%02dZ <inf> aos_core: Log message %d\n", i % 60, i);
+    }
+
+    CheckRoundtrip(size);
+
+    auto [compressedSize, err] = CompressBlock(sRawData, size, sCompressedData, sizeof(sCompressedData), sHashTable);
+    zassert_true(err.IsNone(), "Failed to compress block: %s", utils::ErrorToCStr(err));
+
+    zassert_true(compressedSize < size / 2, "Wrong compression ratio: %zu/%zu", compressedSize, size);
+}
+
+ZTEST(compression, test_CompressRandomData)
+{
+    FillIncompressibleData(sRawData, sizeof(sRawData));
+
+    CheckRoundtrip(sizeof(sRawData));
+    CheckRoundtrip(1);
+    CheckRoundtrip(0);
+
+    auto [compressedSize, err]
+        = CompressBlock(sRawData, sizeof(sRawData), sCompressedData, sizeof(sRawData) - 1, sHashTable);
+    zassert_true(err.Is(ErrorEnum::eNoMemory), "Unexpected error: %s", utils::ErrorToCStr(err));
+}
+
+ZTEST(compression, test_DecompressInvalidData)
+{
+    // Match with offset beyond the beginning of the output.
+    const uint8_t invalidData[] = {0x10, 'a', 0x10, 0x00};
+
+    auto [size, err] = DecompressBlock(invalidData, sizeof(invalidData), sDecompressedData, sizeof(sDecompressedData));
+    zassert_true(err.Is(ErrorEnum::eInvalidArgument), "Unexpected error: %s", utils::ErrorToCStr(err));
+
+    // Literals don't fit the output.
+    const uint8_t overflowData[] = {0x40, 'a', 'b', 'c', 'd'};
+
+    Tie(size, err) = DecompressBlock(overflowData, sizeof(overflowData), sDecompressedData, 2);
+    zassert_true(err.Is(ErrorEnum::eInvalidArgument), "Unexpected error: %s", utils::ErrorToCStr(err));
+
+    zassert_true(IsCompressedLogFile("/aos/log/aos_00000000000000000001.lz"));
+    zassert_false(IsCompressedLogFile("/aos/log/aos_00000000000000000001"));
+}
+
+} // namespace aos::zephyr::logger
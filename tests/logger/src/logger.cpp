@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <time.h>
+
+#include <zephyr/ztest.h>
+
+#include <aos/common/tools/map.hpp>
+
+#include "logger/logger.hpp"
+
+namespace aos::zephyr::logger {
+
+namespace {
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+constexpr auto cBenchmarkRounds = 10000;
+
+const char* const cModules[] = {"app", "certhandler", "clocksync", "communication", "crypto", "downloader", "iamclient",
+    "launcher", "monitoring", "nodeinfoprovider", "ocispec", "pkcs11", "provisionmanager", "resourcemanager", "runner",
+    "servicemanager", "layermanager", "smclient", "storage", "image", "logprovider"};
+
+/***********************************************************************************************************************
+ * Vars
+ **********************************************************************************************************************/
+
+// Module lookup as it was done before the compile-time module table: linear search over the map.
+StaticMap<String, Logger::ModuleLogCallback, 32> sMapCallbacks;
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+uint64_t GetTimeNs()
+{
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+template <typename F>
+void Benchmark(const char* name, F lookup)
+{
+    StaticString<32> module;
+    size_t           numFound = 0;
+
+    auto start = GetTimeNs();
+
+    for (auto i = 0; i < cBenchmarkRounds; i++) {
+        for (const auto& moduleName : cModules) {
+            module = moduleName;
+
+            if (lookup(module) != nullptr) {
+                numFound++;
+            }
+        }
+    }
+
+    auto elapsed = GetTimeNs() - start;
+    auto numOps  = cBenchmarkRounds * ARRAY_SIZE(cModules);
+
+    zassert_equal(numFound, numOps);
+
+    printk("%-20s ops=%zu, total=%llu us, per op=%llu ns\n", name, numOps,
+        static_cast<unsigned long long>(elapsed / 1000), static_cast<unsigned long long>(elapsed / numOps));
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(logger_dispatch, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(logger_dispatch, test_FindLogCallback)
+{
+    for (const auto& module : cModules) {
+        zassert_not_null(Logger::FindLogCallback(module), "Module not found: %s", module);
+    }
+
+    zassert_not_equal(Logger::FindLogCallback("app"), Logger::FindLogCallback("storage"));
+
+    zassert_is_null(Logger::FindLogCallback("unknown"));
+    zassert_is_null(Logger::FindLogCallback("ap"));
+    zassert_is_null(Logger::FindLogCallback("appx"));
+    zassert_is_null(Logger::FindLogCallback(""));
+}
+
+ZTEST(logger_dispatch, test_DispatchBenchmark)
+{
+    sMapCallbacks.Clear();
+
+    for (const auto& module : cModules) {
+        zassert_true(sMapCallbacks.Set(module, Logger::FindLogCallback(module)).IsNone());
+    }
+
+    Benchmark("map lookup", [](const String& module) -> Logger::ModuleLogCallback {
+        auto it = sMapCallbacks.Find(module);
+
+        return it == sMapCallbacks.end() ? nullptr : it->mSecond;
+    });
+
+    Benchmark("hash table lookup", [](const String& module) { return Logger::FindLogCallback(module); });
+}
+
+} // namespace aos::zephyr::logger
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include "logger/logrecord.hpp"
+#include "utils/utils.hpp"
+
+namespace aos::zephyr::logger {
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(logrecord, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(logrecord, test_EncodeDecode)
+{
+    LogRecord                              record;
+    LogRecord                              decodedRecord;
+    StaticArray<uint8_t, cMaxLogRecordLen> data;
+
+    record.SetTime(Time::Now());
+    record.mLevel      = 3;
+    record.mModule     = "logger";
+    record.mInstanceID = "instance0";
+    record.mMessage    = "log message";
+
+    auto err = EncodeLogRecord(record, data);
+    zassert_true(err.IsNone(), "Failed to encode log record: %s", utils::ErrorToCStr(err));
+
+    zassert_true(data.Size() < record.mInstanceID.Size() + record.mMessage.Size() + cTimeStrLen);
+
+    auto [size, decodeErr] = DecodeLogRecord(data.Get(), data.Size(), decodedRecord);
+    zassert_true(decodeErr.IsNone(), "Failed to decode log record: %s", utils::ErrorToCStr(decodeErr));
+
+    zassert_equal(size, data.Size());
+    zassert_equal(decodedRecord.mTimestamp, record.mTimestamp);
+    zassert_equal(decodedRecord.mLevel, record.mLevel);
+    zassert_equal(decodedRecord.mModule, record.mModule);
+    zassert_equal(decodedRecord.mInstanceID, record.mInstanceID);
+    zassert_equal(decodedRecord.mMessage, record.mMessage);
+
+    decodedRecord.SetTime(decodedRecord.GetTime());
+
+    zassert_equal(decodedRecord.mTimestamp, record.mTimestamp);
+}
+
+ZTEST(logrecord, test_InstanceID)
+{
+    LogRecord                              record;
+    StaticArray<uint8_t, cMaxLogRecordLen> data;
+    StaticString<cInstanceIDLen>           instanceID;
+
+    // Message text is never parsed for instance ID.
+
+    record.SetTime(Time::Now());
+    record.mModule  = cInstanceLogModule;
+    record.mMessage = "[instance0]log message";
+
+    auto err = EncodeLogRecord(record, data);
+    zassert_true(err.IsNone(), "Failed to encode log record: %s", utils::ErrorToCStr(err));
+
+    err = GetLogRecordInstanceID(data.Get(), data.Size(), instanceID);
+    zassert_true(err.IsNone(), "Failed to get instance ID: %s", utils::ErrorToCStr(err));
+    zassert_true(instanceID.IsEmpty());
+
+    MakeInstanceLogRecord("instance1", "[instance0]log message", record);
+
+    err = EncodeLogRecord(record, data);
+    zassert_true(err.IsNone(), "Failed to encode log record: %s", utils::ErrorToCStr(err));
+
+    err = GetLogRecordInstanceID(data.Get(), data.Size(), instanceID);
+    zassert_true(err.IsNone(), "Failed to get instance ID: %s", utils::ErrorToCStr(err));
+    zassert_equal(instanceID, "instance1");
+}
+
+ZTEST(logrecord, test_PartialRecord)
+{
+    LogRecord                              record;
+    StaticArray<uint8_t, cMaxLogRecordLen> data;
+
+    record.SetTime(Time::Now());
+    record.mMessage = "log message";
+
+    auto err = EncodeLogRecord(record, data);
+    zassert_true(err.IsNone(), "Failed to encode log record: %s", utils::ErrorToCStr(err));
+
+    for (size_t i = 0; i < data.Size(); i++) {
+        auto [size, sizeErr] = GetLogRecordSize(data.Get(), i);
+        zassert_true(sizeErr.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(sizeErr));
+    }
+
+    auto [size, sizeErr] = GetLogRecordSize(data.Get(), data.Size());
+    zassert_true(sizeErr.IsNone(), "Failed to get log record size: %s", utils::ErrorToCStr(sizeErr));
+    zassert_equal(size, data.Size());
+}
+
+} // namespace aos::zephyr::logger
@@ -17,6 +17,7 @@
 #include <aos/common/tools/fs.hpp>
 #include <aos/common/tools/log.hpp>
 
+#include "logger/flightrecorder.hpp"
 #include "logger/fsbackend.hpp"
 #include "utils/utils.hpp"
 
@@ -35,6 +36,46 @@ LOG_MODULE_REGISTER(logger_test, LOG_LEVEL_INF);
  */
 constexpr auto cLogTimeDiffEpsilon = 10 * Time::cMilliseconds;
 
+/**
+ * Timeout to wait for rotated log files compression.
+ */
+constexpr auto cCompressionTimeoutMs = 1000;
+
+/**
+ * Time to let the log thread pass log messages to the backend.
+ */
+constexpr auto cLogProcessTimeMs = 100;
+
+/**
+ * Log file flush period.
+ */
+constexpr auto cFlushPeriodMs = CONFIG_AOS_LOG_BACKEND_FS_FLUSH_PERIOD;
+
+/**
+ * Length of log entries to check size flush.
+ */
+constexpr auto cSizeFlushEntryLen = 128;
+
+/**
+ * Max number of log entries to check size flush: they are more than a log batch, so the flush thread is woken up.
+ */
+constexpr auto cNumSizeFlushEntries = CONFIG_AOS_LOG_BACKEND_FS_BATCH_SIZE / cSizeFlushEntryLen + 1;
+
+/**
+ * Number of log entries to check batched write.
+ */
+constexpr auto cNumBatchEntries = 8;
+
+/**
+ * Number of debug messages dumped by flight recorder.
+ */
+constexpr auto cNumDumpedEntries = CONFIG_AOS_LOG_FLIGHT_RECORDER_DUMP_ENTRIES;
+
+/**
+ * Number of recorded debug messages to check flight recorder dump.
+ */
+constexpr auto cNumRecordedEntries = cNumDumpedEntries + 2;
+
 /***********************************************************************************************************************
  * Static
  **********************************************************************************************************************/
@@ -64,10 +105,12 @@ bool FileContainsLog(const std::string& filePath, const std::string& logEntry, c
     return false;
 }
 
-std::string GetLogPath(const std::string& suffix)
+std::string GetLogPath(size_t fileNum)
 {
+    auto number = std::to_string(fileNum);
+
     auto path = fs::JoinPath(cLogDir, cLogPrefix);
-    path.Append(suffix.c_str());
+    path.Append(std::string(cLogFileNumberLen - number.size(), '0').c_str()).Append(number.c_str());
 
     return path.CStr();
 }
@@ -90,6 +133,45 @@ std::vector<std::string> GetLogFils()
     return result;
 }
 
+size_t GetLogFilesSize(const std::vector<std::string>& logFiles)
+{
+    size_t totalSize = 0;
+
+    for (const auto& logFile : logFiles) {
+        std::ifstream file(logFile, std::ios::binary | std::ios::ate);
+
+        totalSize += static_cast<size_t>(file.tellg());
+    }
+
+    return totalSize;
+}
+
+// Rotated log files are compressed by the flush thread between log batches, so they are compressed and shrunk some
+// time after sync.
+bool WaitLogFilesCompressed()
+{
+    for (auto start = k_uptime_get(); k_uptime_get() - start < cCompressionTimeoutMs; k_msleep(10)) {
+        auto logFiles = GetLogFils();
+
+        auto compressed = std::all_of(logFiles.begin(), logFiles.end() - 1,
+            [](const std::string& logFile) { return IsCompressedLogFile(logFile.c_str()); });
+
+        if (compressed && GetLogFilesSize(logFiles) <= cLogSizeLimit) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool LogFilesContainLog(const std::string& logEntry, const Time& logTime)
+{
+    auto logFiles = GetLogFils();
+
+    return std::any_of(logFiles.begin(), logFiles.end(),
+        [&](const std::string& logFile) { return FileContainsLog(logFile, logEntry, logTime); });
+}
+
 std::vector<std::string> CreateLogEntries(size_t count, size_t len)
 {
     std::vector<std::string> logEntries;
@@ -125,6 +207,9 @@ ZTEST_SUITE(logger, nullptr, Setup, nullptr, nullptr, nullptr);
 
 ZTEST_F(logger, test_fsbackend)
 {
+    // File names and counts below are checked for uncompressed log files.
+    Z_TEST_SKIP_IFDEF(CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION);
+
     auto err = backend::FSBackend::Get().Init();
     zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
 
@@ -136,11 +221,14 @@ ZTEST_F(logger, test_fsbackend)
         LOG_INF("%s", entry.c_str());
     }
 
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
     auto logFiles = GetLogFils();
     zassert_equal(logFiles.size(), logEntries.size());
 
     for (size_t i = 0; i < logEntries.size(); ++i) {
-        zassert_equal(logFiles[i], GetLogPath(std::to_string(i)));
+        zassert_equal(logFiles[i], GetLogPath(i));
         zassert_true(FileContainsLog(logFiles[i], logEntries[i], logTime));
     }
 
@@ -153,13 +241,180 @@ ZTEST_F(logger, test_fsbackend)
         LOG_INF("%s", entry.c_str());
     }
 
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
     logFiles = GetLogFils();
     zassert_equal(logFiles.size(), logEntries.size());
 
     for (size_t i = 0; i < logEntries.size(); ++i) {
-        zassert_equal(logFiles[i], GetLogPath(std::to_string(logEntries.size() + i)));
+        zassert_equal(logFiles[i], GetLogPath(logEntries.size() + i));
         zassert_true(FileContainsLog(logFiles[i], logEntries[i], logTime));
     }
+
+    // Logger backend writes buffered log messages in batches.
+
+    auto prevStats = backend::FSBackend::Get().GetStats();
+
+    logTime = Time::Now();
+
+    for (size_t i = 0; i < cNumBatchEntries; ++i) {
+        LOG_INF("batch entry %zu", i);
+    }
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    auto stats = backend::FSBackend::Get().GetStats();
+
+    zassert_equal(stats.mDroppedBytes, prevStats.mDroppedBytes);
+    zassert_true(stats.mNumBatches > prevStats.mNumBatches);
+    zassert_true(stats.mNumBatches - prevStats.mNumBatches < cNumBatchEntries);
+
+    logFiles = GetLogFils();
+    zassert_true(FileContainsLog(logFiles.back(), "batch entry " + std::to_string(cNumBatchEntries - 1), logTime));
+
+    // Instance log is put directly into the log buffer.
+
+    logTime = Time::Now();
+
+    err = backend::FSBackend::Get().PutInstanceLog("instance0", "console line");
+    zassert_true(err.IsNone(), "Failed to put instance log: %s", utils::ErrorToCStr(err));
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    logFiles = GetLogFils();
+    zassert_true(FileContainsLog(logFiles.back(), "[instance0]console line", logTime));
+
+    // Flight recorder dumps the last recorded debug messages only.
+
+    logTime = Time::Now();
+
+    for (auto i = 0; i < cNumRecordedEntries; i++) {
+        FlightRecorder::Get().Put("", ("recorded entry " + std::to_string(i)).c_str());
+    }
+
+    zassert_equal(FlightRecorder::Get().GetNumEntries(), cNumRecordedEntries);
+
+    err = FlightRecorder::Get().Dump();
+    zassert_true(err.IsNone(), "Failed to dump flight recorder: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(FlightRecorder::Get().GetNumEntries(), 0);
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    for (auto i = 0; i < cNumRecordedEntries; i++) {
+        auto entry = "<dbg> unknown: recorded entry " + std::to_string(i);
+
+        auto dumped = i >= cNumRecordedEntries - cNumDumpedEntries;
+
+        zassert_equal(LogFilesContainLog(entry, logTime), dumped, "Wrong dumped entry: %d", i);
+    }
+}
+
+ZTEST_F(logger, test_fsbackend_flush)
+{
+    auto err = backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    // Log entries are not visible in the log file before it is flushed.
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    auto logTime = Time::Now();
+
+    LOG_INF("period flush entry");
+
+    k_msleep(cLogProcessTimeMs);
+
+    zassert_false(FileContainsLog(GetLogFils().back(), "period flush entry", logTime));
+
+    // Log file is flushed by the flush period.
+
+    k_msleep(2 * cFlushPeriodMs);
+
+    zassert_true(FileContainsLog(GetLogFils().back(), "period flush entry", logTime));
+
+    // Log file is flushed when the flush size is written.
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    logTime = Time::Now();
+
+    auto prevNumBatches = backend::FSBackend::Get().GetStats().mNumBatches;
+    auto numBatches     = prevNumBatches;
+    auto lastEntry      = std::string();
+
+    // Log entries are written by the flush thread once they fill a log batch, so they are put until it happens.
+    for (size_t i = 0; i < cNumSizeFlushEntries && numBatches == prevNumBatches; i++) {
+        lastEntry = "size flush entry " + std::to_string(i) + ":";
+
+        LOG_INF("%s %s", lastEntry.c_str(), std::string(cSizeFlushEntryLen, 'S').c_str());
+
+        k_msleep(cLogProcessTimeMs);
+
+        numBatches = backend::FSBackend::Get().GetStats().mNumBatches;
+    }
+
+    zassert_true(numBatches > prevNumBatches, "Log batch is not written");
+    zassert_true(FileContainsLog(GetLogFils().back(), lastEntry, logTime));
+
+    // Log file is flushed on error messages.
+
+    err = backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    logTime = Time::Now();
+
+    LOG_INF("error flush entry");
+
+    k_msleep(cLogProcessTimeMs);
+
+    zassert_false(FileContainsLog(GetLogFils().back(), "error flush entry", logTime));
+
+    LOG_ERR("error entry");
+
+    k_msleep(cLogProcessTimeMs);
+
+    zassert_true(FileContainsLog(GetLogFils().back(), "error flush entry", logTime));
+    zassert_true(FileContainsLog(GetLogFils().back(), "error entry", logTime));
+}
+
+ZTEST_F(logger, test_fsbackend_size_limit)
+{
+    Z_TEST_SKIP_IFNDEF(CONFIG_AOS_LOG_BACKEND_FS_COMPRESSION);
+
+    auto err = backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    // Each entry fills a log file. Rotated log files are compressed, so more than cMaxLogFiles files fit into the log
+    // size limit.
+
+    for (const auto& entry : CreateLogEntries(cMaxNumLogFiles, Log::cMaxLineLen)) {
+        LOG_INF("%s", entry.c_str());
+
+        err = backend::FSBackend::Get().Sync();
+        zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+    }
+
+    zassert_true(WaitLogFilesCompressed(), "Log files are not compressed");
+
+    auto logFiles  = GetLogFils();
+    auto totalSize = GetLogFilesSize(logFiles);
+
+    zassert_true(logFiles.size() > cMaxLogFiles, "Unexpected number of log files: %zu", logFiles.size());
+    zassert_true(logFiles.size() <= cMaxNumLogFiles, "Unexpected number of log files: %zu", logFiles.size());
+
+    for (size_t i = 0; i < logFiles.size(); i++) {
+        zassert_equal(IsCompressedLogFile(logFiles[i].c_str()), i + 1 != logFiles.size(), "Wrong log file: %s",
+            logFiles[i].c_str());
+    }
+
+    zassert_true(totalSize <= cLogSizeLimit, "Log size limit exceeded: %zu", totalSize);
 }
 
 } // namespace aos::zephyr::logger
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include "logger/logger.hpp"
+#include "logger/ratelimiter.hpp"
+#include "utils/utils.hpp"
+
+namespace aos::zephyr::logger {
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(ratelimiter, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(ratelimiter, test_Burst)
+{
+    RateLimiter limiter;
+    RateLimit   limit      = {10, 5};
+    uint32_t    suppressed = 0;
+
+    for (auto i = 0; i < 5; i++) {
+        zassert_true(limiter.Allow(limit, 1000, suppressed));
+        zassert_equal(suppressed, 0);
+    }
+
+    for (auto i = 0; i < 20; i++) {
+        zassert_false(limiter.Allow(limit, 1000, suppressed));
+    }
+
+    // One token is refilled in 100 ms.
+    zassert_false(limiter.Allow(limit, 1099, suppressed));
+    zassert_true(limiter.Allow(limit, 1100, suppressed));
+    zassert_equal(suppressed, 21);
+
+    zassert_false(limiter.Allow(limit, 1100, suppressed));
+
+    // Bucket is refilled up to burst size only.
+    for (auto i = 0; i < 5; i++) {
+        zassert_true(limiter.Allow(limit, 10000, suppressed));
+        zassert_equal(suppressed, i == 0 ? 1 : 0);
+    }
+
+    zassert_false(limiter.Allow(limit, 10000, suppressed));
+}
+
+ZTEST(ratelimiter, test_Disabled)
+{
+    RateLimiter limiter;
+    RateLimit   limit      = {1, 1};
+    uint32_t    suppressed = 0;
+
+    zassert_true(limiter.Allow(limit, 0, suppressed));
+    zassert_false(limiter.Allow(limit, 0, suppressed));
+    zassert_false(limiter.Allow(limit, 0, suppressed));
+
+    limit = {0, 0};
+
+    for (auto i = 0; i < 100; i++) {
+        zassert_true(limiter.Allow(limit, 0, suppressed));
+        zassert_equal(suppressed, i == 0 ? 2 : 0);
+    }
+}
+
+ZTEST(ratelimiter, test_TakeSuppressed)
+{
+    RateLimiter limiter;
+    RateLimit   limit      = {1, 1};
+    uint32_t    suppressed = 0;
+
+    zassert_true(limiter.Allow(limit, 0, suppressed));
+    zassert_equal(limiter.TakeSuppressed(), 0);
+
+    for (auto i = 0; i < 3; i++) {
+        zassert_false(limiter.Allow(limit, 0, suppressed));
+    }
+
+    // Taken suppressed messages are not reported again by the next allowed message.
+    zassert_equal(limiter.TakeSuppressed(), 3);
+    zassert_equal(limiter.TakeSuppressed(), 0);
+
+    zassert_false(limiter.Allow(limit, 0, suppressed));
+    zassert_true(limiter.Allow(limit, 1000, suppressed));
+    zassert_equal(suppressed, 1);
+}
+
+ZTEST(ratelimiter, test_SetRateLimit)
+{
+    zassert_true(Logger::SetRateLimit("communication", 10, 20).IsNone());
+    zassert_true(Logger::SetRateLimit("communication", 0, 0).IsNone());
+
+    auto err = Logger::SetRateLimit("unknown", 10, 20);
+    zassert_true(err.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(err));
+}
+
+} // namespace aos::zephyr::logger
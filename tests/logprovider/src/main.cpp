@@ -7,14 +7,19 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <string.h>
+#include <utility>
 #include <vector>
 
+#include <zephyr/logging/log_ctrl.h>
 #include <zephyr/tc_util.h>
 #include <zephyr/ztest.h>
 
 #include <aos/common/tools/fs.hpp>
 #include <aos/common/tools/log.hpp>
 
+#include "logger/flightrecorder.hpp"
+#include "logger/fsbackend.hpp"
 #include "logprovider/fslogreader.hpp"
 #include "logprovider/logprovider.hpp"
 #include "stubs/launcherstub.hpp"
@@ -95,6 +100,52 @@ Error WriteLogToFile(const TestFSLogEntry& logEntry)
     return ErrorEnum::eNone;
 }
 
+Error WriteLogIndex(const String& logFile, const std::vector<logger::LogIndexEntry>& entries)
+{
+    if (auto err = fs::MakeDirAll(logger::cLogIndexDir); !err.IsNone()) {
+        return err;
+    }
+
+    for (const auto& entry : entries) {
+        if (auto err = logger::AppendLogIndexEntry(logFile, entry); !err.IsNone()) {
+            return err;
+        }
+    }
+
+    return ErrorEnum::eNone;
+}
+
+std::vector<std::string> ReadFSLogs(const LogReaderFilter& filter)
+{
+    auto fsLogReader = std::make_unique<FSLogReader>();
+    auto logEntry    = std::make_unique<LogEntry>();
+
+    auto err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    std::vector<std::string> logs;
+
+    while (fsLogReader->Next()) {
+        err = fsLogReader->GetEntry(*logEntry);
+        zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+
+        logs.emplace_back(logEntry->mContent.CStr());
+    }
+
+    return logs;
+}
+
+bool ContainsLog(const std::vector<std::string>& logs, const std::string& message)
+{
+    for (const auto& log : logs) {
+        if (log.find(message) != std::string::npos) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void* Setup(void)
 {
     Log::SetCallback(
@@ -121,8 +172,11 @@ ZTEST_SUITE(
         logproviderFixture->mLogProvider     = std::make_unique<LogProvider>();
         logproviderFixture->mLauncherStorage = std::make_unique<sm::launcher::StorageStub>();
 
-        auto err = logproviderFixture->mLogProvider->Init(
-            *logproviderFixture->mLogReader, *logproviderFixture->mLauncherStorage);
+        StaticArray<LogReaderItf*, 1> logReaders;
+
+        logReaders.PushBack(logproviderFixture->mLogReader.get());
+
+        auto err = logproviderFixture->mLogProvider->Init(logReaders, *logproviderFixture->mLauncherStorage);
         zassert_true(err.IsNone(), "Failed to initialize log provider: %s", utils::ErrorToCStr(err));
 
         err = logproviderFixture->mLogProvider->Subscribe(*logproviderFixture->mLogObserver);
@@ -231,6 +285,56 @@ ZTEST_F(logprovider, test_get_instance_crash_log)
     zassert_true(err.Is(ErrorEnum::eNotSupported), "Not supported error expected: %s", utils::ErrorToCStr(err));
 }
 
+ZTEST_F(logprovider, test_get_instance_crash_log_from_reader)
+{
+    auto logReader      = std::make_unique<LogReaderStub>();
+    auto crashLogReader = std::make_unique<CrashLogReaderStub>();
+    auto logProvider    = std::make_unique<LogProvider>();
+
+    crashLogReader->SetCrashLog("instance-id-1", "console line 1\nconsole line 2\n");
+
+    StaticArray<LogReaderItf*, 1> logReaders;
+
+    logReaders.PushBack(logReader.get());
+
+    auto err = logProvider->Init(logReaders, *fixture->mLauncherStorage, crashLogReader.get());
+    zassert_true(err.IsNone(), "Failed to initialize log provider: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Subscribe(*fixture->mLogObserver);
+    zassert_true(err.IsNone(), "Failed to subscribe log observer: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Start();
+    zassert_true(err.IsNone(), "Failed to start log provider: %s", utils::ErrorToCStr(err));
+
+    err = fixture->mLauncherStorage->AddInstance(CreateInstanceData("instance-id-1"));
+    zassert_true(err.IsNone(), "Failed to add instance data: %s", utils::ErrorToCStr(err));
+
+    auto logRequest                                = std::make_unique<cloudprotocol::RequestLog>();
+    logRequest->mLogID                             = "crash_log_id";
+    logRequest->mFilter.mInstanceFilter.mSubjectID = "instance-id-1";
+
+    err = logProvider->GetInstanceCrashLog(*logRequest);
+    zassert_true(err.IsNone(), "Failed to get instance crash log: %s", utils::ErrorToCStr(err));
+
+    auto response = std::make_unique<cloudprotocol::PushLog>();
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, logRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eOk, "Log status mismatch");
+    zassert_str_equal(response->mContent.CStr(), "console line 1\nconsole line 2\n");
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eEmpty, "Log status mismatch");
+    zassert_equal(response->mPartsCount, 2, "Log parts count mismatch");
+
+    err = logProvider->Stop();
+    zassert_true(err.IsNone(), "Failed to stop log provider: %s", utils::ErrorToCStr(err));
+}
+
 ZTEST_F(logprovider, test_get_empty_system_logs)
 {
     const std::vector<LogEntry> logEntries = {
@@ -302,12 +406,235 @@ ZTEST_F(logprovider, test_get_filtered_system_logs)
     zassert_equal(response->mContent.Size(), 0, "Log content size mismatch");
 }
 
+ZTEST_F(logprovider, test_get_system_log_flight_recorder)
+{
+    auto logReader   = std::make_unique<FSLogReader>();
+    auto logProvider = std::make_unique<LogProvider>();
+
+    auto err = logger::backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    StaticArray<LogReaderItf*, 1> logReaders;
+
+    logReaders.PushBack(logReader.get());
+
+    err = logProvider->Init(logReaders, *fixture->mLauncherStorage);
+    zassert_true(err.IsNone(), "Failed to initialize log provider: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Subscribe(*fixture->mLogObserver);
+    zassert_true(err.IsNone(), "Failed to subscribe log observer: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Start();
+    zassert_true(err.IsNone(), "Failed to start log provider: %s", utils::ErrorToCStr(err));
+
+    logger::FlightRecorder::Get().Put("app", "recorded message");
+
+    // Dumped messages are written to the log file before the log is read.
+
+    auto logRequest    = std::make_unique<cloudprotocol::RequestLog>();
+    logRequest->mLogID = "log_id";
+
+    err = logProvider->GetSystemLog(*logRequest);
+    zassert_true(err.IsNone(), "Failed to get system log: %s", utils::ErrorToCStr(err));
+
+    auto response = std::make_unique<cloudprotocol::PushLog>();
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, logRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eOk, "Log status mismatch");
+    zassert_not_null(strstr(response->mContent.CStr(), "recorded message"), "Dumped message not found");
+
+    err = logProvider->Stop();
+    zassert_true(err.IsNone(), "Failed to stop log provider: %s", utils::ErrorToCStr(err));
+}
+
+ZTEST_F(logprovider, test_concurrent_log_requests)
+{
+    const std::vector<LogEntry> logEntries = {
+        CreateLogEntry("[instance-id-1] instance log entry", cFromTimeFilter),
+        CreateLogEntry("system log entry", cFromTimeFilter),
+    };
+
+    auto logReaders  = std::vector<std::unique_ptr<LogReaderStub>>();
+    auto logProvider = std::make_unique<LogProvider>();
+
+    StaticArray<LogReaderItf*, cMaxNumLogWorkers> logReaderItfs;
+
+    for (size_t i = 0; i < cMaxNumLogWorkers; i++) {
+        logReaders.push_back(std::make_unique<LogReaderStub>());
+        logReaders.back()->SetLogEntries(logEntries);
+        logReaders.back()->BlockSystemLog(true);
+
+        logReaderItfs.PushBack(logReaders.back().get());
+    }
+
+    auto err = logProvider->Init(logReaderItfs, *fixture->mLauncherStorage);
+    zassert_true(err.IsNone(), "Failed to initialize log provider: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Subscribe(*fixture->mLogObserver);
+    zassert_true(err.IsNone(), "Failed to subscribe log observer: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Start();
+    zassert_true(err.IsNone(), "Failed to start log provider: %s", utils::ErrorToCStr(err));
+
+    err = fixture->mLauncherStorage->AddInstance(CreateInstanceData("instance-id-1"));
+    zassert_true(err.IsNone(), "Failed to add instance data: %s", utils::ErrorToCStr(err));
+
+    // System log request is blocked by the reader and should not block instance log request
+
+    auto systemLogRequest    = std::make_unique<cloudprotocol::RequestLog>();
+    systemLogRequest->mLogID = "system_log_id";
+
+    err = logProvider->GetSystemLog(*systemLogRequest);
+    zassert_true(err.IsNone(), "Failed to get system log: %s", utils::ErrorToCStr(err));
+
+    auto instanceLogRequest                                = std::make_unique<cloudprotocol::RequestLog>();
+    instanceLogRequest->mLogID                             = "instance_log_id";
+    instanceLogRequest->mFilter.mInstanceFilter.mSubjectID = "instance-id-1";
+
+    err = logProvider->GetInstanceLog(*instanceLogRequest);
+    zassert_true(err.IsNone(), "Failed to get instance log: %s", utils::ErrorToCStr(err));
+
+    auto response = std::make_unique<cloudprotocol::PushLog>();
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, instanceLogRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eOk, "Log status mismatch");
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, instanceLogRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eEmpty, "Log status mismatch");
+
+    // Cancel blocked system log request
+
+    LogRequestProgress progress;
+
+    err = logProvider->GetLogRequestProgress(systemLogRequest->mLogID, progress);
+    zassert_true(err.IsNone(), "Failed to get log request progress: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->CancelLogRequest(systemLogRequest->mLogID);
+    zassert_true(err.IsNone(), "Failed to cancel log request: %s", utils::ErrorToCStr(err));
+
+    for (auto& logReader : logReaders) {
+        logReader->BlockSystemLog(false);
+    }
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, systemLogRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eError, "Log status mismatch");
+
+    err = logProvider->CancelLogRequest(systemLogRequest->mLogID);
+    zassert_true(err.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(err));
+
+    err = logProvider->Stop();
+    zassert_true(err.IsNone(), "Failed to stop log provider: %s", utils::ErrorToCStr(err));
+}
+
+ZTEST_F(logprovider, test_follow_log)
+{
+    const std::string logEntries = "2024-01-31T12:00:00Z <inf> runner: [instance-id-1]instance info\n"
+                                   "2024-01-31T12:00:00Z <dbg> runner: [instance-id-1]instance debug\n"
+                                   "2024-01-31T12:00:00Z <err> runner: [instance-id-2]other instance error\n";
+
+    auto err = fixture->mLauncherStorage->AddInstance(CreateInstanceData("instance-id-1"));
+    zassert_true(err.IsNone(), "Failed to add instance data: %s", utils::ErrorToCStr(err));
+
+    auto logRequest                                = std::make_unique<cloudprotocol::RequestLog>();
+    logRequest->mLogID                             = "follow_log_id";
+    logRequest->mFilter.mInstanceFilter.mSubjectID = "instance-id-1";
+
+    err = fixture->mLogProvider->FollowLog(*logRequest, LogLevelEnum::eInfo);
+    zassert_true(err.IsNone(), "Failed to follow log: %s", utils::ErrorToCStr(err));
+
+    err = fixture->mLogProvider->FollowLog(*logRequest, LogLevelEnum::eInfo);
+    zassert_true(err.Is(ErrorEnum::eAlreadyExist), "Unexpected error: %s", utils::ErrorToCStr(err));
+
+    fixture->mLogProvider->OnLogEntries(reinterpret_cast<const uint8_t*>(logEntries.c_str()), logEntries.size());
+
+    auto response = std::make_unique<cloudprotocol::PushLog>();
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, logRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eOk, "Log status mismatch");
+    zassert_equal(response->mPart, 1, "Log part mismatch");
+    zassert_str_equal(response->mContent.CStr(), "2024-01-31T12:00:00Z <inf> runner: [instance-id-1]instance info\n");
+
+    err = fixture->mLogProvider->StopFollowLog(logRequest->mLogID);
+    zassert_true(err.IsNone(), "Failed to stop follow log: %s", utils::ErrorToCStr(err));
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    zassert_equal(response->mLogID, logRequest->mLogID, "Log ID mismatch");
+    zassert_equal(response->mStatus, cloudprotocol::LogStatusEnum::eEmpty, "Log status mismatch");
+    zassert_equal(response->mPart, 2, "Log part mismatch");
+
+    err = fixture->mLogProvider->StopFollowLog(logRequest->mLogID);
+    zassert_true(err.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(err));
+}
+
+ZTEST_F(logprovider, test_follow_log_loop)
+{
+    const std::string logEntry   = "2024-01-31T12:00:00Z <inf> app: info\n";
+    const std::string sendEntry  = "2024-01-31T12:00:00Z <dbg> smclient: Received log\n";
+    auto              logRequest = std::make_unique<cloudprotocol::RequestLog>();
+    auto              response   = std::make_unique<cloudprotocol::PushLog>();
+
+    // Log observer logs each received chunk as the SM client does.
+
+    fixture->mLogObserver->SetCallback([&]() {
+        fixture->mLogProvider->OnLogEntries(reinterpret_cast<const uint8_t*>(sendEntry.c_str()), sendEntry.size());
+    });
+
+    logRequest->mLogID = "follow_log_id";
+
+    auto err = fixture->mLogProvider->FollowLog(*logRequest, LogLevelEnum::eDebug);
+    zassert_true(err.IsNone(), "Failed to follow log: %s", utils::ErrorToCStr(err));
+
+    fixture->mLogProvider->OnLogEntries(reinterpret_cast<const uint8_t*>(logEntry.c_str()), logEntry.size());
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+    zassert_str_equal(response->mContent.CStr(), logEntry.c_str());
+
+    // Entries logged by sending the chunk are not followed.
+
+    err = fixture->mLogObserver->WaitLogReceived(
+        *response, std::chrono::milliseconds(5 * CONFIG_AOS_LOG_PROVIDER_FOLLOW_LATENCY));
+    zassert_true(err.Is(ErrorEnum::eTimeout), "Unexpected log received: %s", response->mContent.CStr());
+
+    // Following is stopped on send error.
+
+    fixture->mLogObserver->SetCallback(nullptr);
+    fixture->mLogObserver->SetError(ErrorEnum::eFailed);
+
+    fixture->mLogProvider->OnLogEntries(reinterpret_cast<const uint8_t*>(logEntry.c_str()), logEntry.size());
+
+    err = fixture->mLogObserver->WaitLogReceived(*response);
+    zassert_true(err.IsNone(), "Failed to wait log received: %s", utils::ErrorToCStr(err));
+
+    fixture->mLogObserver->SetError(ErrorEnum::eNone);
+
+    err = fixture->mLogProvider->StopFollowLog(logRequest->mLogID);
+    zassert_true(err.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(err));
+}
+
 ZTEST(logprovider, test_fslogreader)
 {
     auto fsLogReader = std::make_unique<FSLogReader>();
     auto logEntry    = std::make_unique<LogEntry>();
 
-    auto err = fsLogReader->Reset();
+    auto err = fsLogReader->Reset(LogReaderFilter {});
     zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
 
     // No log entries should be available
@@ -333,7 +660,7 @@ ZTEST(logprovider, test_fslogreader)
         zassert_true(err.IsNone(), "Failed to write log: %s", utils::ErrorToCStr(err));
     }
 
-    err = fsLogReader->Reset();
+    err = fsLogReader->Reset(LogReaderFilter {});
     zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
 
     std::vector<LogEntry> readLogEntries;
@@ -363,4 +690,398 @@ ZTEST(logprovider, test_fslogreader)
     }
 }
 
+ZTEST(logprovider, test_fslogreader_index)
+{
+    auto fsLogReader = std::make_unique<FSLogReader>();
+    auto logEntry    = std::make_unique<LogEntry>();
+
+    const std::vector<TestFSLogEntry> logs = {
+        CreateFSLogEntry("00000000000000000000", "F0 Test message 1", cLogTime),
+        CreateFSLogEntry("00000000000000000000", "F0 Test message 2", cLogTime.Add(Time::cMinutes)),
+        CreateFSLogEntry("00000000000000000001", "F1 Test message 1", cLogTime.Add(10 * Time::cMinutes)),
+        CreateFSLogEntry("00000000000000000001", "F1 Test message 2", cLogTime.Add(11 * Time::cMinutes)),
+        CreateFSLogEntry("00000000000000000001", "F1 Test message 3", cLogTime.Add(12 * Time::cMinutes)),
+        CreateFSLogEntry("00000000000000000001", "F1 Test message 4", cLogTime.Add(13 * Time::cMinutes)),
+    };
+
+    for (const auto& log : logs) {
+        auto err = WriteLogToFile(log);
+        zassert_true(err.IsNone(), "Failed to write log: %s", utils::ErrorToCStr(err));
+    }
+
+    // Index the first entry of each file and the third entry of the second file.
+
+    const uint64_t cThirdEntryOffset = logs[2].mLogEntry.mContent.Size() + logs[3].mLogEntry.mContent.Size() + 2;
+
+    auto err = WriteLogIndex(logs[0].mLogFile, {{0, logger::ToLogTimestamp(logs[0].mLogEntry.mTime.GetValue())}});
+    zassert_true(err.IsNone(), "Failed to write log index: %s", utils::ErrorToCStr(err));
+
+    err = WriteLogIndex(logs[2].mLogFile,
+        {{0, logger::ToLogTimestamp(logs[2].mLogEntry.mTime.GetValue())},
+            {cThirdEntryOffset, logger::ToLogTimestamp(logs[4].mLogEntry.mTime.GetValue())}});
+    zassert_true(err.IsNone(), "Failed to write log index: %s", utils::ErrorToCStr(err));
+
+    // The first file is skipped as it is before the next file start, the second file is read till the third entry.
+
+    err = fsLogReader->Reset({logs[3].mLogEntry.mTime, logs[4].mLogEntry.mTime});
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    std::vector<LogEntry> readLogEntries;
+
+    while (fsLogReader->Next()) {
+        err = fsLogReader->GetEntry(*logEntry);
+        zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+
+        readLogEntries.push_back(*logEntry);
+    }
+
+    zassert_equal(readLogEntries.size(), 2, "Log entries count mismatched");
+    zassert_equal(readLogEntries[0].mTime, logs[2].mLogEntry.mTime, "Log time mismatched");
+    zassert_equal(readLogEntries[1].mTime, logs[3].mLogEntry.mTime, "Log time mismatched");
+
+    // Without filter all entries are read.
+
+    err = fsLogReader->Reset(LogReaderFilter {});
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    size_t numEntries = 0;
+
+    while (fsLogReader->Next()) {
+        numEntries++;
+    }
+
+    zassert_equal(numEntries, logs.size(), "Log entries count mismatched");
+}
+
+ZTEST(logprovider, test_fslogreader_instance_index)
+{
+    auto fsLogReader = std::make_unique<FSLogReader>();
+    auto logEntry    = std::make_unique<LogEntry>();
+
+    const std::vector<TestFSLogEntry> logs = {
+        CreateFSLogEntry("00000000000000000000", " <inf> runner: [instance-1] message 1", cLogTime),
+        CreateFSLogEntry("00000000000000000000", " <inf> runner: [instance-1] message 2", cLogTime),
+        CreateFSLogEntry("00000000000000000000", " <inf> runner: [instance-2] message 1", cLogTime),
+        CreateFSLogEntry("00000000000000000000", " <inf> app: system message", cLogTime),
+    };
+
+    for (const auto& log : logs) {
+        auto err = WriteLogToFile(log);
+        zassert_true(err.IsNone(), "Failed to write log: %s", utils::ErrorToCStr(err));
+    }
+
+    // Two log index segments: the first one contains instance-1 logs, the second one contains instance-2 logs.
+
+    const uint64_t cSecondSegmentOffset = logs[0].mLogEntry.mContent.Size() + logs[1].mLogEntry.mContent.Size() + 2;
+    const auto     cTimestamp           = logger::ToLogTimestamp(cLogTime);
+
+    auto err = WriteLogIndex(logs[0].mLogFile, {{0, cTimestamp}, {cSecondSegmentOffset, cTimestamp}});
+    zassert_true(err.IsNone(), "Failed to write log index: %s", utils::ErrorToCStr(err));
+
+    StaticArray<logger::InstanceIndexEntry, 2> instanceIndex;
+
+    instanceIndex.PushBack({logger::GetInstanceKey("instance-1"), 0});
+    instanceIndex.PushBack({logger::GetInstanceKey("instance-2"), 1});
+
+    err = logger::AppendInstanceIndexEntries(logs[0].mLogFile, instanceIndex);
+    zassert_true(err.IsNone(), "Failed to write instance index: %s", utils::ErrorToCStr(err));
+
+    LogReaderFilter filter;
+
+    filter.mInstanceID.SetValue("instance-2");
+
+    err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    std::vector<LogEntry> readLogEntries;
+
+    while (fsLogReader->Next()) {
+        err = fsLogReader->GetEntry(*logEntry);
+        zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+
+        readLogEntries.push_back(*logEntry);
+    }
+
+    zassert_equal(readLogEntries.size(), 2, "Log entries count mismatched");
+
+    zassert_equal(readLogEntries[0].mContent, logs[2].mLogEntry.mContent, "Log entry mismatched");
+
+    // Instance without logs doesn't match any segment.
+
+    filter.mInstanceID.SetValue("instance-3");
+
+    err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    zassert_false(fsLogReader->Next(), "Log entry should not be available");
+}
+
+ZTEST(logprovider, test_fslogreader_instance_log)
+{
+    auto fsLogReader = std::make_unique<FSLogReader>();
+    auto logEntry    = std::make_unique<LogEntry>();
+
+    fs::RemoveAll(logger::cInstanceLogDir);
+
+    const std::vector<TestFSLogEntry> logs = {
+        CreateFSLogEntry("00000000000000000000", " <inf> runner: [instance-1] system message", cLogTime),
+        CreateFSLogEntry("00000000000000000000", " <inf> runner: [instance-2] system message", cLogTime),
+    };
+
+    for (const auto& log : logs) {
+        auto err = WriteLogToFile(log);
+        zassert_true(err.IsNone(), "Failed to write log: %s", utils::ErrorToCStr(err));
+    }
+
+    const std::vector<std::string> messages = {"message 1", "message 2", "message 3"};
+
+    logger::InstanceLog instanceLog;
+
+    auto err = instanceLog.Open("instance-1");
+    zassert_true(err.IsNone(), "Failed to open instance log: %s", utils::ErrorToCStr(err));
+
+    for (const auto& message : messages) {
+        err = instanceLog.Write(message.c_str());
+        zassert_true(err.IsNone(), "Failed to write instance log: %s", utils::ErrorToCStr(err));
+    }
+
+    // Flushed instance log is read while it is still open.
+
+    err = instanceLog.Flush();
+    zassert_true(err.IsNone(), "Failed to flush instance log: %s", utils::ErrorToCStr(err));
+
+    // Only instance log files are read for the instance with instance log.
+
+    LogReaderFilter filter;
+
+    filter.mInstanceID.SetValue("instance-1");
+
+    err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    std::vector<LogEntry> readLogEntries;
+
+    while (fsLogReader->Next()) {
+        err = fsLogReader->GetEntry(*logEntry);
+        zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+
+        readLogEntries.push_back(*logEntry);
+    }
+
+    zassert_equal(readLogEntries.size(), messages.size(), "Log entries count mismatched");
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        auto expectedContent = "[instance-1]" + messages[i];
+
+        zassert_not_null(strstr(readLogEntries[i].mContent.CStr(), expectedContent.c_str()), "Log entry mismatched");
+        zassert_true(readLogEntries[i].mTime.HasValue(), "Log time should be set");
+    }
+
+    instanceLog.Close();
+
+    // System log files are read for the instance without instance log.
+
+    filter.mInstanceID.SetValue("instance-2");
+
+    err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    zassert_true(fsLogReader->Next(), "Log entry should be available");
+
+    err = fsLogReader->GetEntry(*logEntry);
+    zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+    zassert_equal(logEntry->mContent, logs[0].mLogEntry.mContent, "Log entry mismatched");
+
+    // Instance log files are rotated within the instance limit.
+
+    err = instanceLog.Open("instance-1");
+    zassert_true(err.IsNone(), "Failed to open instance log: %s", utils::ErrorToCStr(err));
+
+    for (size_t i = 0; i < logger::cInstanceLogFilesLimit * logger::cInstanceLogFileSize / 16; ++i) {
+        err = instanceLog.Write("rotated message");
+        zassert_true(err.IsNone(), "Failed to write instance log: %s", utils::ErrorToCStr(err));
+    }
+
+    instanceLog.Close();
+
+    size_t numFiles = 0;
+
+    fs::DirIterator dirIterator(logger::GetInstanceLogDir("instance-1"));
+
+    while (dirIterator.Next()) {
+        numFiles++;
+    }
+
+    zassert_equal(numFiles, logger::cInstanceLogFilesLimit, "Instance log files count mismatched");
+
+    // System log files are read for the instance after its instance log is removed.
+
+    err = logger::RemoveInstanceLog("instance-1");
+    zassert_true(err.IsNone(), "Failed to remove instance log: %s", utils::ErrorToCStr(err));
+
+    zassert_false(fs::DirIterator(logger::GetInstanceLogDir("instance-1")).Next(), "Instance log should be removed");
+
+    filter.mInstanceID.SetValue("instance-1");
+
+    err = fsLogReader->Reset(filter);
+    zassert_true(err.IsNone(), "Failed to reset log reader: %s", utils::ErrorToCStr(err));
+
+    zassert_true(fsLogReader->Next(), "Log entry should be available");
+
+    err = fsLogReader->GetEntry(*logEntry);
+    zassert_true(err.IsNone(), "Failed to get log entry: %s", utils::ErrorToCStr(err));
+    zassert_not_null(strstr(logEntry->mContent.CStr(), "[instance-1] system message"), "Log entry mismatched");
+}
+
+ZTEST(logprovider, test_fsbackend_clock_jump)
+{
+    auto err = logger::backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    // Wall clock goes backwards by 10 minutes after the fourth entry.
+
+    const std::vector<int> minutes = {10, 11, 12, 13, 0, 1, 2, 3};
+
+    for (auto minute : minutes) {
+        logger::LogRecord record;
+
+        record.SetTime(cLogTime.Add(minute * Time::cMinutes));
+
+        record.mLevel  = LOG_LEVEL_INF;
+        record.mModule = "app";
+        record.mMessage.Format("message %d", minute);
+
+        err = logger::backend::FSBackend::Get().PutLogRecord(record);
+        zassert_true(err.IsNone(), "Failed to put log record: %s", utils::ErrorToCStr(err));
+    }
+
+    err = logger::backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    // Entries before the clock jump are not skipped as if they ended before the earlier entries.
+
+    auto logs = ReadFSLogs({cLogTime.Add(11 * Time::cMinutes), cLogTime.Add(20 * Time::cMinutes), {}});
+
+    zassert_true(ContainsLog(logs, "message 11"), "Log entry not found");
+    zassert_true(ContainsLog(logs, "message 13"), "Log entry not found");
+
+    // Entries after the clock jump are not skipped as if they started after the later entries.
+
+    logs = ReadFSLogs({cLogTime, cLogTime.Add(5 * Time::cMinutes), {}});
+
+    zassert_true(ContainsLog(logs, "message 0"), "Log entry not found");
+    zassert_true(ContainsLog(logs, "message 3"), "Log entry not found");
+}
+
+ZTEST(logprovider, test_fsbackend_flight_recorder_dump)
+{
+    auto err = logger::backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    // Earlier debug messages are dumped between the current log messages.
+
+    const std::vector<std::pair<int, bool>> records = {{10, false}, {11, false}, {12, false}, {13, false}, {5, true},
+        {6, true}, {14, false}, {15, false}, {16, false}};
+
+    for (const auto& [minute, dumped] : records) {
+        logger::LogRecord record;
+
+        record.SetTime(cLogTime.Add(minute * Time::cMinutes));
+
+        record.mLevel  = dumped ? LOG_LEVEL_DBG : LOG_LEVEL_INF;
+        record.mModule = "app";
+        record.mMessage.Format("message %d", minute);
+
+        err = logger::backend::FSBackend::Get().PutLogRecord(record);
+        zassert_true(err.IsNone(), "Failed to put log record: %s", utils::ErrorToCStr(err));
+    }
+
+    err = logger::backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    auto logs = ReadFSLogs({cLogTime.Add(5 * Time::cMinutes), cLogTime.Add(6 * Time::cMinutes), {}});
+
+    zassert_true(ContainsLog(logs, "message 5"), "Dumped log entry not found");
+    zassert_true(ContainsLog(logs, "message 6"), "Dumped log entry not found");
+
+    logs = ReadFSLogs({cLogTime.Add(11 * Time::cMinutes), cLogTime.Add(13 * Time::cMinutes), {}});
+
+    zassert_true(ContainsLog(logs, "message 11"), "Log entry not found");
+    zassert_true(ContainsLog(logs, "message 13"), "Log entry not found");
+
+    logs = ReadFSLogs({cLogTime.Add(14 * Time::cMinutes), {}, {}});
+
+    zassert_true(ContainsLog(logs, "message 14"), "Log entry not found");
+    zassert_true(ContainsLog(logs, "message 16"), "Log entry not found");
+
+    // The current log messages after the dump start a regular log index segment.
+
+    auto logIndex = std::make_unique<logger::LogIndex>();
+    auto found    = false;
+
+    fs::DirIterator dirIterator(logger::cLogDir);
+
+    while (dirIterator.Next()) {
+        if (dirIterator->mIsDir) {
+            continue;
+        }
+
+        err = logger::ReadLogIndex(fs::JoinPath(logger::cLogDir, dirIterator->mPath), *logIndex);
+        zassert_true(err.IsNone(), "Failed to read log index: %s", utils::ErrorToCStr(err));
+
+        for (const auto& entry : *logIndex) {
+            if (!entry.IsClockJump() && entry.GetTime() == cLogTime.Add(14 * Time::cMinutes)) {
+                found = true;
+            }
+        }
+    }
+
+    zassert_true(found, "Log index entry not found");
+}
+
+ZTEST(logprovider, test_fsbackend_instance_index)
+{
+    fs::RemoveAll(logger::cInstanceLogDir);
+
+    auto err = logger::backend::FSBackend::Get().Init();
+    zassert_true(err.IsNone(), "Failed to initialize fs log backend: %s", utils::ErrorToCStr(err));
+
+    // instance-1 logs span several log index segments, instance-2 logs appear in the last ones only.
+
+    const std::vector<std::pair<std::string, int>> logs = {
+        {"instance-1", 8},
+        {"instance-2", 2},
+        {"instance-1", 2},
+    };
+
+    for (const auto& [instanceID, count] : logs) {
+        for (auto i = 0; i < count; i++) {
+            auto message = instanceID + " message " + std::to_string(i);
+
+            err = logger::backend::FSBackend::Get().PutInstanceLog(instanceID.c_str(), message.c_str());
+            zassert_true(err.IsNone(), "Failed to put instance log: %s", utils::ErrorToCStr(err));
+        }
+    }
+
+    err = logger::backend::FSBackend::Get().Sync();
+    zassert_true(err.IsNone(), "Failed to sync fs log backend: %s", utils::ErrorToCStr(err));
+
+    LogReaderFilter filter;
+
+    filter.mInstanceID.SetValue("instance-2");
+
+    auto readLogs = ReadFSLogs(filter);
+
+    zassert_true(ContainsLog(readLogs, "[instance-2]instance-2 message 0"), "Log entry not found");
+    zassert_true(ContainsLog(readLogs, "[instance-2]instance-2 message 1"), "Log entry not found");
+    zassert_false(ContainsLog(readLogs, "[instance-1]instance-1 message 0"), "Unexpected log entry");
+
+    filter.mInstanceID.SetValue("instance-1");
+
+    readLogs = ReadFSLogs(filter);
+
+    zassert_true(ContainsLog(readLogs, "[instance-1]instance-1 message 0"), "Log entry not found");
+    zassert_true(ContainsLog(readLogs, "[instance-1]instance-1 message 7"), "Log entry not found");
+}
+
 } // namespace aos::zephyr::logprovider
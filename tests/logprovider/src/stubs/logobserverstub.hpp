@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <condition_variable>
+#include <functional>
 #include <mutex>
 #include <queue>
 
@@ -22,13 +23,39 @@ namespace aos::zephyr::logprovider {
 class LogObserverStub : public sm::logprovider::LogObserverItf {
 public:
     Error OnLogReceived(const cloudprotocol::PushLog& log) override
+    {
+        std::function<void()> callback;
+        Error                 err;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            mLogQueue.push(log);
+            mCondVar.notify_one();
+
+            callback = mCallback;
+            err      = mError;
+        }
+
+        if (callback) {
+            callback();
+        }
+
+        return err;
+    }
+
+    void SetCallback(std::function<void()> callback)
     {
         std::unique_lock<std::mutex> lock(mMutex);
 
-        mLogQueue.push(log);
-        mCondVar.notify_one();
+        mCallback = std::move(callback);
+    }
 
-        return ErrorEnum::eNone;
+    void SetError(const Error& err)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mError = err;
     }
 
     Error WaitLogReceived(
@@ -52,6 +79,8 @@ private:
     std::mutex                         mMutex;
     std::condition_variable            mCondVar;
     std::queue<cloudprotocol::PushLog> mLogQueue;
+    std::function<void()>              mCallback;
+    Error                              mError;
 };
 } // namespace aos::zephyr::logprovider
 
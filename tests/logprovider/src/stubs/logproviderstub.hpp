@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <condition_variable>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "logprovider/logprovider.hpp"
@@ -48,7 +49,9 @@ public:
      */
     bool Next() override
     {
-        std::lock_guard<std::mutex> lock(mMutex);
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mCondVar.wait(lock, [this] { return !mBlockSystemLog || mFilter.mInstanceID.HasValue(); });
 
         return !mLogEntries.empty();
     }
@@ -56,9 +59,17 @@ public:
     /**
      * Resets reader.
      *
+     * @param filter log reader filter.
      * @return Error.
      */
-    Error Reset() override { return ErrorEnum::eNone; }
+    Error Reset(const LogReaderFilter& filter) override
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFilter = filter;
+
+        return ErrorEnum::eNone;
+    }
 
     /**
      * Sets log entries.
@@ -72,10 +83,76 @@ public:
         mLogEntries = logEntries;
     }
 
+    /**
+     * Blocks reading system log, i.e. log without instance filter.
+     *
+     * @param block block flag.
+     */
+    void BlockSystemLog(bool block)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mBlockSystemLog = block;
+        mCondVar.notify_all();
+    }
+
+private:
+    std::mutex              mMutex;
+    std::condition_variable mCondVar;
+    bool                    mValid          = false;
+    bool                    mBlockSystemLog = false;
+    LogReaderFilter         mFilter;
+    std::vector<LogEntry>   mLogEntries;
+};
+
+/**
+ * Crash log reader stub.
+ */
+class CrashLogReaderStub : public CrashLogReaderItf {
+public:
+    /**
+     * Reads part of instance crash log.
+     *
+     * @param instanceID instance ID.
+     * @param offset offset in the crash log.
+     * @param[out] log crash log part.
+     * @return Error.
+     */
+    Error ReadCrashLog(const String& instanceID, size_t offset, String& log) override
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (instanceID != String(mInstanceID.c_str())) {
+            return ErrorEnum::eNotFound;
+        }
+
+        log.Clear();
+
+        if (offset < mCrashLog.size()) {
+            return log.Assign(String(mCrashLog.c_str() + offset, Min(mCrashLog.size() - offset, log.MaxSize())));
+        }
+
+        return ErrorEnum::eNone;
+    }
+
+    /**
+     * Sets crash log.
+     *
+     * @param instanceID instance ID.
+     * @param crashLog crash log.
+     */
+    void SetCrashLog(const std::string& instanceID, const std::string& crashLog)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mInstanceID = instanceID;
+        mCrashLog   = crashLog;
+    }
+
 private:
-    std::mutex            mMutex;
-    bool                  mValid = false;
-    std::vector<LogEntry> mLogEntries;
+    std::mutex  mMutex;
+    std::string mInstanceID;
+    std::string mCrashLog;
 };
 
 } // namespace aos::zephyr::logprovider
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/tc_util.h>
+#include <zephyr/ztest.h>
+
+#include <aos/common/tools/fs.hpp>
+
+#include "runner/consolereader.hpp"
+
+#include "stubs/xenstub.hpp"
+#include "utils/log.hpp"
+#include "utils/utils.hpp"
+
+using namespace aos;
+using namespace aos::zephyr;
+using namespace aos::zephyr::runner;
+
+/***********************************************************************************************************************
+ * Consts
+ **********************************************************************************************************************/
+
+static constexpr auto cInstanceID = "instance-1";
+
+/***********************************************************************************************************************
+ * Types
+ **********************************************************************************************************************/
+
+struct runner_fixture {
+    ConsoleReader mConsoleReader;
+};
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(
+    runner, nullptr,
+    []() -> void* {
+        Log::SetCallback(TestLogCallback);
+
+        return new runner_fixture;
+    },
+    [](void*) { fs::RemoveAll(cCrashLogDir); }, nullptr,
+    [](void* fixture) { delete static_cast<runner_fixture*>(fixture); });
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST_F(runner, test_crash_log_partial_line)
+{
+    StaticString<cConsoleLogSize> log;
+
+    XenStub::Get().StartDomain(cInstanceID);
+
+    auto err = fixture->mConsoleReader.Subscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't subscribe console reader: %s", utils::ErrorToCStr(err));
+
+    // Domain crashes in the middle of the line.
+
+    XenStub::Get().FeedConsole("line 1\npartial line");
+    XenStub::Get().StopDomain();
+
+    err = fixture->mConsoleReader.Unsubscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't unsubscribe console reader: %s", utils::ErrorToCStr(err));
+
+    err = fixture->mConsoleReader.ReadConsoleLog(cInstanceID, 0, log);
+    zassert_true(err.IsNone(), "Can't read console log: %s", utils::ErrorToCStr(err));
+
+    zassert_str_equal(log.CStr(), "line 1\npartial line");
+}
+
+ZTEST_F(runner, test_crash_log_after_restart)
+{
+    StaticString<cConsoleLogSize> log;
+
+    XenStub::Get().StartDomain(cInstanceID);
+
+    auto err = fixture->mConsoleReader.Subscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't subscribe console reader: %s", utils::ErrorToCStr(err));
+
+    XenStub::Get().FeedConsole("running\n");
+
+    // Console output of running instance is read if there is no crash log.
+
+    err = fixture->mConsoleReader.ReadConsoleLog(cInstanceID, 0, log);
+    zassert_true(err.IsNone(), "Can't read console log: %s", utils::ErrorToCStr(err));
+
+    zassert_str_equal(log.CStr(), "running\n");
+
+    XenStub::Get().FeedConsole("crash\n");
+    XenStub::Get().StopDomain();
+
+    err = fixture->mConsoleReader.Unsubscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't unsubscribe console reader: %s", utils::ErrorToCStr(err));
+
+    // Crash log is read after the instance is restarted.
+
+    XenStub::Get().StartDomain(cInstanceID);
+
+    err = fixture->mConsoleReader.Subscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't subscribe console reader: %s", utils::ErrorToCStr(err));
+
+    XenStub::Get().FeedConsole("restarted\n");
+
+    err = fixture->mConsoleReader.ReadConsoleLog(cInstanceID, 0, log);
+    zassert_true(err.IsNone(), "Can't read console log: %s", utils::ErrorToCStr(err));
+
+    zassert_str_equal(log.CStr(), "running\ncrash\n");
+
+    err = fixture->mConsoleReader.Unsubscribe(cInstanceID);
+    zassert_true(err.IsNone(), "Can't unsubscribe console reader: %s", utils::ErrorToCStr(err));
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <domain.h>
+#include <xen_console.h>
+#include <xen_dom_mgmt.h>
+
+#include "xenstub.hpp"
+
+namespace {
+
+constexpr uint32_t cDomID = 1;
+
+xen_domain           sDomain {};
+bool                 sDomainStarted = false;
+on_console_feed_cb_t sFeedCallback  = nullptr;
+void*                sFeedData      = nullptr;
+
+} // namespace
+
+extern "C" {
+
+struct xen_domain* get_domain(uint32_t domid)
+{
+    return sDomainStarted && domid == cDomID ? &sDomain : nullptr;
+}
+
+uint32_t find_domain_by_name(char* arg)
+{
+    return sDomainStarted && strcmp(arg, sDomain.name) == 0 ? cDomID : 0;
+}
+
+int set_console_feed_cb(struct xen_domain* domain, on_console_feed_cb_t cb, void* cb_data)
+{
+    (void)domain;
+
+    sFeedCallback = cb;
+    sFeedData     = cb_data;
+
+    return 0;
+}
+
+} // extern "C"
+
+namespace aos::zephyr::runner {
+
+XenStub& XenStub::Get()
+{
+    static XenStub sXenStub;
+
+    return sXenStub;
+}
+
+void XenStub::StartDomain(const std::string& name)
+{
+    sDomain.domid = cDomID;
+    strncpy(sDomain.name, name.c_str(), sizeof(sDomain.name) - 1);
+
+    sDomainStarted = true;
+}
+
+void XenStub::StopDomain()
+{
+    sDomainStarted = false;
+}
+
+void XenStub::FeedConsole(const std::string& data)
+{
+    if (sFeedCallback == nullptr) {
+        return;
+    }
+
+    for (auto ch : data) {
+        sFeedCallback(ch, sFeedData);
+    }
+}
+
+} // namespace aos::zephyr::runner
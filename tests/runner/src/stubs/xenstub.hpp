@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef XENSTUB_HPP_
+#define XENSTUB_HPP_
+
+#include <string>
+
+namespace aos::zephyr::runner {
+
+/**
+ * Xen domain stub: single domain which console is fed by the test.
+ */
+class XenStub {
+public:
+    /**
+     * Returns xen stub instance.
+     *
+     * @return XenStub&.
+     */
+    static XenStub& Get();
+
+    /**
+     * Starts domain.
+     *
+     * @param name domain name.
+     */
+    void StartDomain(const std::string& name);
+
+    /**
+     * Stops domain.
+     */
+    void StopDomain();
+
+    /**
+     * Feeds domain console.
+     *
+     * @param data console output.
+     */
+    void FeedConsole(const std::string& data);
+};
+
+} // namespace aos::zephyr::runner
+
+#endif
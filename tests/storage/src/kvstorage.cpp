@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <aos/common/tools/fs.hpp>
+
+#include "storage/kvstorage.hpp"
+#include "utils/log.hpp"
+#include "utils/utils.hpp"
+
+namespace aos::zephyr {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr auto cTestDir       = CONFIG_AOS_STORAGE_DIR "/kvtest";
+constexpr auto cTestFile      = CONFIG_AOS_STORAGE_DIR "/kvtest/test.db";
+constexpr auto cTestTmpFile   = CONFIG_AOS_STORAGE_DIR "/kvtest/test.db.tmp";
+constexpr auto cNumBenchmarks = 1000;
+
+Error SetValue(storage::KVStorage& kvStorage, uint32_t key, uint64_t value)
+{
+    return kvStorage.Set(key, Array<uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(value)));
+}
+
+RetWithError<uint64_t> GetValue(storage::KVStorage& kvStorage, uint32_t key)
+{
+    uint64_t       value = 0;
+    Array<uint8_t> buffer(reinterpret_cast<uint8_t*>(&value), sizeof(value));
+
+    auto err = kvStorage.Get(key, buffer);
+
+    return {value, err};
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(
+    kvstorage, NULL, nullptr,
+    [](void*) {
+        aos::Log::SetCallback(TestLogCallback);
+
+        auto err = fs::ClearDir(cTestDir);
+        zassert_true(err.IsNone(), "Failed to clear test directory: err=%s", utils::ErrorToCStr(err));
+    },
+    NULL, NULL);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(kvstorage, test_SetGet)
+{
+    storage::KVStorage kvStorage;
+
+    zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+
+    auto [value, err] = GetValue(kvStorage, 1);
+    zassert_true(err.Is(ErrorEnum::eNotFound), "Unexpected error: %s", utils::ErrorToCStr(err));
+
+    zassert_true(SetValue(kvStorage, 1, 10).IsNone(), "Failed to set value");
+    zassert_true(SetValue(kvStorage, 2, 20).IsNone(), "Failed to set value");
+    zassert_true(SetValue(kvStorage, 1, 11).IsNone(), "Failed to set value");
+
+    Tie(value, err) = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 11, "Unexpected value");
+
+    Tie(value, err) = GetValue(kvStorage, 2);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 20, "Unexpected value");
+}
+
+ZTEST(kvstorage, test_Reload)
+{
+    {
+        storage::KVStorage kvStorage;
+
+        zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+        zassert_true(SetValue(kvStorage, 1, 100).IsNone(), "Failed to set value");
+        zassert_true(SetValue(kvStorage, 1, 101).IsNone(), "Failed to set value");
+    }
+
+    // Append a truncated entry to emulate power loss during write.
+
+    auto fd = open(cTestFile, O_WRONLY | O_APPEND);
+    zassert_true(fd >= 0, "Failed to open test file");
+
+    uint8_t garbage[5] = {1, 2, 3, 4, 5};
+
+    zassert_equal(write(fd, garbage, sizeof(garbage)), sizeof(garbage), "Failed to write garbage");
+    zassert_equal(close(fd), 0, "Failed to close test file");
+
+    storage::KVStorage kvStorage;
+
+    zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+
+    auto [value, err] = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 101, "Unexpected value");
+
+    zassert_true(SetValue(kvStorage, 1, 102).IsNone(), "Failed to set value");
+
+    Tie(value, err) = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 102, "Unexpected value");
+}
+
+ZTEST(kvstorage, test_Benchmark)
+{
+    storage::KVStorage kvStorage;
+
+    zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+
+    auto start = k_uptime_get();
+
+    for (uint64_t i = 0; i < cNumBenchmarks; i++) {
+        zassert_true(SetValue(kvStorage, 1, i).IsNone(), "Failed to set value");
+    }
+
+    auto elapsed = Max(k_uptime_get() - start, static_cast<int64_t>(1));
+
+    auto [value, err] = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, cNumBenchmarks - 1, "Unexpected value");
+    zassert_true(kvStorage.GetNumCompactions() > 0, "Compaction is not performed");
+
+    printk("KV storage benchmark: updates=%d, time=%lld ms, writes/sec=%lld, bytes/update=%zu, compactions=%zu\n",
+        cNumBenchmarks, elapsed, cNumBenchmarks * 1000LL / elapsed, kvStorage.GetBytesWritten() / cNumBenchmarks,
+        kvStorage.GetNumCompactions());
+}
+
+ZTEST(kvstorage, test_StaleCompactionFile)
+{
+    {
+        storage::KVStorage kvStorage;
+
+        zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+        zassert_true(SetValue(kvStorage, 1, 100).IsNone(), "Failed to set value");
+    }
+
+    // Emulate power loss during compaction: temporary file is written but not renamed yet.
+
+    zassert_true(fs::WriteStringToFile(cTestTmpFile, "garbage", S_IRUSR | S_IWUSR).IsNone(), "Failed to write file");
+
+    storage::KVStorage kvStorage;
+
+    zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+    zassert_not_equal(access(cTestTmpFile, F_OK), 0, "Stale compaction file is not removed");
+
+    auto [value, err] = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 100, "Unexpected value");
+}
+
+ZTEST(kvstorage, test_CompactionFailure)
+{
+    storage::KVStorage kvStorage;
+
+    zassert_true(kvStorage.Init(cTestFile).IsNone(), "Failed to init KV storage");
+
+    // Directory with temporary file name makes compaction fail.
+
+    zassert_true(fs::MakeDirAll(cTestTmpFile).IsNone(), "Failed to create directory");
+
+    for (uint64_t i = 0; i < cNumBenchmarks; i++) {
+        zassert_true(SetValue(kvStorage, 1, i).IsNone(), "Failed to set value");
+    }
+
+    zassert_equal(kvStorage.GetNumCompactions(), 0, "Unexpected compaction");
+
+    auto [value, err] = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, cNumBenchmarks - 1, "Unexpected value");
+
+    zassert_true(fs::RemoveAll(cTestTmpFile).IsNone(), "Failed to remove directory");
+    zassert_true(SetValue(kvStorage, 1, 1).IsNone(), "Failed to set value");
+    zassert_equal(kvStorage.GetNumCompactions(), 1, "Compaction is not performed");
+
+    Tie(value, err) = GetValue(kvStorage, 1);
+    zassert_true(err.IsNone(), "Failed to get value: %s", utils::ErrorToCStr(err));
+    zassert_equal(value, 1, "Unexpected value");
+}
+
+} // namespace aos::zephyr
@@ -5,6 +5,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <fcntl.h>
+#include <stdarg.h>
+#include <unistd.h>
+
 #include <zephyr/ztest.h>
 
 #include <aos/common/tools/log.hpp>
@@ -15,6 +19,64 @@
 #include "utils/log.hpp"
 #include "utils/utils.hpp"
 
+/***********************************************************************************************************************
+ * Syscall wrappers
+ **********************************************************************************************************************/
+
+// File syscalls are wrapped by the linker (see CMakeLists.txt) to count them in batch operations test.
+
+static size_t sNumSyscalls = 0;
+
+extern "C" {
+
+int     __real_open(const char* name, int flags, ...);
+int     __real_close(int fd);
+ssize_t __real_read(int fd, void* buffer, size_t count);
+ssize_t __real_write(int fd, const void* buffer, size_t count);
+off_t   __real_lseek(int fd, off_t offset, int whence);
+
+int __wrap_open(const char* name, int flags, ...)
+{
+    va_list args;
+
+    va_start(args, flags);
+    auto mode = va_arg(args, int);
+    va_end(args);
+
+    sNumSyscalls++;
+
+    return __real_open(name, flags, mode);
+}
+
+int __wrap_close(int fd)
+{
+    sNumSyscalls++;
+
+    return __real_close(fd);
+}
+
+ssize_t __wrap_read(int fd, void* buffer, size_t count)
+{
+    sNumSyscalls++;
+
+    return __real_read(fd, buffer, count);
+}
+
+ssize_t __wrap_write(int fd, const void* buffer, size_t count)
+{
+    sNumSyscalls++;
+
+    return __real_write(fd, buffer, count);
+}
+
+off_t __wrap_lseek(int fd, off_t offset, int whence)
+{
+    sNumSyscalls++;
+
+    return __real_lseek(fd, offset, whence);
+}
+}
+
 namespace aos::zephyr {
 
 /***********************************************************************************************************************
@@ -147,6 +209,113 @@ ZTEST_F(storage, test_AddUpdateRemoveInstance)
     zassert_equal(instances2.Size(), 0, "Unexpected number of instances");
 }
 
+ZTEST_F(storage, test_BatchInstances)
+{
+    constexpr auto cNumInstances = 4;
+
+    storage::Storage& storage = fixture->mStorage;
+
+    aos::StaticArray<sm::launcher::InstanceData, cNumInstances>   instances;
+    aos::StaticArray<StaticString<cInstanceIDLen>, cNumInstances> instanceIDs;
+
+    for (size_t i = 0; i < cNumInstances; i++) {
+        sm::launcher::InstanceData instance;
+
+        instance.mInstanceID.Format("batch%zu", i);
+        instance.mInstanceInfo.mInstanceIdent.mInstance  = i;
+        instance.mInstanceInfo.mInstanceIdent.mServiceID = "service_id";
+        instance.mInstanceInfo.mInstanceIdent.mSubjectID = "subject_id";
+        instance.mInstanceInfo.mPriority                 = i;
+        instance.mInstanceInfo.mStoragePath              = "storage_path";
+        instance.mInstanceInfo.mStatePath                = "state_path";
+        instance.mInstanceInfo.mUID                      = i;
+
+        zassert_true(instances.PushBack(instance).IsNone(), "Failed to add instance");
+        zassert_true(instanceIDs.PushBack(instance.mInstanceID).IsNone(), "Failed to add instance ID");
+    }
+
+    // Single operations
+
+    sNumSyscalls = 0;
+
+    for (const auto& instance : instances) {
+        zassert_equal(storage.AddInstance(instance), aos::ErrorEnum::eNone, "Failed to add instance");
+    }
+
+    for (const auto& instance : instances) {
+        zassert_equal(storage.UpdateInstance(instance), aos::ErrorEnum::eNone, "Failed to update instance");
+    }
+
+    for (const auto& instanceID : instanceIDs) {
+        zassert_equal(storage.RemoveInstance(instanceID), aos::ErrorEnum::eNone, "Failed to remove instance");
+    }
+
+    auto numSingleSyscalls = sNumSyscalls;
+
+    // Batch operations
+
+    sNumSyscalls = 0;
+
+    zassert_equal(storage.AddInstances(instances), aos::ErrorEnum::eNone, "Failed to add instances");
+
+    auto numBatchSyscalls = sNumSyscalls;
+
+    zassert_equal(storage.AddInstances(instances), aos::ErrorEnum::eAlreadyExist, "Unexpected error");
+
+    aos::StaticArray<sm::launcher::InstanceData, cNumInstances> storedInstances;
+
+    zassert_equal(storage.GetAllInstances(storedInstances), aos::ErrorEnum::eNone, "Failed to get all instances");
+    zassert_equal(storedInstances.Size(), cNumInstances, "Unexpected number of instances");
+
+    for (const auto& instance : storedInstances) {
+        zassert_not_equal(instances.Find(instance), instances.end(), "Unexpected instance");
+    }
+
+    for (auto& instance : instances) {
+        instance.mInstanceInfo.mStatePath = "state_path2";
+    }
+
+    sNumSyscalls = 0;
+
+    zassert_equal(storage.UpdateInstances(instances), aos::ErrorEnum::eNone, "Failed to update instances");
+
+    numBatchSyscalls += sNumSyscalls;
+
+    storedInstances.Clear();
+
+    zassert_equal(storage.GetAllInstances(storedInstances), aos::ErrorEnum::eNone, "Failed to get all instances");
+    zassert_equal(storedInstances.Size(), cNumInstances, "Unexpected number of instances");
+
+    for (const auto& instance : storedInstances) {
+        zassert_not_equal(instances.Find(instance), instances.end(), "Unexpected instance");
+    }
+
+    sNumSyscalls = 0;
+
+    zassert_equal(storage.RemoveInstances(instanceIDs), aos::ErrorEnum::eNone, "Failed to remove instances");
+
+    numBatchSyscalls += sNumSyscalls;
+
+    zassert_equal(storage.RemoveInstances(instanceIDs), aos::ErrorEnum::eNotFound, "Unexpected error");
+
+    storedInstances.Clear();
+
+    zassert_equal(storage.GetAllInstances(storedInstances), aos::ErrorEnum::eNone, "Failed to get all instances");
+    zassert_equal(storedInstances.Size(), 0, "Unexpected number of instances");
+
+    // Duplicate in batch
+
+    instances[cNumInstances - 1].mInstanceID = instances[0].mInstanceID;
+
+    zassert_equal(storage.AddInstances(instances), aos::ErrorEnum::eAlreadyExist, "Unexpected error");
+    zassert_equal(storage.GetAllInstances(storedInstances), aos::ErrorEnum::eNone, "Failed to get all instances");
+    zassert_equal(storedInstances.Size(), 0, "Unexpected number of instances");
+
+    printk("Instance syscalls: single=%zu, batch=%zu\n", numSingleSyscalls, numBatchSyscalls);
+
+    zassert_true(numBatchSyscalls < numSingleSyscalls, "Batch operations should use less syscalls");
+}
+
 ZTEST_F(storage, test_AddUpdateRemoveService)
 {
     storage::Storage& storage = fixture->mStorage;
@@ -318,6 +487,117 @@ ZTEST_F(storage, test_AddUpdateRemoveLayer)
     zassert_equal(layers2.Size(), 0, "Unexpected number of layers");
 }
 
+ZTEST_F(storage, test_ObjectCache)
+{
+    storage::Storage& storage = fixture->mStorage;
+
+    sm::layermanager::LayerData layerData {};
+
+    layerData.mLayerDigest = "cache-layer-digest";
+    layerData.mLayerID     = "cache-layer-id";
+    layerData.mVersion     = "1.0.0";
+    layerData.mTimestamp   = Time::Now();
+    layerData.mState       = sm::layermanager::LayerStateEnum::eActive;
+    layerData.mSize        = 128;
+
+    zassert_equal(storage.AddLayer(layerData), ErrorEnum::eNone, "Failed to add layer");
+
+    auto hits   = storage.GetCacheHits();
+    auto misses = storage.GetCacheMisses();
+
+    sm::layermanager::LayerData storedLayer {};
+
+    // Lookup fills the cache.
+
+    zassert_equal(storage.GetLayer(layerData.mLayerDigest, storedLayer), ErrorEnum::eNone, "Failed to get layer");
+    zassert_true(storedLayer == layerData, "Unexpected layer");
+
+    zassert_equal(storage.GetCacheMisses(), misses + 1, "Unexpected cache misses");
+    zassert_equal(storage.GetCacheHits(), hits, "Unexpected cache hits");
+
+    static StaticArray<sm::layermanager::LayerData, CONFIG_AOS_STORAGE_CACHE_NUM_LAYERS> layers;
+
+    layers.Clear();
+
+    zassert_equal(storage.GetAllLayers(layers), ErrorEnum::eNone, "Failed to get all layers");
+    zassert_equal(storage.GetLayer(layerData.mLayerDigest, storedLayer), ErrorEnum::eNone, "Failed to get layer");
+    zassert_true(storedLayer == layerData, "Unexpected layer");
+    zassert_equal(storage.GetLayer("unknown-digest", storedLayer), ErrorEnum::eNotFound, "Unexpected error");
+
+    zassert_equal(storage.GetCacheMisses(), misses + 1, "Unexpected cache misses");
+    zassert_equal(storage.GetCacheHits(), hits + 3, "Unexpected cache hits");
+
+    layerData.mSize = 256;
+
+    zassert_equal(storage.UpdateLayer(layerData), ErrorEnum::eNone, "Failed to update layer");
+    zassert_equal(storage.GetLayer(layerData.mLayerDigest, storedLayer), ErrorEnum::eNone, "Failed to get layer");
+    zassert_true(storedLayer == layerData, "Cache is not invalidated on update");
+
+    zassert_equal(storage.RemoveLayer(layerData.mLayerDigest), ErrorEnum::eNone, "Failed to remove layer");
+    zassert_equal(storage.GetLayer(layerData.mLayerDigest, storedLayer), ErrorEnum::eNotFound, "Unexpected error");
+
+    zassert_equal(storage.GetCacheMisses(), misses + 3, "Unexpected cache misses");
+}
+
+ZTEST_F(storage, test_CertInfoCache)
+{
+    storage::Storage& storage = fixture->mStorage;
+
+    const String certType = "cache";
+
+    iam::certhandler::CertInfo certInfo1;
+    certInfo1.mIssuer  = StringToDN("cache_issuer1");
+    certInfo1.mSerial  = StringToDN("cache_serial1");
+    certInfo1.mCertURL = "cache_cert_url1";
+    certInfo1.mKeyURL  = "cache_key_url1";
+
+    iam::certhandler::CertInfo certInfo2;
+    certInfo2.mIssuer  = StringToDN("cache_issuer2");
+    certInfo2.mSerial  = StringToDN("cache_serial2");
+    certInfo2.mCertURL = "cache_cert_url2";
+    certInfo2.mKeyURL  = "cache_key_url2";
+
+    zassert_equal(storage.AddCertInfo(certType, certInfo1), ErrorEnum::eNone, "Failed to add cert info");
+    zassert_equal(storage.AddCertInfo(certType, certInfo2), ErrorEnum::eNone, "Failed to add cert info");
+
+    auto hits   = storage.GetCacheHits();
+    auto misses = storage.GetCacheMisses();
+
+    iam::certhandler::CertInfo storedCertInfo;
+
+    zassert_equal(storage.GetCertInfo(certInfo2.mIssuer, certInfo2.mSerial, storedCertInfo), ErrorEnum::eNone,
+        "Failed to get cert info");
+    zassert_true(storedCertInfo == certInfo2, "Unexpected cert info");
+    zassert_equal(storage.GetCertInfo(certInfo1.mIssuer, certInfo2.mSerial, storedCertInfo), ErrorEnum::eNotFound,
+        "Unexpected error");
+
+    zassert_equal(storage.GetCacheMisses(), misses + 1, "Unexpected cache misses");
+    zassert_equal(storage.GetCacheHits(), hits + 1, "Unexpected cache hits");
+
+    StaticArray<iam::certhandler::CertInfo, 2> certInfos;
+
+    zassert_equal(storage.GetCertsInfo(certType, certInfos), ErrorEnum::eNone, "Failed to get cert infos");
+    zassert_equal(certInfos.Size(), 2, "Unexpected number of cert infos");
+
+    zassert_equal(storage.GetCertInfo(certInfo1.mIssuer, certInfo1.mSerial, storedCertInfo), ErrorEnum::eNone,
+        "Failed to get cert info");
+    zassert_true(storedCertInfo == certInfo1, "Unexpected cert info");
+    zassert_equal(storage.GetCertInfo(certInfo1.mIssuer, certInfo2.mSerial, storedCertInfo), ErrorEnum::eNotFound,
+        "Unexpected error");
+
+    zassert_equal(storage.GetCacheMisses(), misses + 1, "Unexpected cache misses");
+    zassert_equal(storage.GetCacheHits(), hits + 4, "Unexpected cache hits");
+
+    zassert_equal(storage.RemoveCertInfo(certType, certInfo1.mCertURL), ErrorEnum::eNone, "Failed to remove cert info");
+    zassert_equal(storage.GetCertInfo(certInfo1.mIssuer, certInfo1.mSerial, storedCertInfo), ErrorEnum::eNotFound,
+        "Cache is not invalidated on remove");
+    zassert_equal(storage.GetCertInfo(certInfo2.mIssuer, certInfo2.mSerial, storedCertInfo), ErrorEnum::eNone,
+        "Failed to get cert info");
+    zassert_true(storedCertInfo == certInfo2, "Unexpected cert info");
+
+    zassert_equal(storage.RemoveAllCertsInfo(certType), ErrorEnum::eNone, "Failed to remove cert infos");
+}
+
 ZTEST_F(storage, test_AddRemoveCertInfo)
 {
     storage::Storage& storage = fixture->mStorage;
@@ -409,4 +689,84 @@ ZTEST_F(storage, test_AddRemoveCertInfo)
     zassert_equal(certInfos2.Size(), 0, "Unexpected number of cert infos");
 }
 
+ZTEST_F(storage, test_OperationVersionOnlineTime)
+{
+    storage::Storage& storage = fixture->mStorage;
+
+    zassert_equal(storage.SetOperationVersion(42), aos::ErrorEnum::eNone, "Failed to set operation version");
+
+    auto [version, err] = storage.GetOperationVersion();
+    zassert_true(err.IsNone(), "Failed to get operation version: %s", utils::ErrorToCStr(err));
+    zassert_equal(version, 42, "Unexpected operation version");
+
+    auto onlineTime = Time::Unix(1700000000, 500);
+
+    zassert_equal(storage.SetOnlineTime(onlineTime), aos::ErrorEnum::eNone, "Failed to set online time");
+
+    auto [storedTime, timeErr] = storage.GetOnlineTime();
+    zassert_true(timeErr.IsNone(), "Failed to get online time: %s", utils::ErrorToCStr(timeErr));
+    zassert_true(storedTime == onlineTime, "Unexpected online time");
+}
+
+ZTEST_F(storage, test_OverrideEnvVars)
+{
+    storage::Storage& storage = fixture->mStorage;
+
+    static StaticArray<cloudprotocol::EnvVarsInstanceInfo, 2> envVars;
+    static StaticArray<cloudprotocol::EnvVarsInstanceInfo, 2> storedEnvVars;
+
+    zassert_true(storage.GetOverrideEnvVars(storedEnvVars).IsNone(), "Failed to get override env vars");
+    zassert_equal(storedEnvVars.Size(), 0, "Unexpected number of override env vars");
+
+    envVars.EmplaceBack();
+    envVars[0].mFilter.mServiceID.EmplaceValue();
+    envVars[0].mFilter.mServiceID.GetValue() = "service1";
+    envVars[0].mFilter.mInstance.SetValue(1);
+    envVars[0].mVariables.EmplaceBack();
+    envVars[0].mVariables[0].mName  = "VAR1";
+    envVars[0].mVariables[0].mValue = "value1";
+    envVars[0].mVariables[0].mTTL.SetValue(Time::Unix(1700000000, 0));
+    envVars[0].mVariables.EmplaceBack();
+    envVars[0].mVariables[1].mName  = "VAR2";
+    envVars[0].mVariables[1].mValue = "value2";
+
+    envVars.EmplaceBack();
+    envVars[1].mFilter.mSubjectID.EmplaceValue();
+    envVars[1].mFilter.mSubjectID.GetValue() = "subject1";
+
+    zassert_true(storage.SetOverrideEnvVars(envVars).IsNone(), "Failed to set override env vars");
+    zassert_true(storage.GetOverrideEnvVars(storedEnvVars).IsNone(), "Failed to get override env vars");
+    zassert_equal(storedEnvVars.Size(), 2, "Unexpected number of override env vars");
+
+    const auto& instance1 = storedEnvVars[0];
+
+    zassert_true(instance1.mFilter.mServiceID.HasValue(), "Service ID is not set");
+    zassert_true(instance1.mFilter.mServiceID.GetValue() == "service1", "Unexpected service ID");
+    zassert_false(instance1.mFilter.mSubjectID.HasValue(), "Unexpected subject ID");
+    zassert_true(instance1.mFilter.mInstance.HasValue(), "Instance is not set");
+    zassert_equal(instance1.mFilter.mInstance.GetValue(), 1, "Unexpected instance");
+    zassert_equal(instance1.mVariables.Size(), 2, "Unexpected number of variables");
+    zassert_true(instance1.mVariables[0].mName == "VAR1", "Unexpected variable name");
+    zassert_true(instance1.mVariables[0].mValue == "value1", "Unexpected variable value");
+    zassert_true(instance1.mVariables[0].mTTL.HasValue(), "TTL is not set");
+    zassert_true(instance1.mVariables[0].mTTL.GetValue() == Time::Unix(1700000000, 0), "Unexpected TTL");
+    zassert_true(instance1.mVariables[1].mName == "VAR2", "Unexpected variable name");
+    zassert_false(instance1.mVariables[1].mTTL.HasValue(), "Unexpected TTL");
+
+    const auto& instance2 = storedEnvVars[1];
+
+    zassert_false(instance2.mFilter.mServiceID.HasValue(), "Unexpected service ID");
+    zassert_true(instance2.mFilter.mSubjectID.HasValue(), "Subject ID is not set");
+    zassert_true(instance2.mFilter.mSubjectID.GetValue() == "subject1", "Unexpected subject ID");
+    zassert_false(instance2.mFilter.mInstance.HasValue(), "Unexpected instance");
+    zassert_equal(instance2.mVariables.Size(), 0, "Unexpected number of variables");
+
+    envVars.Clear();
+    storedEnvVars.Clear();
+
+    zassert_true(storage.SetOverrideEnvVars(envVars).IsNone(), "Failed to clear override env vars");
+    zassert_true(storage.GetOverrideEnvVars(storedEnvVars).IsNone(), "Failed to get override env vars");
+    zassert_equal(storedEnvVars.Size(), 0, "Unexpected number of override env vars");
+}
+
 } // namespace aos::zephyr
@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2025 EPAM Systems, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <memory>
+
+#include <zephyr/ztest.h>
+
+#include <aos/common/tools/fs.hpp>
+#include <aos/common/tools/log.hpp>
+#include <aos/common/tools/string.hpp>
+#include <aos/common/types.hpp>
+
+#include "storage/storage.hpp"
+#include "utils/log.hpp"
+#include "utils/utils.hpp"
+
+/***********************************************************************************************************************
+ * Syscall wrappers
+ **********************************************************************************************************************/
+
+// The write syscall is wrapped by the linker (see CMakeLists.txt) to count written bytes and inject truncated writes.
+
+static size_t sBytesWritten      = 0;
+static int    sWritesBeforeFault = -1;
+static size_t sNumInjectedFaults = 0;
+
+extern "C" {
+
+ssize_t __real_write(int fd, const void* buffer, size_t count);
+
+ssize_t __wrap_write(int fd, const void* buffer, size_t count)
+{
+    if (sWritesBeforeFault == 0) {
+        sWritesBeforeFault = -1;
+        sNumInjectedFaults++;
+
+        count /= 2;
+    } else if (sWritesBeforeFault > 0) {
+        sWritesBeforeFault--;
+    }
+
+    auto ret = __real_write(fd, buffer, count);
+    if (ret > 0) {
+        sBytesWritten += ret;
+    }
+
+    return ret;
+}
+}
+
+namespace aos::zephyr {
+
+/***********************************************************************************************************************
+ * Static
+ **********************************************************************************************************************/
+
+namespace {
+
+constexpr auto cStoragePath = CONFIG_AOS_STORAGE_DIR;
+constexpr auto cNumRecords  = CONFIG_AOS_STORAGE_BENCH_NUM_RECORDS;
+constexpr auto cCertType    = "bench";
+constexpr auto cGarbageSize = 100;
+
+StaticArray<sm::launcher::InstanceData, cNumRecords>      sInstances;
+StaticArray<sm::servicemanager::ServiceData, cNumRecords> sServices;
+StaticArray<sm::layermanager::LayerData, cNumRecords>     sLayers;
+StaticArray<iam::certhandler::CertInfo, cNumRecords>      sCerts;
+StaticArray<StaticString<cInstanceIDLen>, cNumRecords>    sInstanceIDs;
+
+uint64_t GetTimeUs()
+{
+    timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+template <typename F>
+void Benchmark(const char* name, size_t numOps, F op)
+{
+    auto bytesWritten = sBytesWritten;
+    auto start        = GetTimeUs();
+
+    for (size_t i = 0; i < numOps; i++) {
+        auto err = op(i);
+        zassert_true(err.IsNone(), "%s failed: %s", name, utils::ErrorToCStr(err));
+    }
+
+    auto elapsed = GetTimeUs() - start;
+
+    bytesWritten = sBytesWritten - bytesWritten;
+
+    printk("%-28s ops=%zu, total=%llu us, per op=%llu us, written=%zu bytes, per op=%zu bytes\n", name, numOps,
+        static_cast<unsigned long long>(elapsed), static_cast<unsigned long long>(elapsed / numOps), bytesWritten,
+        bytesWritten / numOps);
+}
+
+sm::launcher::InstanceData CreateInstance(size_t index)
+{
+    sm::launcher::InstanceData instance;
+
+    instance.mInstanceID.Format("instance%zu", index);
+    instance.mInstanceInfo.mInstanceIdent.mInstance  = index;
+    instance.mInstanceInfo.mInstanceIdent.mServiceID = "service_id";
+    instance.mInstanceInfo.mInstanceIdent.mSubjectID = "subject_id";
+    instance.mInstanceInfo.mPriority                 = index;
+    instance.mInstanceInfo.mStoragePath              = "storage_path";
+    instance.mInstanceInfo.mStatePath                = "state_path";
+    instance.mInstanceInfo.mUID                      = index;
+
+    return instance;
+}
+
+sm::servicemanager::ServiceData CreateService(size_t index)
+{
+    sm::servicemanager::ServiceData service {};
+
+    service.mServiceID.Format("service%zu", index);
+    service.mProviderID = "provider_id";
+    service.mVersion    = "1.0.0";
+    service.mImagePath  = "image_path";
+    service.mTimestamp  = Time::Now();
+    service.mSize       = index;
+
+    return service;
+}
+
+sm::layermanager::LayerData CreateLayer(size_t index)
+{
+    sm::layermanager::LayerData layer {};
+
+    layer.mLayerDigest.Format("sha256:layer%zu", index);
+    layer.mUnpackedLayerDigest.Format("sha256:unpacked%zu", index);
+    layer.mLayerID.Format("layer%zu", index);
+    layer.mVersion   = "1.0.0";
+    layer.mPath      = "layer_path";
+    layer.mOSVersion = "os_version";
+    layer.mTimestamp = Time::Now();
+    layer.mState     = sm::layermanager::LayerStateEnum::eActive;
+    layer.mSize      = index;
+
+    return layer;
+}
+
+iam::certhandler::CertInfo CreateCert(size_t index)
+{
+    iam::certhandler::CertInfo cert;
+    StaticString<32>           str;
+
+    str.Format("issuer%zu", index);
+    cert.mIssuer = Array<uint8_t>(reinterpret_cast<const uint8_t*>(str.CStr()), str.Size());
+
+    str.Format("serial%zu", index);
+    cert.mSerial = Array<uint8_t>(reinterpret_cast<const uint8_t*>(str.CStr()), str.Size());
+
+    cert.mCertURL.Format("cert_url%zu", index);
+    cert.mKeyURL.Format("key_url%zu", index);
+    cert.mNotAfter = Time::Now();
+
+    return cert;
+}
+
+std::unique_ptr<storage::Storage> CreateStorage()
+{
+    auto storage = std::make_unique<storage::Storage>();
+
+    auto err = storage->Init();
+    zassert_true(err.IsNone(), "Can't initialize storage: %s", utils::ErrorToCStr(err));
+
+    return storage;
+}
+
+void AppendGarbage(const char* fileName, size_t size)
+{
+    auto fd = open(fileName, O_WRONLY | O_APPEND);
+    zassert_true(fd >= 0, "Can't open file: %s", fileName);
+
+    uint8_t garbage[64];
+
+    memset(garbage, 0xA5, sizeof(garbage));
+
+    while (size > 0) {
+        auto chunkSize = Min(size, sizeof(garbage));
+
+        zassert_equal(__real_write(fd, garbage, chunkSize), static_cast<ssize_t>(chunkSize), "Can't write garbage");
+
+        size -= chunkSize;
+    }
+
+    zassert_equal(close(fd), 0, "Can't close file");
+}
+
+} // namespace
+
+/***********************************************************************************************************************
+ * Setup
+ **********************************************************************************************************************/
+
+ZTEST_SUITE(
+    storagebench, NULL,
+    []() -> void* {
+        aos::Log::SetCallback(TestLogCallback);
+
+        printk("Storage benchmark: records=%d\n", cNumRecords);
+
+        return nullptr;
+    },
+    [](void*) {
+        sWritesBeforeFault = -1;
+
+        auto err = fs::ClearDir(cStoragePath);
+        zassert_true(err.IsNone(), "Failed to clear storage directory: err=%s", utils::ErrorToCStr(err));
+    },
+    NULL, NULL);
+
+/***********************************************************************************************************************
+ * Tests
+ **********************************************************************************************************************/
+
+ZTEST(storagebench, test_Instances)
+{
+    auto storage = CreateStorage();
+
+    Benchmark("instance add", cNumRecords, [&](size_t i) { return storage->AddInstance(CreateInstance(i)); });
+    Benchmark("instance update", cNumRecords, [&](size_t i) { return storage->UpdateInstance(CreateInstance(i)); });
+    Benchmark("instance scan", 1, [&](size_t) {
+        sInstances.Clear();
+
+        return storage->GetAllInstances(sInstances);
+    });
+
+    zassert_equal(sInstances.Size(), cNumRecords, "Unexpected number of instances");
+
+    Benchmark("instance remove", cNumRecords, [&](size_t i) {
+        auto instance = CreateInstance(i);
+
+        return storage->RemoveInstance(instance.mInstanceID);
+    });
+
+    sInstances.Clear();
+    sInstanceIDs.Clear();
+
+    for (size_t i = 0; i < cNumRecords; i++) {
+        zassert_true(sInstances.PushBack(CreateInstance(i)).IsNone(), "Can't add instance");
+        zassert_true(sInstanceIDs.PushBack(sInstances.Back().mInstanceID).IsNone(), "Can't add instance ID");
+    }
+
+    Benchmark("instance batch add", 1, [&](size_t) { return storage->AddInstances(sInstances); });
+    Benchmark("instance batch update", 1, [&](size_t) { return storage->UpdateInstances(sInstances); });
+    Benchmark("instance batch remove", 1, [&](size_t) { return storage->RemoveInstances(sInstanceIDs); });
+}
+
+ZTEST(storagebench, test_Services)
+{
+    auto storage = CreateStorage();
+
+    Benchmark("service add", cNumRecords, [&](size_t i) { return storage->AddService(CreateService(i)); });
+    Benchmark("service update", cNumRecords, [&](size_t i) { return storage->UpdateService(CreateService(i)); });
+    Benchmark("service lookup", cNumRecords, [&](size_t i) {
+        auto service = CreateService(i);
+
+        sServices.Clear();
+
+        return storage->GetServiceVersions(service.mServiceID, sServices);
+    });
+    Benchmark("service scan", 1, [&](size_t) {
+        sServices.Clear();
+
+        return storage->GetAllServices(sServices);
+    });
+
+    zassert_equal(sServices.Size(), cNumRecords, "Unexpected number of services");
+
+    Benchmark("service remove", cNumRecords, [&](size_t i) {
+        auto service = CreateService(i);
+
+        return storage->RemoveService(service.mServiceID, service.mVersion);
+    });
+}
+
+ZTEST(storagebench, test_Layers)
+{
+    auto storage = CreateStorage();
+
+    Benchmark("layer add", cNumRecords, [&](size_t i) { return storage->AddLayer(CreateLayer(i)); });
+    Benchmark("layer update", cNumRecords, [&](size_t i) { return storage->UpdateLayer(CreateLayer(i)); });
+    Benchmark("layer lookup", cNumRecords, [&](size_t i) {
+        auto                        layer = CreateLayer(i);
+        sm::layermanager::LayerData storedLayer;
+
+        return storage->GetLayer(layer.mLayerDigest, storedLayer);
+    });
+    Benchmark("layer scan", 1, [&](size_t) {
+        sLayers.Clear();
+
+        return storage->GetAllLayers(sLayers);
+    });
+
+    zassert_equal(sLayers.Size(), cNumRecords, "Unexpected number of layers");
+
+    Benchmark("layer remove", cNumRecords, [&](size_t i) {
+        auto layer = CreateLayer(i);
+
+        return storage->RemoveLayer(layer.mLayerDigest);
+    });
+}
+
+ZTEST(storagebench, test_Certs)
+{
+    auto storage = CreateStorage();
+
+    Benchmark("cert add", cNumRecords, [&](size_t i) { return storage->AddCertInfo(cCertType, CreateCert(i)); });
+    Benchmark("cert lookup", cNumRecords, [&](size_t i) {
+        auto                       cert = CreateCert(i);
+        iam::certhandler::CertInfo storedCert;
+
+        return storage->GetCertInfo(cert.mIssuer, cert.mSerial, storedCert);
+    });
+    Benchmark("cert scan", 1, [&](size_t) {
+        sCerts.Clear();
+
+        return storage->GetCertsInfo(cCertType, sCerts);
+    });
+
+    zassert_equal(sCerts.Size(), cNumRecords, "Unexpected number of certs");
+
+    Benchmark("cert remove", cNumRecords, [&](size_t i) {
+        auto cert = CreateCert(i);
+
+        return storage->RemoveCertInfo(cCertType, cert.mCertURL);
+    });
+}
+
+ZTEST(storagebench, test_TruncatedWrite)
+{
+    auto storage = CreateStorage();
+
+    for (size_t i = 0; i < cNumRecords - 1; i++) {
+        zassert_equal(storage->AddInstance(CreateInstance(i)), ErrorEnum::eNone, "Failed to add instance");
+    }
+
+    sWritesBeforeFault = 0;
+
+    zassert_not_equal(
+        storage->AddInstance(CreateInstance(cNumRecords - 1)), ErrorEnum::eNone, "Truncated write is not detected");
+    zassert_equal(sNumInjectedFaults, 1, "Fault is not injected");
+
+    sNumInjectedFaults = 0;
+
+    storage.reset();
+
+    Benchmark("recovery truncated write", 1, [&](size_t) {
+        storage = CreateStorage();
+        sInstances.Clear();
+
+        return storage->GetAllInstances(sInstances);
+    });
+
+    zassert_equal(sInstances.Size(), cNumRecords - 1, "Unexpected number of instances");
+
+    zassert_equal(storage->AddInstance(CreateInstance(cNumRecords - 1)), ErrorEnum::eNone, "Failed to add instance");
+
+    sInstances.Clear();
+
+    zassert_equal(storage->GetAllInstances(sInstances), ErrorEnum::eNone, "Failed to get instances");
+    zassert_equal(sInstances.Size(), cNumRecords, "Unexpected number of instances");
+}
+
+ZTEST(storagebench, test_PartialRecord)
+{
+    auto storage    = CreateStorage();
+    auto onlineTime = Time::Unix(1700000000, 0);
+
+    for (size_t i = 0; i < cNumRecords - 1; i++) {
+        zassert_equal(storage->AddInstance(CreateInstance(i)), ErrorEnum::eNone, "Failed to add instance");
+    }
+
+    zassert_equal(storage->SetOnlineTime(onlineTime), ErrorEnum::eNone, "Failed to set online time");
+
+    storage.reset();
+
+    AppendGarbage(fs::JoinPath(cStoragePath, "instance.db").CStr(), cGarbageSize);
+    AppendGarbage(fs::JoinPath(cStoragePath, "settings.db").CStr(), cGarbageSize);
+
+    Benchmark("recovery partial record", 1, [&](size_t) {
+        storage = CreateStorage();
+        sInstances.Clear();
+
+        return storage->GetAllInstances(sInstances);
+    });
+
+    zassert_equal(sInstances.Size(), cNumRecords - 1, "Unexpected number of instances");
+
+    auto [storedTime, err] = storage->GetOnlineTime();
+    zassert_true(err.IsNone(), "Failed to get online time: %s", utils::ErrorToCStr(err));
+    zassert_true(storedTime == onlineTime, "Unexpected online time");
+
+    zassert_equal(storage->AddInstance(CreateInstance(cNumRecords - 1)), ErrorEnum::eNone, "Failed to add instance");
+
+    sInstances.Clear();
+
+    zassert_equal(storage->GetAllInstances(sInstances), ErrorEnum::eNone, "Failed to get instances");
+    zassert_equal(sInstances.Size(), cNumRecords, "Unexpected number of instances");
+}
+
+} // namespace aos::zephyr